@@ -52,6 +52,8 @@ void setup()
 	gui.init();
 
 	socket = gsm.CreateSocket(0, ProtocolType::Tcp);
+	socket->Reconnect.Enabled = true;
+	socket->Reconnect.MinDelay = 5000;
 
 	socket->OnSocketEvent(nullptr, [](void*ctx, SocketEventType eventType) 
 	{
@@ -83,14 +85,12 @@ void loop()
 
 	if (socket->IsNetworkAvailable())
 	{
-		if (socket->IsClosed())
+		// socket reconnects by itself afterwards, see Reconnect policy in setup
+		static bool connectStarted = false;
+		if (!connectStarted)
 		{
-			static uint64_t lastConnectTime =0;
-			if (millis() - lastConnectTime > 5000)
-			{
-				lastConnectTime = millis();
-				socket->BeginConnect("conti.ml", 12668);
-			}
+			connectStarted = true;
+			socket->BeginConnect("conti.ml", 12668);
 		}
 
 		if (socket->IsConnected())
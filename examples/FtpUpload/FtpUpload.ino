@@ -0,0 +1,61 @@
+#include <GsmModule.h>
+#include <SimcomAtCommandsEsp32.h>
+#include <Network/GsmFtpClient.h>
+
+/*
+Uploads buffer to FTP server with modem FTP stack once GPRS is connected.
+Transfer is resumed from server side file size after connection errors.
+*/
+
+SimcomAtCommandsEsp32 gsmAt(Serial1, 16, 14, 25);
+GsmModule gsm(gsmAt);
+GsmFtpClient ftp(gsm);
+char logData[32 * 1024];
+bool isStarted = false;
+bool isDone = false;
+
+void setup()
+{
+	Serial.begin(500000);
+	gsm.OnLog([](const char *logEntry)
+	{
+		Serial.print("[GSM]");
+		Serial.println(logEntry);
+	});
+	gsm.BaudRate = 460800;
+	gsm.ApnName = "virgin-internet";
+	ftp.Server = "ftp.example.com";
+	ftp.User = "device";
+	ftp.Password = "secret";
+	memset(logData, 'x', sizeof(logData));
+}
+
+void loop()
+{
+	gsm.Loop();
+	if (isDone)
+	{
+		return;
+	}
+	if (!isStarted)
+	{
+		if (gsm.GetState() == GsmState::ConnectedToGprs)
+		{
+			isStarted = ftp.BeginUpload("/logs/", "device.log", sizeof(logData), nullptr, [](void*, uint32_t offset, uint16_t length, FixedStringBase& buffer)
+			{
+				// data is requested by offset, so it can be read from file on flash as well
+				buffer.append(logData + offset, min<uint32_t>(length, sizeof(logData) - offset));
+			});
+		}
+		return;
+	}
+	const auto state = ftp.Loop();
+	if (state != FtpTransferState::Completed && state != FtpTransferState::Failed)
+	{
+		return;
+	}
+	const auto& stats = ftp.GetStats();
+	Serial.printf("FTP %s, %u b in %u chunks, %u resumes, %u B/s\n", state == FtpTransferState::Completed ? "done" : "failed",
+		stats.Bytes, stats.Chunks, stats.Resumes, stats.BytesPerSecond());
+	isDone = true;
+}
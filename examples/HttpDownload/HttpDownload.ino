@@ -0,0 +1,62 @@
+#include <GsmModule.h>
+#include <SimcomAtCommandsEsp32.h>
+#include <Network/GsmHttpClient.h>
+
+/*
+Downloads file with modem HTTP stack once GPRS is connected and reads body
+in 1 KB chunks, e.g. to write it to flash or update partition.
+*/
+
+const char* fileUrl = "http://example.com/index.html";
+
+SimcomAtCommandsEsp32 gsmAt(Serial1, 16, 14, 25);
+GsmModule gsm(gsmAt);
+GsmHttpClient http(gsm);
+FixedString<1024> chunk;
+bool isRequested = false;
+bool isDone = false;
+uint32_t received = 0;
+
+void setup()
+{
+	Serial.begin(500000);
+	gsm.OnLog([](const char *logEntry)
+	{
+		Serial.print("[GSM]");
+		Serial.println(logEntry);
+	});
+	gsm.BaudRate = 460800;
+	gsm.ApnName = "virgin-internet";
+}
+
+void loop()
+{
+	gsm.Loop();
+	if (isDone)
+	{
+		return;
+	}
+	if (!isRequested)
+	{
+		if (gsm.GetState() == GsmState::ConnectedToGprs)
+		{
+			isRequested = http.Get(fileUrl);
+		}
+		return;
+	}
+	if (http.Loop() != HttpClientState::ResponseReady)
+	{
+		return;
+	}
+	chunk.clear();
+	const auto length = http.Read(chunk);
+	if (length > 0)
+	{
+		// process chunk here
+		received += length;
+		return;
+	}
+	Serial.printf("HTTP %d, %u of %u b received in %u ms\n", http.GetStatusCode(), received, http.GetContentLength(), http.GetResponseTime());
+	http.End();
+	isDone = true;
+}
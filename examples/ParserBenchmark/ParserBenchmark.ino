@@ -0,0 +1,33 @@
+#include <Diagnostics/ParserBenchmark.h>
+
+/*
+Runs parsing layer benchmarks and prints ns/byte and lines/s for each of them.
+Paste AT transcript dump captured with AtTranscriptRecorder into recordedTranscript
+to benchmark parser against real traffic.
+*/
+
+const uint8_t recordedTranscript[] = { 0 };
+
+void OnBenchmarkResult(void* ctx, const ParserBenchmarkResult& result)
+{
+	ParserBenchmark::PrintResult(Serial, result);
+}
+
+void setup()
+{
+	Serial.begin(500000);
+	delay(500);
+	Serial.println("Parser benchmark");
+
+	ParserBenchmark benchmark(1000);
+	benchmark.RunAll(nullptr, OnBenchmarkResult);
+
+	if (sizeof(recordedTranscript) > 1)
+	{
+		OnBenchmarkResult(nullptr, benchmark.FeedCharTranscript(recordedTranscript, sizeof(recordedTranscript)));
+	}
+}
+
+void loop()
+{
+}
@@ -0,0 +1,59 @@
+#include <GsmModule.h>
+#include <SimcomAtCommandsEsp32.h>
+#include <Diagnostics/SocketLoadTest.h>
+
+/*
+Drives all six sockets against TCP echo server and prints integrity, throughput
+and latency per socket every 30 seconds. Each socket uses different payload
+pattern and rate, so interleaving of CIPSEND/CIPRXGET between muxes is exercised.
+*/
+
+const char* echoHost = "tcpbin.com";
+const uint16_t echoPort = 4242;
+
+SimcomAtCommandsEsp32 gsmAt(Serial1, 16, 14, 25);
+GsmModule gsm(gsmAt);
+SocketLoadTest loadTest;
+unsigned long lastReport = 0;
+
+void setup()
+{
+	Serial.begin(500000);
+	gsm.OnLog([](const char *logEntry)
+	{
+		Serial.print("[GSM]");
+		Serial.println(logEntry);
+	});
+	gsm.BaudRate = 460800;
+	gsm.ApnName = "virgin-internet";
+
+	for (uint8_t mux = 0; mux < SocketCount; mux++)
+	{
+		SocketLoadConfig config;
+		config.Pattern = static_cast<PayloadPattern>(mux % 3);
+		// half of sockets stream as fast as window allows, others send periodically
+		config.ChunkSize = mux % 2 == 0 ? 512 : 64;
+		config.ChunkInterval = mux % 2 == 0 ? 0 : 500;
+		config.MaxInFlight = 1536;
+		loadTest.AddSocket(gsm.CreateSocket(mux, ProtocolType::Tcp), config);
+	}
+	loadTest.Begin(echoHost, echoPort);
+}
+
+void loop()
+{
+	gsm.Loop();
+	loadTest.Loop();
+	if (millis() - lastReport < 30000)
+	{
+		return;
+	}
+	lastReport = millis();
+	for (uint8_t i = 0; i < loadTest.GetSocketCount(); i++)
+	{
+		Serial.printf("Socket %d %s\n", i, loadTest.GetLastError(i));
+		SocketLoadTest::PrintStats(Serial, loadTest.GetStats(i));
+	}
+	Serial.println("Total");
+	SocketLoadTest::PrintStats(Serial, loadTest.GetTotalStats());
+}
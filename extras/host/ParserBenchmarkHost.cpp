@@ -0,0 +1,73 @@
+#include <Diagnostics/ParserBenchmark.h>
+#include <vector>
+
+/*
+Runs parsing layer benchmarks on host, same as examples/ParserBenchmark.
+
+	parser_benchmark [--max-ns-per-byte <limit>] [iterations] [transcript dump]
+
+Transcript dump is binary buffer written by AtTranscriptRecorder.
+Exit code is nonzero when a benchmark parsed fewer or more responses than it fed,
+or with limit set, when any benchmark took more than limit ns per byte.
+*/
+
+struct BenchmarkCheck
+{
+	float MaxNsPerByte;
+	uint8_t Failures;
+};
+
+static void OnBenchmarkResult(void* ctx, const ParserBenchmarkResult& result)
+{
+	auto check = reinterpret_cast<BenchmarkCheck*>(ctx);
+	ParserBenchmark::PrintResult(Serial, result);
+	if (!result.IsParsedAsExpected())
+	{
+		check->Failures++;
+	}
+	if (check->MaxNsPerByte > 0 && result.NsPerByte() > check->MaxNsPerByte)
+	{
+		printf("  slower than limit %.1f ns/b\n", check->MaxNsPerByte);
+		check->Failures++;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	BenchmarkCheck check;
+	check.MaxNsPerByte = 0;
+	check.Failures = 0;
+	if (argc > 2 && strcmp(argv[1], "--max-ns-per-byte") == 0)
+	{
+		check.MaxNsPerByte = atof(argv[2]);
+		argc -= 2;
+		argv += 2;
+	}
+
+	ParserBenchmark benchmark(argc > 1 ? atoi(argv[1]) : 1000);
+	benchmark.RunAll(&check, OnBenchmarkResult);
+
+	if (argc > 2)
+	{
+		auto file = fopen(argv[2], "rb");
+		if (file == nullptr)
+		{
+			perror(argv[2]);
+			return 1;
+		}
+		std::vector<uint8_t> dump;
+		int c;
+		while ((c = fgetc(file)) != EOF)
+		{
+			dump.push_back(c);
+		}
+		fclose(file);
+		OnBenchmarkResult(&check, benchmark.FeedCharTranscript(dump.data(), dump.size()));
+	}
+	if (check.Failures > 0)
+	{
+		printf("%u benchmark checks failed\n", check.Failures);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,132 @@
+#include <GsmModule.h>
+#include <Diagnostics/SimulatedModem.h>
+#include <Diagnostics/SocketLoadTest.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <thread>
+
+/*
+Runs SocketLoadTest through GsmModule against SimulatedModem and local TCP echo server
+and prints integrity, throughput and latency per socket.
+
+	socket_load_test [seconds] [sockets] [loss percent] [round trip ms]
+
+Exit code is nonzero when any echoed byte did not match or nothing was verified.
+*/
+
+static void EchoConnection(int fd)
+{
+	char buffer[1460];
+	ssize_t length;
+	while ((length = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+	{
+		send(fd, buffer, length, MSG_NOSIGNAL);
+	}
+	close(fd);
+}
+
+static void EchoServer(int listenFd)
+{
+	while (true)
+	{
+		const auto fd = accept(listenFd, nullptr, nullptr);
+		if (fd < 0)
+		{
+			return;
+		}
+		std::thread(EchoConnection, fd).detach();
+	}
+}
+
+static int StartEchoServer(uint16_t& port)
+{
+	const auto listenFd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	// port 0, system picks free one
+	socklen_t addressLength = sizeof(address);
+	if (listenFd < 0 ||
+		bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+		listen(listenFd, SocketCount) != 0 ||
+		getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &addressLength) != 0)
+	{
+		perror("echo server");
+		return -1;
+	}
+	port = ntohs(address.sin_port);
+	std::thread(EchoServer, listenFd).detach();
+	return listenFd;
+}
+
+int main(int argc, char** argv)
+{
+	setvbuf(stdout, nullptr, _IOLBF, 0);
+	const uint32_t durationMs = (argc > 1 ? atoi(argv[1]) : 30) * 1000;
+	const uint8_t socketCount = argc > 2 ? atoi(argv[2]) : SocketCount;
+
+	SimulatedModem modem;
+	if (argc > 3)
+	{
+		modem.Shaping.LossPercent = atoi(argv[3]);
+	}
+	if (argc > 4)
+	{
+		modem.Shaping.RoundTripMs = atoi(argv[4]);
+	}
+
+	uint16_t echoPort;
+	if (StartEchoServer(echoPort) < 0)
+	{
+		return 1;
+	}
+
+	SimcomAtCommands gsmAt(modem, [](uint64_t baudRate) {});
+	GsmModule gsm(gsmAt);
+	SocketLoadTest loadTest;
+	for (uint8_t mux = 0; mux < socketCount && mux < SocketCount; mux++)
+	{
+		// same mix as examples/SocketLoadTest
+		SocketLoadConfig config;
+		config.Pattern = static_cast<PayloadPattern>(mux % 3);
+		config.ChunkSize = mux % 2 == 0 ? 512 : 64;
+		config.ChunkInterval = mux % 2 == 0 ? 0 : 500;
+		config.MaxInFlight = 1536;
+		loadTest.AddSocket(gsm.CreateSocket(mux, ProtocolType::Tcp), config);
+	}
+
+	auto start = millis();
+	while (gsm.GetState() != GsmState::ConnectedToGprs)
+	{
+		if (millis() - start > 60000)
+		{
+			printf("Modem did not connect to GPRS\n");
+			return 1;
+		}
+		gsm.Loop();
+	}
+	printf("Connected to GPRS in %lu ms, echo server on port %u\n", millis() - start, echoPort);
+
+	loadTest.Begin("127.0.0.1", echoPort);
+	start = millis();
+	while (millis() - start < durationMs)
+	{
+		gsm.Loop();
+		loadTest.Loop();
+	}
+	// stats before Stop, closing sockets counts chunks in flight as lost
+	for (uint8_t i = 0; i < loadTest.GetSocketCount(); i++)
+	{
+		printf("Socket %d %s\n", i, loadTest.GetLastError(i));
+		SocketLoadTest::PrintStats(Serial, loadTest.GetStats(i));
+	}
+	const auto totalStats = loadTest.GetTotalStats();
+	printf("Total\n");
+	SocketLoadTest::PrintStats(Serial, totalStats);
+	// lost TCP segments are delayed by one round trip in simulator, on device they are hidden by modem TCP stack
+	printf("link retransmissions %u, AT commands %u\n", modem.GetStats().LostChunks, modem.GetStats().Commands);
+	loadTest.Stop();
+	return totalStats.IntegrityErrors == 0 && totalStats.BytesVerified > 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#include "Arduino.h"
+#include <stdarg.h>
+#include <chrono>
+#include <thread>
+
+HostSerial Serial;
+
+static const auto startTime = std::chrono::steady_clock::now();
+
+unsigned long millis()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(unsigned long ms)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield()
+{
+	std::this_thread::yield();
+}
+
+long random(long howBig)
+{
+	return random(0, howBig);
+}
+
+long random(long howSmall, long howBig)
+{
+	if (howBig <= howSmall)
+	{
+		return howSmall;
+	}
+	return howSmall + rand() % (howBig - howSmall);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+}
+
+size_t Print::printf(const char* format, ...)
+{
+	char buffer[256];
+	va_list args;
+	va_start(args, format);
+	const auto length = vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+	if (length <= 0)
+	{
+		return 0;
+	}
+	return write(buffer, static_cast<size_t>(length) < sizeof(buffer) ? length : sizeof(buffer) - 1);
+}
+
+size_t HostSerial::write(uint8_t c)
+{
+	putchar(c);
+	return 1;
+}
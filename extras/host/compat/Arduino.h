@@ -0,0 +1,59 @@
+#ifndef _HOST_ARDUINO_H
+#define _HOST_ARDUINO_H
+
+/*
+Minimal Arduino core for building the library on Linux/macOS, see extras/host/README.md.
+Only what library sources, SimulatedModem and host runners use is provided.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+#include "WString.h"
+#include "pgmspace.h"
+#include "Print.h"
+#include "Stream.h"
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+long random(long howBig);
+long random(long howSmall, long howBig);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+// debug output of library, goes to stdout
+class HostSerial : public Stream
+{
+public:
+	void begin(unsigned long baudRate)
+	{
+	}
+	int available() override
+	{
+		return 0;
+	}
+	int read() override
+	{
+		return -1;
+	}
+	int peek() override
+	{
+		return -1;
+	}
+	size_t write(uint8_t c) override;
+	using Print::write;
+};
+
+extern HostSerial Serial;
+
+#endif
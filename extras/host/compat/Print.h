@@ -0,0 +1,49 @@
+#ifndef _HOST_PRINT_H
+#define _HOST_PRINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class Print
+{
+public:
+	virtual ~Print()
+	{
+	}
+	virtual size_t write(uint8_t c) = 0;
+	virtual size_t write(const uint8_t* buffer, size_t size)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			write(buffer[i]);
+		}
+		return size;
+	}
+	size_t write(const char* buffer, size_t size)
+	{
+		return write(reinterpret_cast<const uint8_t*>(buffer), size);
+	}
+	virtual void flush()
+	{
+	}
+	size_t print(const char* text)
+	{
+		return write(text, strlen(text));
+	}
+	size_t print(char c)
+	{
+		return write(static_cast<uint8_t>(c));
+	}
+	size_t println(const char* text)
+	{
+		return print(text) + print("\r\n");
+	}
+	size_t println()
+	{
+		return print("\r\n");
+	}
+	size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef _HOST_WSTRING_H
+#define _HOST_WSTRING_H
+
+#include "pgmspace.h"
+
+// there is no separate flash address space on host, F() strings are plain pointers
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(PSTR(string_literal)))
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef _HOST_FIXED_STRING_H
+#define _HOST_FIXED_STRING_H
+
+/*
+Subset of ArduinoFixedString (https://github.com/toomasz/ArduinoFixedString) used when
+the real library is not found next to this one, covers only what library sources use.
+*/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "../WString.h"
+
+class FixedStringBase
+{
+protected:
+	char* _buffer;
+	size_t _capacity;
+	size_t _length;
+public:
+	FixedStringBase(char* buffer, size_t capacity):
+		_buffer(buffer),
+		_capacity(capacity),
+		_length(0)
+	{
+		_buffer[0] = 0;
+	}
+	FixedStringBase& operator=(const FixedStringBase& other)
+	{
+		if (this != &other)
+		{
+			clear();
+			append(other._buffer, other._length);
+		}
+		return *this;
+	}
+	FixedStringBase& operator=(const char* text)
+	{
+		clear();
+		append(text);
+		return *this;
+	}
+	const char* c_str() const
+	{
+		return _buffer;
+	}
+	size_t length() const
+	{
+		return _length;
+	}
+	size_t capacity() const
+	{
+		return _capacity;
+	}
+	size_t freeBytes() const
+	{
+		return _capacity - _length;
+	}
+	bool isFull() const
+	{
+		return _length == _capacity;
+	}
+	void clear()
+	{
+		_length = 0;
+		_buffer[0] = 0;
+	}
+	bool append(char c)
+	{
+		if (_length == _capacity)
+		{
+			return false;
+		}
+		_buffer[_length++] = c;
+		_buffer[_length] = 0;
+		return true;
+	}
+	bool append(const char* data, size_t length)
+	{
+		for (size_t i = 0; i < length; i++)
+		{
+			if (!append(data[i]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	bool append(const char* text)
+	{
+		return append(text, strlen(text));
+	}
+	bool append(const __FlashStringHelper* text)
+	{
+		return append(reinterpret_cast<const char*>(text));
+	}
+	bool appendFormatV(const char* format, va_list args)
+	{
+		const auto written = vsnprintf(_buffer + _length, _capacity - _length + 1, format, args);
+		if (written < 0)
+		{
+			return false;
+		}
+		const auto isTruncated = static_cast<size_t>(written) > _capacity - _length;
+		_length = isTruncated ? _capacity : _length + written;
+		return !isTruncated;
+	}
+	bool appendFormatV(const __FlashStringHelper* format, va_list args)
+	{
+		return appendFormatV(reinterpret_cast<const char*>(format), args);
+	}
+	bool appendFormat(const char* format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+		const auto result = appendFormatV(format, args);
+		va_end(args);
+		return result;
+	}
+	bool appendFormat(const __FlashStringHelper* format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+		const auto result = appendFormatV(reinterpret_cast<const char*>(format), args);
+		va_end(args);
+		return result;
+	}
+	bool remove(size_t index, size_t count)
+	{
+		if (index > _length)
+		{
+			return false;
+		}
+		if (index + count > _length)
+		{
+			count = _length - index;
+		}
+		memmove(_buffer + index, _buffer + index + count, _length - index - count + 1);
+		_length -= count;
+		return true;
+	}
+	bool startsWith(const char* text) const
+	{
+		return strncmp(_buffer, text, strlen(text)) == 0;
+	}
+	bool startsWith(const __FlashStringHelper* text) const
+	{
+		return startsWith(reinterpret_cast<const char*>(text));
+	}
+	bool endsWith(const char* text) const
+	{
+		const auto length = strlen(text);
+		return length <= _length && strcmp(_buffer + _length - length, text) == 0;
+	}
+	bool endsWith(const __FlashStringHelper* text) const
+	{
+		return endsWith(reinterpret_cast<const char*>(text));
+	}
+	bool equals(const char* text) const
+	{
+		return strcmp(_buffer, text) == 0;
+	}
+	bool equals(const __FlashStringHelper* text) const
+	{
+		return equals(reinterpret_cast<const char*>(text));
+	}
+	bool equals(const FixedStringBase& other) const
+	{
+		return equals(other._buffer);
+	}
+	bool operator==(const char* text) const
+	{
+		return equals(text);
+	}
+	bool operator==(const __FlashStringHelper* text) const
+	{
+		return equals(text);
+	}
+	bool operator==(const FixedStringBase& other) const
+	{
+		return equals(other);
+	}
+	bool operator!=(const char* text) const
+	{
+		return !equals(text);
+	}
+	char& operator[](size_t index)
+	{
+		return _buffer[index];
+	}
+};
+
+template<size_t Size>
+class FixedString : public FixedStringBase
+{
+	char _data[Size + 1];
+public:
+	FixedString():
+		FixedStringBase(_data, Size)
+	{
+	}
+	FixedString(const char* text):
+		FixedStringBase(_data, Size)
+	{
+		append(text);
+	}
+	FixedString(const FixedString& other):
+		FixedStringBase(_data, Size)
+	{
+		append(other.c_str(), other.length());
+	}
+	FixedString& operator=(const FixedString& other)
+	{
+		FixedStringBase::operator=(other);
+		return *this;
+	}
+	FixedString& operator=(const FixedStringBase& other)
+	{
+		FixedStringBase::operator=(other);
+		return *this;
+	}
+	FixedString& operator=(const char* text)
+	{
+		FixedStringBase::operator=(text);
+		return *this;
+	}
+};
+
+typedef FixedString<10> FixedString10;
+typedef FixedString<16> FixedString16;
+typedef FixedString<20> FixedString20;
+typedef FixedString<32> FixedString32;
+typedef FixedString<50> FixedString50;
+typedef FixedString<64> FixedString64;
+typedef FixedString<100> FixedString100;
+typedef FixedString<128> FixedString128;
+typedef FixedString<200> FixedString200;
+typedef FixedString<256> FixedString256;
+typedef FixedString<512> FixedString512;
+
+#endif
@@ -0,0 +1,100 @@
+#include "AtTranscriptRecorder.h"
+
+static void WriteUint32(uint8_t* target, uint32_t value)
+{
+	target[0] = value & 0xFF;
+	target[1] = (value >> 8) & 0xFF;
+	target[2] = (value >> 16) & 0xFF;
+	target[3] = (value >> 24) & 0xFF;
+}
+
+static uint32_t ReadUint32(const uint8_t* source)
+{
+	return static_cast<uint32_t>(source[0]) |
+		(static_cast<uint32_t>(source[1]) << 8) |
+		(static_cast<uint32_t>(source[2]) << 16) |
+		(static_cast<uint32_t>(source[3]) << 24);
+}
+
+AtTranscriptRecorder::AtTranscriptRecorder(AtTranscriptEntry* entries, size_t capacity):
+	_entries(entries),
+	_capacity(capacity),
+	_head(0),
+	_count(0),
+	_droppedEntries(0)
+{
+}
+
+void AtTranscriptRecorder::Record(AtTranscriptDirection direction, const char* data, size_t length)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		Record(direction, static_cast<uint8_t>(data[i]));
+	}
+}
+
+void AtTranscriptRecorder::Clear()
+{
+	_head = 0;
+	_count = 0;
+	_droppedEntries = 0;
+}
+
+const AtTranscriptEntry& AtTranscriptRecorder::Entry(size_t index)
+{
+	auto start = _count < _capacity ? 0 : _head;
+	auto position = start + index;
+	if (position >= _capacity)
+	{
+		position -= _capacity;
+	}
+	return _entries[position];
+}
+
+size_t AtTranscriptRecorder::Dump(Print& output)
+{
+	uint8_t header[AtTranscriptHeaderSize] = { 'A', 'T', 'T', 'R', AtTranscriptDumpVersion, 0, 0, 0 };
+	WriteUint32(header + 8, _count);
+	WriteUint32(header + 12, _droppedEntries);
+	size_t written = output.write(header, sizeof(header));
+
+	for (size_t i = 0; i < _count; i++)
+	{
+		const auto& entry = Entry(i);
+		uint8_t record[AtTranscriptRecordSize];
+		WriteUint32(record, entry.TimestampUs);
+		record[4] = static_cast<uint8_t>(entry.Direction);
+		record[5] = entry.Value;
+		written += output.write(record, sizeof(record));
+	}
+	return written;
+}
+
+bool AtTranscriptRecorder::ReadHeader(const uint8_t* dump, size_t length, uint32_t& entryCount, uint32_t& droppedEntries)
+{
+	if (length < AtTranscriptHeaderSize)
+	{
+		return false;
+	}
+	if (memcmp(dump, "ATTR", 4) != 0 || dump[4] != AtTranscriptDumpVersion)
+	{
+		return false;
+	}
+	entryCount = ReadUint32(dump + 8);
+	droppedEntries = ReadUint32(dump + 12);
+	return length >= AtTranscriptHeaderSize + static_cast<size_t>(entryCount) * AtTranscriptRecordSize;
+}
+
+bool AtTranscriptRecorder::ReadEntry(const uint8_t* dump, size_t length, uint32_t index, AtTranscriptEntry& entry)
+{
+	auto offset = AtTranscriptHeaderSize + static_cast<size_t>(index) * AtTranscriptRecordSize;
+	if (offset + AtTranscriptRecordSize > length)
+	{
+		return false;
+	}
+	auto record = dump + offset;
+	entry.TimestampUs = ReadUint32(record);
+	entry.Direction = static_cast<AtTranscriptDirection>(record[4]);
+	entry.Value = record[5];
+	return true;
+}
@@ -0,0 +1,83 @@
+#ifndef _AT_TRANSCRIPT_RECORDER_H
+#define _AT_TRANSCRIPT_RECORDER_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+
+enum class AtTranscriptDirection : uint8_t
+{
+	ToModem,
+	FromModem
+};
+
+struct AtTranscriptEntry
+{
+	uint32_t TimestampUs;
+	AtTranscriptDirection Direction;
+	uint8_t Value;
+};
+
+/*
+Dump layout (little endian):
+  "ATTR" magic, uint8 version, uint8 reserved[3], uint32 entry count, uint32 dropped entries
+  followed by entry count records of: uint32 timestamp in us, uint8 direction, uint8 byte
+*/
+const uint8_t AtTranscriptDumpVersion = 1;
+const size_t AtTranscriptHeaderSize = 16;
+const size_t AtTranscriptRecordSize = 6;
+
+/*
+Records every byte exchanged with the modem into a caller provided ring buffer,
+once buffer is full oldest entries are overwritten
+*/
+class AtTranscriptRecorder
+{
+	AtTranscriptEntry* _entries;
+	size_t _capacity;
+	size_t _head;
+	size_t _count;
+	uint32_t _droppedEntries;
+public:
+	AtTranscriptRecorder(AtTranscriptEntry* entries, size_t capacity);
+	bool IsCapturing = true;
+
+	void Record(AtTranscriptDirection direction, uint8_t value)
+	{
+		if (!IsCapturing || _capacity == 0)
+		{
+			return;
+		}
+		auto& entry = _entries[_head];
+		entry.TimestampUs = micros();
+		entry.Direction = direction;
+		entry.Value = value;
+		_head = _head + 1 == _capacity ? 0 : _head + 1;
+		if (_count < _capacity)
+		{
+			_count++;
+		}
+		else
+		{
+			_droppedEntries++;
+		}
+	}
+	void Record(AtTranscriptDirection direction, const char* data, size_t length);
+	void Clear();
+	size_t Count()
+	{
+		return _count;
+	}
+	uint32_t DroppedEntries()
+	{
+		return _droppedEntries;
+	}
+	// index 0 is the oldest entry
+	const AtTranscriptEntry& Entry(size_t index);
+	size_t Dump(Print& output);
+
+	static bool ReadHeader(const uint8_t* dump, size_t length, uint32_t& entryCount, uint32_t& droppedEntries);
+	static bool ReadEntry(const uint8_t* dump, size_t length, uint32_t index, AtTranscriptEntry& entry);
+};
+
+#endif
@@ -0,0 +1,197 @@
+#include "AtTranscriptReplayer.h"
+
+struct ReplayCommandEntry
+{
+	const char* prefix;
+	AtCommand command;
+};
+
+// more specific prefixes must come first
+static const ReplayCommandEntry _replayCommands[] =
+{
+	{ "AT+CPIN?", AtCommand::Cpin },
+	{ "AT+CIPSTATUS=", AtCommand::CipstatusSingleConnection },
+	{ "AT+CIPSTATUS", AtCommand::Cipstatus },
+	{ "AT+CSQ", AtCommand::Csq },
+	{ "AT+CIFSR", AtCommand::Cifsr },
+	{ "AT+COPS?", AtCommand::Cops },
+	{ "AT+CREG?", AtCommand::Creg },
+	{ "AT+GSN", AtCommand::Gsn },
+	{ "AT+CIPSHUT", AtCommand::Cipshut },
+	{ "AT+CIPCLOSE", AtCommand::Cipclose },
+	{ "AT+CUSD", AtCommand::Cusd },
+	{ "AT+CBC", AtCommand::Cbc },
+	{ "AT+CLCC", AtCommand::Clcc },
+	{ "AT+CIPMUX?;", AtCommand::ModemConfigQuery },
+	{ "AT+CIPMUX?", AtCommand::Cipmux },
+	{ "AT+CIPRXGET?", AtCommand::CipRxGet },
+	{ "AT+CIPRXGET=2", AtCommand::CipRxGetRead },
+	{ "AT+CIPQSEND?", AtCommand::CipQsendQuery },
+	{ "AT+CMTE?", AtCommand::Cmte },
+	{ "AT+CDNSGIP", AtCommand::Cdnsgip },
+	{ "AT+CIPACK", AtCommand::Cipack },
+	{ "AT+SAPBR=2", AtCommand::Sapbr },
+	{ "AT+HTTPDATA", AtCommand::HttpData },
+	{ "AT+HTTPREAD", AtCommand::HttpRead },
+	{ "AT+FTPPUT=2", AtCommand::FtpPut },
+	{ "AT+FTPGET=2", AtCommand::FtpGet },
+	{ "AT+FTPSIZE", AtCommand::FtpSize },
+	{ nullptr, AtCommand::Generic }
+};
+
+AtTranscriptReplayer::AtTranscriptReplayer():
+	_parser(_parserContext, _logger, _nullStream, _currentCommand),
+	_commandSentUs(0),
+	_isWaitingForResponse(false),
+	_signalQuality(0),
+	_ipState(SimcomIpState::Unknown),
+	_rxAvailableBytes(0),
+	_temperature(0),
+	_cipackSentBytes(0),
+	_cipackAckedBytes(0),
+	_bearerStatus(BearerStatus::Closed),
+	_httpReadBytes(0),
+	_ftpDataLength(0),
+	_ftpSize(0)
+{
+	_logger.LogEnabled = false;
+	_parser.IsGarbageDetectionActive = false;
+
+	_parserContext.CsqSignalQuality = &_signalQuality;
+	_parserContext.IpAddress = &_ipAddress;
+	_parserContext.OperatorName = &_operatorName;
+	_parserContext.UssdResponse = &_ussdResponse;
+	_parserContext.Imei = &_imei;
+	_parserContext.BatteryInfo = &_batteryStatus;
+	_parserContext.CallInfo = &_callInfo;
+	_parserContext.IpState = &_ipState;
+	_parserContext.CurrentConnectionInfo = &_connectionInfo;
+	_parserContext.CipRxGetBuffer = &_rxBuffer;
+	_parserContext.CiprxGetLeftBytesToRead = 0;
+	_parserContext.CiprxGetAvailableBytes = &_rxAvailableBytes;
+	_parserContext.Temperature = &_temperature;
+	_parserContext.ModemConfig = &_modemConfig;
+	_parserContext.CipackSentBytes = &_cipackSentBytes;
+	_parserContext.CipackAckedBytes = &_cipackAckedBytes;
+	_parserContext.Bearer = &_bearerStatus;
+	_parserContext.HttpReadBytes = &_httpReadBytes;
+	_parserContext.FtpDataLength = &_ftpDataLength;
+	_parserContext.FtpSize = &_ftpSize;
+}
+
+AtCommand AtTranscriptReplayer::CommandTypeFromText(FixedStringBase& command)
+{
+	for (auto entry = _replayCommands; entry->prefix != nullptr; entry++)
+	{
+		if (strncmp(command.c_str(), entry->prefix, strlen(entry->prefix)) == 0)
+		{
+			return entry->command;
+		}
+	}
+	return AtCommand::Generic;
+}
+
+void AtTranscriptReplayer::BeginCommand(AtTranscriptReplayStats& stats)
+{
+	_currentCommand = _outgoingLine;
+	_outgoingLine.clear();
+
+	if (_currentCommand.startsWith(F("AT+CIPMUX=")))
+	{
+		_parserContext.Cipmux = _currentCommand.endsWith(F("1"));
+	}
+	_rxBuffer.clear();
+	_parserContext.CiprxGetLeftBytesToRead = 0;
+
+	// At() is the only command sent without echo expectation
+	const auto expectEcho = !_currentCommand.equals(F("AT"));
+	_parser.SetCommandType(CommandTypeFromText(_currentCommand), expectEcho);
+	_isWaitingForResponse = true;
+	stats.Commands++;
+}
+
+void AtTranscriptReplayer::Feed(const AtTranscriptEntry& entry, AtTranscriptReplayStats& stats)
+{
+	const char c = static_cast<char>(entry.Value);
+	if (entry.Direction == AtTranscriptDirection::ToModem)
+	{
+		stats.OutgoingBytes++;
+		if (c == '\n')
+		{
+			if (_outgoingLine.length() > 0)
+			{
+				_commandSentUs = entry.TimestampUs;
+				BeginCommand(stats);
+			}
+			return;
+		}
+		if (c != '\r')
+		{
+			_outgoingLine.append(c);
+		}
+		return;
+	}
+
+	stats.IncomingBytes++;
+	// modem never answers in the middle of a command, anything buffered here was payload
+	_outgoingLine.clear();
+
+	_parser.FeedChar(c);
+
+	if (_isWaitingForResponse && _parser.commandReady)
+	{
+		_isWaitingForResponse = false;
+		stats.CompletedCommands++;
+		const uint32_t responseUs = entry.TimestampUs - _commandSentUs;
+		stats.TotalResponseUs += responseUs;
+		if (responseUs > stats.MaxResponseUs)
+		{
+			stats.MaxResponseUs = responseUs;
+			stats.SlowestCommand = _currentCommand;
+		}
+	}
+}
+
+void AtTranscriptReplayer::Feed(AtTranscriptDirection direction, const char* data, size_t length, AtTranscriptReplayStats& stats)
+{
+	AtTranscriptEntry entry;
+	entry.TimestampUs = micros();
+	entry.Direction = direction;
+	for (size_t i = 0; i < length; i++)
+	{
+		entry.Value = static_cast<uint8_t>(data[i]);
+		Feed(entry, stats);
+	}
+}
+
+bool AtTranscriptReplayer::Replay(const uint8_t* dump, size_t length, AtTranscriptReplayStats& stats)
+{
+	uint32_t entryCount;
+	uint32_t droppedEntries;
+	if (!AtTranscriptRecorder::ReadHeader(dump, length, entryCount, droppedEntries))
+	{
+		return false;
+	}
+	const auto start = micros();
+	for (uint32_t i = 0; i < entryCount; i++)
+	{
+		AtTranscriptEntry entry;
+		if (!AtTranscriptRecorder::ReadEntry(dump, length, i, entry))
+		{
+			return false;
+		}
+		Feed(entry, stats);
+	}
+	stats.ReplayTimeUs += micros() - start;
+	return true;
+}
+
+void AtTranscriptReplayer::Replay(AtTranscriptRecorder& recorder, AtTranscriptReplayStats& stats)
+{
+	const auto start = micros();
+	for (size_t i = 0; i < recorder.Count(); i++)
+	{
+		Feed(recorder.Entry(i), stats);
+	}
+	stats.ReplayTimeUs += micros() - start;
+}
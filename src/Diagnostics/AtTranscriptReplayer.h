@@ -0,0 +1,85 @@
+#ifndef _AT_TRANSCRIPT_REPLAYER_H
+#define _AT_TRANSCRIPT_REPLAYER_H
+
+#include <Arduino.h>
+#include <FixedString.h>
+#include "AtTranscriptRecorder.h"
+#include "../Parsing/SimcomResponseParser.h"
+#include "../Parsing/ParserContext.h"
+#include "../GsmLogger.h"
+
+struct AtTranscriptReplayStats
+{
+	uint32_t IncomingBytes = 0;
+	uint32_t OutgoingBytes = 0;
+	uint32_t Commands = 0;
+	uint32_t CompletedCommands = 0;
+	// response times as seen on the device that recorded transcript
+	uint32_t MaxResponseUs = 0;
+	uint64_t TotalResponseUs = 0;
+	FixedString64 SlowestCommand;
+	// time spent replaying on this machine
+	uint32_t ReplayTimeUs = 0;
+};
+
+/*
+Feeds recorded transcript back through SimcomResponseParser so parser changes and
+field problems (stalls, slow responses) can be reproduced without a modem.
+Command type is derived from recorded command text, CIPSEND payloads are replayed as generic commands.
+*/
+class AtTranscriptReplayer
+{
+	class NullStream : public Stream
+	{
+	public:
+		int available() override { return 0; }
+		int read() override { return -1; }
+		int peek() override { return -1; }
+		size_t write(uint8_t) override { return 1; }
+	};
+
+	NullStream _nullStream;
+	GsmLogger _logger;
+	ParserContext _parserContext;
+	// same size as SimcomAtCommands::_currentCommand, parser matches echo against it
+	FixedString256 _currentCommand;
+	SimcomResponseParser _parser;
+	FixedString256 _outgoingLine;
+	uint32_t _commandSentUs;
+	bool _isWaitingForResponse;
+
+	int16_t _signalQuality;
+	GsmIp _ipAddress;
+	FixedString32 _operatorName;
+	FixedString128 _ussdResponse;
+	FixedString32 _imei;
+	BatteryStatus _batteryStatus;
+	IncomingCallInfo _callInfo;
+	SimcomIpState _ipState;
+	ConnectionInfo _connectionInfo;
+	FixedString<1460> _rxBuffer;
+	uint16_t _rxAvailableBytes;
+	float _temperature;
+	ModemConfiguration _modemConfig;
+	uint32_t _cipackSentBytes;
+	uint32_t _cipackAckedBytes;
+	BearerStatus _bearerStatus;
+	uint16_t _httpReadBytes;
+	uint16_t _ftpDataLength;
+	uint32_t _ftpSize;
+
+	void BeginCommand(AtTranscriptReplayStats& stats);
+	static AtCommand CommandTypeFromText(FixedStringBase& command);
+public:
+	AtTranscriptReplayer();
+	GsmLogger& Logger()
+	{
+		return _logger;
+	}
+	void Feed(const AtTranscriptEntry& entry, AtTranscriptReplayStats& stats);
+	void Feed(AtTranscriptDirection direction, const char* data, size_t length, AtTranscriptReplayStats& stats);
+	bool Replay(const uint8_t* dump, size_t length, AtTranscriptReplayStats& stats);
+	void Replay(AtTranscriptRecorder& recorder, AtTranscriptReplayStats& stats);
+};
+
+#endif
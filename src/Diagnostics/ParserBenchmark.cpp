@@ -0,0 +1,308 @@
+#include "ParserBenchmark.h"
+#include "../Parsing/DelimParser.h"
+#include "../Parsing/ParsingHelpers.h"
+#include "../Parsing/SequenceDetector.h"
+
+struct BenchmarkExchange
+{
+	const char* command;
+	const char* response;
+};
+
+static const BenchmarkExchange _syntheticExchanges[] =
+{
+	{ "AT+CIPMUX=1", "AT+CIPMUX=1\r\n\r\nOK\r\n" },
+	{ "AT+CSQ", "AT+CSQ\r\n\r\n+CSQ: 17,0\r\n\r\nOK\r\n" },
+	{ "AT+CREG?", "AT+CREG?\r\n\r\n+CREG: 2,1,\"07E6\",\"D68F\"\r\n\r\nOK\r\n" },
+	{ "AT+CBC", "AT+CBC\r\n\r\n+CBC: 0,85,4012\r\n\r\nOK\r\n" },
+	{ "AT+CMTE?", "AT+CMTE?\r\n\r\n+CMTE: 0,31.5\r\n\r\nOK\r\n" },
+	{ "AT+CIPSTATUS", "AT+CIPSTATUS\r\n\r\nOK\r\n\r\nSTATE: IP PROCESSING\r\n\r\n"
+		"C: 0,0,\"TCP\",\"93.184.216.34\",\"80\",\"CONNECTED\"\r\n"
+		"C: 1,,\"\",\"\",\"\",\"INITIAL\"\r\n"
+		"C: 2,,\"\",\"\",\"\",\"INITIAL\"\r\n"
+		"C: 3,,\"\",\"\",\"\",\"INITIAL\"\r\n"
+		"C: 4,,\"\",\"\",\"\",\"INITIAL\"\r\n"
+		"C: 5,,\"\",\"\",\"\",\"INITIAL\"\r\n" },
+	{ "AT+CIPRXGET=2,0,256", "AT+CIPRXGET=2,0,256\r\n\r\n+CIPRXGET: 2,0,32,0\r\n"
+		"{\"t\":21.5,\"h\":40,\"v\":4012,\"s\":1}\r\nOK\r\n\r\n1, CLOSED\r\n" },
+	{ nullptr, nullptr }
+};
+
+static uint32_t CountLines(const char* data, size_t length)
+{
+	uint32_t lines = 0;
+	for (size_t i = 0; i < length; i++)
+	{
+		if (data[i] == '\n')
+		{
+			lines++;
+		}
+	}
+	return lines;
+}
+
+static void FillPayload(FixedStringBase& payload)
+{
+	payload.clear();
+	uint8_t n = 0;
+	while (payload.freeBytes() > 0)
+	{
+		payload.append(static_cast<char>(' ' + n++ % 95));
+	}
+}
+
+ParserBenchmark::ParserBenchmark(uint32_t iterations):
+	_iterations(iterations)
+{
+}
+
+ParserBenchmarkResult ParserBenchmark::BeginResult(const __FlashStringHelper* name)
+{
+	ParserBenchmarkResult result;
+	result.Name = name;
+	result.Iterations = _iterations;
+	result.Bytes = 0;
+	result.Lines = 0;
+	result.ElapsedUs = 0;
+	result.Parsed = 0;
+	result.Expected = 0;
+	return result;
+}
+
+void ParserBenchmark::EndResult(ParserBenchmarkResult& result, uint32_t start)
+{
+	result.ElapsedUs = micros() - start;
+}
+
+ParserBenchmarkResult ParserBenchmark::FeedCharSynthetic()
+{
+	auto result = BeginResult(F("FeedChar synthetic"));
+	AtTranscriptReplayer replayer;
+	AtTranscriptReplayStats stats;
+
+	uint32_t linesPerIteration = 0;
+	uint32_t commandsPerIteration = 0;
+	for (auto exchange = _syntheticExchanges; exchange->command != nullptr; exchange++)
+	{
+		linesPerIteration += CountLines(exchange->response, strlen(exchange->response));
+		commandsPerIteration++;
+	}
+
+	const uint32_t start = micros();
+	for (uint32_t i = 0; i < _iterations; i++)
+	{
+		for (auto exchange = _syntheticExchanges; exchange->command != nullptr; exchange++)
+		{
+			replayer.Feed(AtTranscriptDirection::ToModem, exchange->command, strlen(exchange->command), stats);
+			replayer.Feed(AtTranscriptDirection::ToModem, "\r\n", 2, stats);
+			replayer.Feed(AtTranscriptDirection::FromModem, exchange->response, strlen(exchange->response), stats);
+		}
+	}
+	EndResult(result, start);
+	result.Bytes = stats.IncomingBytes;
+	result.Lines = linesPerIteration * _iterations;
+	result.Parsed = stats.CompletedCommands;
+	result.Expected = commandsPerIteration * _iterations;
+	return result;
+}
+
+ParserBenchmarkResult ParserBenchmark::FeedCharSocketData()
+{
+	auto result = BeginResult(F("FeedChar CIPRXGET 1460 b"));
+	AtTranscriptReplayer replayer;
+	AtTranscriptReplayStats stats;
+
+	static FixedString<1460> payload;
+	FillPayload(payload);
+	FixedString64 header;
+	header.appendFormat("AT+CIPRXGET=2,0,1460\r\n\r\n+CIPRXGET: 2,0,%d,0\r\n", payload.length());
+	const char* footer = "\r\nOK\r\n";
+
+	const uint32_t start = micros();
+	for (uint32_t i = 0; i < _iterations; i++)
+	{
+		replayer.Feed(AtTranscriptDirection::ToModem, "AT+CIPRXGET=2,0,1460\r\n", 22, stats);
+		replayer.Feed(AtTranscriptDirection::FromModem, header.c_str(), header.length(), stats);
+		replayer.Feed(AtTranscriptDirection::FromModem, payload.c_str(), payload.length(), stats);
+		replayer.Feed(AtTranscriptDirection::FromModem, footer, strlen(footer), stats);
+	}
+	EndResult(result, start);
+	result.Bytes = stats.IncomingBytes;
+	result.Lines = (CountLines(header.c_str(), header.length()) + CountLines(footer, strlen(footer))) * _iterations;
+	result.Parsed = stats.CompletedCommands;
+	result.Expected = _iterations;
+	return result;
+}
+
+ParserBenchmarkResult ParserBenchmark::FeedCharTranscript(const uint8_t* dump, size_t length)
+{
+	auto result = BeginResult(F("FeedChar transcript"));
+	AtTranscriptReplayer replayer;
+	AtTranscriptReplayStats stats;
+
+	uint32_t entryCount;
+	uint32_t droppedEntries;
+	if (!AtTranscriptRecorder::ReadHeader(dump, length, entryCount, droppedEntries))
+	{
+		return result;
+	}
+	for (uint32_t i = 0; i < entryCount; i++)
+	{
+		AtTranscriptEntry entry;
+		if (AtTranscriptRecorder::ReadEntry(dump, length, i, entry) &&
+			entry.Direction == AtTranscriptDirection::FromModem && entry.Value == '\n')
+		{
+			result.Lines++;
+		}
+	}
+
+	for (uint32_t i = 0; i < _iterations; i++)
+	{
+		replayer.Replay(dump, length, stats);
+	}
+	result.ElapsedUs = stats.ReplayTimeUs;
+	result.Bytes = stats.IncomingBytes;
+	result.Lines *= _iterations;
+	result.Parsed = stats.CompletedCommands;
+	return result;
+}
+
+ParserBenchmarkResult ParserBenchmark::DelimParserCreg()
+{
+	auto result = BeginResult(F("DelimParser +CREG"));
+	FixedString64 line;
+	line.append("+CREG: 2,1,\"07E6\",\"D68F\"");
+	volatile uint32_t checksum = 0;
+
+	const uint32_t start = micros();
+	for (uint32_t i = 0; i < _iterations; i++)
+	{
+		DelimParser parser(line);
+		uint8_t state = 0;
+		uint16_t lac = 0;
+		uint16_t cellId = 0;
+		if (parser.StartsWith(F("+CREG: ")) &&
+			parser.Skip(1) &&
+			parser.NextNum(state) &&
+			parser.NextNum(lac, false, 16) &&
+			parser.NextNum(cellId, false, 16))
+		{
+			checksum += state + lac + cellId;
+			result.Parsed++;
+		}
+	}
+	EndResult(result, start);
+	result.Bytes = line.length() * _iterations;
+	result.Lines = _iterations;
+	result.Expected = _iterations;
+	return result;
+}
+
+ParserBenchmarkResult ParserBenchmark::SocketStatusLine()
+{
+	auto result = BeginResult(F("ParseSocketStatusLine"));
+	FixedString64 line;
+	line.append("C: 0,0,\"TCP\",\"93.184.216.34\",\"80\",\"CONNECTED\"");
+	volatile uint32_t checksum = 0;
+
+	const uint32_t start = micros();
+	for (uint32_t i = 0; i < _iterations; i++)
+	{
+		DelimParser parser(line);
+		ConnectionInfo info;
+		if (parser.StartsWith(F("C: ")) && ParsingHelpers::ParseSocketStatusLine(parser, info))
+		{
+			checksum += info.Port;
+			result.Parsed++;
+		}
+	}
+	EndResult(result, start);
+	result.Bytes = line.length() * _iterations;
+	result.Lines = _iterations;
+	result.Expected = _iterations;
+	return result;
+}
+
+ParserBenchmarkResult ParserBenchmark::IpAddress()
+{
+	auto result = BeginResult(F("ParseIpAddress"));
+	FixedString32 line;
+	line.append("10.170.34.7");
+	volatile uint32_t checksum = 0;
+
+	const uint32_t start = micros();
+	for (uint32_t i = 0; i < _iterations; i++)
+	{
+		GsmIp ip;
+		if (ParsingHelpers::ParseIpAddress(line, ip))
+		{
+			checksum += ip._octets[3];
+			result.Parsed++;
+		}
+	}
+	EndResult(result, start);
+	result.Bytes = line.length() * _iterations;
+	result.Lines = _iterations;
+	result.Expected = _iterations;
+	return result;
+}
+
+ParserBenchmarkResult ParserBenchmark::SequenceDetectorEcho()
+{
+	auto result = BeginResult(F("SequenceDetector echo 1460 b"));
+	static FixedString<1460> payload;
+	FillPayload(payload);
+	SequenceDetector detector;
+	volatile uint32_t detected = 0;
+
+	const uint32_t start = micros();
+	for (uint32_t i = 0; i < _iterations; i++)
+	{
+		detector.SetSequence(payload.c_str(), payload.length());
+		for (size_t j = 0; j < payload.length(); j++)
+		{
+			if (detector.NextChar(payload[j]))
+			{
+				detected++;
+			}
+		}
+	}
+	EndResult(result, start);
+	result.Bytes = payload.length() * _iterations;
+	// payload is its own sequence, found once per pass
+	result.Parsed = detected;
+	result.Expected = _iterations;
+	return result;
+}
+
+void ParserBenchmark::RunAll(void* ctx, ParserBenchmarkResultHandler onResult)
+{
+	onResult(ctx, FeedCharSynthetic());
+	onResult(ctx, FeedCharSocketData());
+	onResult(ctx, DelimParserCreg());
+	onResult(ctx, SocketStatusLine());
+	onResult(ctx, IpAddress());
+	onResult(ctx, SequenceDetectorEcho());
+}
+
+void ParserBenchmark::PrintResult(Print& output, const ParserBenchmarkResult& result)
+{
+	// %s cannot read flash on AVR/ESP8266
+	char name[31];
+	strncpy_P(name, (PGM_P)result.Name, sizeof(name) - 1);
+	name[sizeof(name) - 1] = 0;
+	FixedString128 line;
+	line.appendFormat("%-30s %8u b %6u lines %8u us %6u.%u ns/b %8u lines/s\r\n",
+		name,
+		result.Bytes, result.Lines, result.ElapsedUs,
+		static_cast<uint32_t>(result.NsPerByte()),
+		static_cast<uint32_t>(result.NsPerByte() * 10) % 10,
+		static_cast<uint32_t>(result.LinesPerSecond()));
+	output.print(line.c_str());
+	if (!result.IsParsedAsExpected())
+	{
+		line.clear();
+		line.appendFormat("  parsed %u of %u expected\r\n", result.Parsed, result.Expected);
+		output.print(line.c_str());
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef _PARSER_BENCHMARK_H
+#define _PARSER_BENCHMARK_H
+
+#include <Arduino.h>
+#include <FixedString.h>
+#include "AtTranscriptReplayer.h"
+
+struct ParserBenchmarkResult
+{
+	const __FlashStringHelper* Name;
+	uint32_t Iterations;
+	uint32_t Bytes;
+	uint32_t Lines;
+	uint32_t ElapsedUs;
+	// completed commands or successful parses, Expected is 0 when not known (recorded transcript)
+	uint32_t Parsed;
+	uint32_t Expected;
+
+	float NsPerByte() const
+	{
+		return Bytes == 0 ? 0 : ElapsedUs * 1000.0f / Bytes;
+	}
+	float LinesPerSecond() const
+	{
+		return ElapsedUs == 0 ? 0 : Lines * 1000000.0f / ElapsedUs;
+	}
+	// false when parser missed responses it recognized before
+	bool IsParsedAsExpected() const
+	{
+		return Expected == 0 || Parsed == Expected;
+	}
+};
+
+typedef void(*ParserBenchmarkResultHandler)(void* ctx, const ParserBenchmarkResult& result);
+
+/*
+Measures per byte cost of the parsing layer: SimcomResponseParser::FeedChar,
+DelimParser, ParsingHelpers and SequenceDetector
+*/
+class ParserBenchmark
+{
+	uint32_t _iterations;
+	ParserBenchmarkResult BeginResult(const __FlashStringHelper* name);
+	void EndResult(ParserBenchmarkResult& result, uint32_t start);
+public:
+	ParserBenchmark(uint32_t iterations = 1000);
+
+	ParserBenchmarkResult FeedCharSynthetic();
+	ParserBenchmarkResult FeedCharSocketData();
+	ParserBenchmarkResult FeedCharTranscript(const uint8_t* dump, size_t length);
+	ParserBenchmarkResult DelimParserCreg();
+	ParserBenchmarkResult SocketStatusLine();
+	ParserBenchmarkResult IpAddress();
+	ParserBenchmarkResult SequenceDetectorEcho();
+
+	void RunAll(void* ctx, ParserBenchmarkResultHandler onResult);
+	static void PrintResult(Print& output, const ParserBenchmarkResult& result);
+};
+
+#endif
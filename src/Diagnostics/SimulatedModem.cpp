@@ -0,0 +1,1107 @@
+#include "SimulatedModem.h"
+#include "../GsmLibConstants.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <algorithm>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// connect to local server normally finishes at once, this only guards against unreachable hosts
+const unsigned long SimulatedConnectTimeout = 20000;
+
+SimulatedModem::Connection::Connection():
+	Fd(-1),
+	IsUdp(false),
+	State(MuxState::Initial),
+	ConnectStart(0),
+	IsRemoteClosed(false),
+	UplinkFreeAt(0),
+	DownlinkFreeAt(0),
+	TxBytes(0),
+	AckedBytes(0),
+	Port(0)
+{
+}
+
+SimulatedModem::SimulatedModem():
+	_outputReleasedAt(0),
+	_outputCredit(0),
+	_isEcho(true),
+	_isLfSkipped(false),
+	_cipmux(false),
+	_cipQSend(false),
+	_isRxManual(false),
+	_isTransparent(false),
+	_cregMode(0),
+	_isClip(false),
+	_isUssdPending(false),
+	_ussdAt(0),
+	_sendMux(-1),
+	_sendLeft(0),
+	_isBearerOpen(false),
+	_isHttpInitialized(false),
+	_dataLeft(0),
+	_dataTarget(nullptr),
+	_httpActionMethod(-1),
+	_httpActionAt(0),
+	_httpStatus(0),
+	_isFtpAppend(false),
+	_ftpRest(0),
+	_ftpSession(FtpSession::None),
+	_ftpOpenAt(0),
+	_isFtpOpen(false),
+	_isFtpClosing(false),
+	_isFtpWaiting(false),
+	_ftpSessionBytes(0),
+	_ftpLinkFreeAt(0),
+	_ftpGetPosition(0)
+{
+}
+
+SimulatedModem::~SimulatedModem()
+{
+	for (int i = 0; i < SimulatedMuxCount; i++)
+	{
+		CloseConnection(_connections[i]);
+	}
+}
+
+const char* SimulatedModem::StateToStr(MuxState state)
+{
+	switch (state)
+	{
+	case MuxState::Initial: return "INITIAL";
+	case MuxState::Connecting: return "CONNECTING";
+	case MuxState::Connected: return "CONNECTED";
+	case MuxState::Closed: return "CLOSED";
+	}
+	return "INITIAL";
+}
+
+void SimulatedModem::Emit(const char* data, size_t length)
+{
+	_output.insert(_output.end(), data, data + length);
+}
+
+void SimulatedModem::EmitLine(const char* format, ...)
+{
+	char buffer[320];
+	va_list argptr;
+	va_start(argptr, format);
+	const auto length = vsnprintf(buffer, sizeof(buffer), format, argptr);
+	va_end(argptr);
+	Emit("\r\n", 2);
+	Emit(buffer, length < static_cast<int>(sizeof(buffer)) ? length : sizeof(buffer) - 1);
+	Emit("\r\n", 2);
+}
+
+int SimulatedModem::available()
+{
+	Pump();
+	if (Shaping.SerialBytesPerSecond == 0)
+	{
+		return _output.size();
+	}
+	return static_cast<int>(_outputCredit);
+}
+
+int SimulatedModem::read()
+{
+	if (available() == 0)
+	{
+		return -1;
+	}
+	const auto c = static_cast<uint8_t>(_output.front());
+	_output.pop_front();
+	_outputCredit = _outputCredit >= 1 ? _outputCredit - 1 : 0;
+	return c;
+}
+
+int SimulatedModem::peek()
+{
+	if (available() == 0)
+	{
+		return -1;
+	}
+	return static_cast<uint8_t>(_output.front());
+}
+
+void SimulatedModem::flush()
+{
+}
+
+size_t SimulatedModem::write(uint8_t c)
+{
+	const auto isLfSkipped = _isLfSkipped;
+	_isLfSkipped = false;
+	if (_dataLeft > 0 && !(isLfSkipped && c == '\n'))
+	{
+		_dataTarget->push_back(static_cast<char>(c));
+		if (--_dataLeft > 0)
+		{
+			return 1;
+		}
+		if (_dataTarget == &_ftpChunk)
+		{
+			const auto now = millis();
+			FtpFiles[_ftpPutFile].append(_ftpChunk);
+			_ftpSessionBytes += _ftpChunk.size();
+			const auto start = static_cast<long>(_ftpLinkFreeAt - now) > 0 ? _ftpLinkFreeAt : now;
+			_ftpLinkFreeAt = start + (Shaping.UplinkBytesPerSecond == 0 ? 0 : _ftpChunk.size() * 1000 / Shaping.UplinkBytesPerSecond);
+		}
+		EmitLine("OK");
+		return 1;
+	}
+	if (_sendMux >= 0 && !(isLfSkipped && c == '\n'))
+	{
+		// CIPSEND data phase, modem echoes data when echo is on
+		_sendData.push_back(static_cast<char>(c));
+		if (_isEcho)
+		{
+			_output.push_back(static_cast<char>(c));
+		}
+		if (--_sendLeft == 0)
+		{
+			CompleteSend();
+		}
+		return 1;
+	}
+	if (_isEcho)
+	{
+		_output.push_back(static_cast<char>(c));
+	}
+	if (c == '\r')
+	{
+		ProcessLine();
+		_line.clear();
+		_isLfSkipped = true;
+	}
+	else if (c != '\n' && _line.freeBytes() > 0)
+	{
+		_line.append(static_cast<char>(c));
+	}
+	return 1;
+}
+
+void SimulatedModem::ProcessLine()
+{
+	if (_line.length() < 2 || strncasecmp(_line.c_str(), "AT", 2) != 0)
+	{
+		return;
+	}
+	_stats.Commands++;
+	// AT+A;+B;E1 is split, last part decides final result
+	char commands[300];
+	strncpy(commands, _line.c_str() + 2, sizeof(commands) - 1);
+	commands[sizeof(commands) - 1] = 0;
+	char* context = nullptr;
+	auto command = strtok_r(commands, ";", &context);
+	if (command == nullptr)
+	{
+		EmitLine("OK");
+		return;
+	}
+	while (command != nullptr)
+	{
+		auto next = strtok_r(nullptr, ";", &context);
+		const auto result = ProcessCommand(command);
+		if (result == CommandResult::Error)
+		{
+			EmitLine("ERROR");
+			return;
+		}
+		if (next == nullptr && result == CommandResult::Ok)
+		{
+			EmitLine("OK");
+		}
+		command = next;
+	}
+}
+
+SimulatedModem::CommandResult SimulatedModem::ProcessCommand(const char* command)
+{
+	int mux;
+	int value;
+	if (strcmp(command, "E0") == 0 || strcmp(command, "E1") == 0)
+	{
+		_isEcho = command[1] == '1';
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "+CPIN?") == 0)
+	{
+		EmitLine("+CPIN: READY");
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "+CSQ") == 0)
+	{
+		EmitLine("+CSQ: 20,0");
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "+CBC") == 0)
+	{
+		EmitLine("+CBC: 0,85,4100");
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "+CREG?") == 0)
+	{
+		EmitLine("+CREG: %d,1,\"07E6\",\"D68F\"", _cregMode);
+		return CommandResult::Ok;
+	}
+	if (sscanf(command, "+CREG=%d", &value) == 1)
+	{
+		_cregMode = value;
+		return CommandResult::Ok;
+	}
+	if (strncmp(command, "+CUSD=1,", 8) == 0)
+	{
+		_isUssdPending = true;
+		_ussdAt = millis() + UssdDelay;
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "+CUSD=2") == 0)
+	{
+		_isUssdPending = false;
+		return CommandResult::Ok;
+	}
+	if (sscanf(command, "+CLIP=%d", &value) == 1)
+	{
+		_isClip = value == 1;
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "+COPS?") == 0)
+	{
+		EmitLine("+COPS: 0,0,\"SIMULATED\"");
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "+GSN") == 0)
+	{
+		EmitLine("490154203237518");
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "+CMTE?") == 0)
+	{
+		EmitLine("+CMTE: 0,25.0");
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "+CIPMUX?") == 0)
+	{
+		EmitLine("+CIPMUX: %d", _cipmux ? 1 : 0);
+		return CommandResult::Ok;
+	}
+	if (sscanf(command, "+CIPMUX=%d", &value) == 1)
+	{
+		_cipmux = value == 1;
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "+CIPQSEND?") == 0)
+	{
+		EmitLine("+CIPQSEND: %d", _cipQSend ? 1 : 0);
+		return CommandResult::Ok;
+	}
+	if (sscanf(command, "+CIPQSEND=%d", &value) == 1)
+	{
+		_cipQSend = value == 1;
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "+CIPMODE?") == 0)
+	{
+		EmitLine("+CIPMODE: %d", _isTransparent ? 1 : 0);
+		return CommandResult::Ok;
+	}
+	if (sscanf(command, "+CIPMODE=%d", &value) == 1)
+	{
+		_isTransparent = value == 1;
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "+CIPRXGET?") == 0)
+	{
+		EmitLine("+CIPRXGET: %d", _isRxManual ? 1 : 0);
+		return CommandResult::Ok;
+	}
+	int length;
+	if (sscanf(command, "+CIPRXGET=2,%d,%d", &mux, &length) == 2)
+	{
+		if (mux < 0 || mux >= SimulatedMuxCount || _connections[mux].State != MuxState::Connected)
+		{
+			return CommandResult::Error;
+		}
+		ReadConnection(mux, length);
+		return CommandResult::Ok;
+	}
+	if (sscanf(command, "+CIPRXGET=%d", &value) == 1)
+	{
+		_isRxManual = value == 1;
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "+CIPSHUT") == 0)
+	{
+		for (int i = 0; i < SimulatedMuxCount; i++)
+		{
+			CloseConnection(_connections[i]);
+			_connections[i].State = MuxState::Initial;
+		}
+		EmitLine("SHUT OK");
+		return CommandResult::Custom;
+	}
+	if (strcmp(command, "+CIFSR") == 0)
+	{
+		// no OK after address
+		EmitLine("10.64.0.2");
+		return CommandResult::Custom;
+	}
+	if (strcmp(command, "+CIPSTATUS") == 0)
+	{
+		EmitLine("OK");
+		EmitLine("STATE: IP STATUS");
+		if (_cipmux)
+		{
+			for (int i = 0; i < SimulatedMuxCount; i++)
+			{
+				auto& connection = _connections[i];
+				if (connection.State == MuxState::Initial)
+				{
+					EmitLine("C: %d,,\"\",\"\",\"\",\"INITIAL\"", i);
+					continue;
+				}
+				EmitLine("C: %d,0,\"%s\",\"%s\",\"%d\",\"%s\"", i, connection.IsUdp ? "UDP" : "TCP",
+					connection.Address.c_str(), connection.Port, StateToStr(connection.State));
+			}
+		}
+		return CommandResult::Custom;
+	}
+	if (sscanf(command, "+CIPSTATUS=%d", &mux) == 1)
+	{
+		if (mux < 0 || mux >= SimulatedMuxCount)
+		{
+			return CommandResult::Error;
+		}
+		auto& connection = _connections[mux];
+		EmitLine("+CIPSTATUS: %d,0,\"%s\",\"%s\",\"%d\",\"%s\"", mux, connection.IsUdp ? "UDP" : "TCP",
+			connection.Address.c_str(), connection.Port, StateToStr(connection.State));
+		return CommandResult::Ok;
+	}
+	char protocol[8];
+	char address[SOCKET_MAX_HOST_LENGTH + 1];
+	int port;
+	if (sscanf(command, "+CIPSTART=%d,\"%7[^\"]\",\"%200[^\"]\",\"%d\"", &mux, protocol, address, &port) == 4)
+	{
+		if (!_cipmux || mux < 0 || mux >= SimulatedMuxCount)
+		{
+			return CommandResult::Error;
+		}
+		if (_connections[mux].State == MuxState::Connecting || _connections[mux].State == MuxState::Connected)
+		{
+			EmitLine("%d, ALREADY CONNECT", mux);
+			return CommandResult::Custom;
+		}
+		EmitLine("OK");
+		StartConnection(mux, protocol, address, port);
+		return CommandResult::Custom;
+	}
+	if (sscanf(command, "+CIPSEND=%d,%d", &mux, &length) == 2)
+	{
+		if (mux < 0 || mux >= SimulatedMuxCount || _connections[mux].State != MuxState::Connected ||
+			length <= 0 || length > MaxSendLength)
+		{
+			return CommandResult::Error;
+		}
+		Emit("\r\n> ", 4);
+		_sendMux = mux;
+		_sendLeft = length;
+		_sendData.clear();
+		return CommandResult::Custom;
+	}
+	if (sscanf(command, "+CIPACK=%d", &mux) == 1)
+	{
+		if (mux < 0 || mux >= SimulatedMuxCount || _connections[mux].IsUdp)
+		{
+			return CommandResult::Error;
+		}
+		auto& connection = _connections[mux];
+		EmitLine("+CIPACK: %u,%u,%u", connection.TxBytes, connection.AckedBytes, connection.TxBytes - connection.AckedBytes);
+		return CommandResult::Ok;
+	}
+	if (sscanf(command, "+CIPCLOSE=%d", &mux) == 1)
+	{
+		if (mux < 0 || mux >= SimulatedMuxCount ||
+			(_connections[mux].State != MuxState::Connected && _connections[mux].State != MuxState::Connecting))
+		{
+			return CommandResult::Error;
+		}
+		CloseConnection(_connections[mux]);
+		EmitLine("%d, CLOSE OK", mux);
+		return CommandResult::Custom;
+	}
+	if (sscanf(command, "+CDNSGIP=\"%200[^\"]\"", address) == 1)
+	{
+		EmitLine("OK");
+		addrinfo hints = {};
+		hints.ai_family = AF_INET;
+		addrinfo* info = nullptr;
+		if (getaddrinfo(address, nullptr, &hints, &info) != 0 || info == nullptr)
+		{
+			EmitLine("+CDNSGIP: 0,8");
+			return CommandResult::Custom;
+		}
+		char ip[INET_ADDRSTRLEN];
+		inet_ntop(AF_INET, &reinterpret_cast<sockaddr_in*>(info->ai_addr)->sin_addr, ip, sizeof(ip));
+		freeaddrinfo(info);
+		EmitLine("+CDNSGIP: 1,\"%s\",\"%s\"", address, ip);
+		return CommandResult::Custom;
+	}
+	if (sscanf(command, "+SAPBR=%d,1", &value) == 1)
+	{
+		if (value == 2)
+		{
+			EmitLine("+SAPBR: 1,%d,\"%s\"", _isBearerOpen ? 1 : 3, _isBearerOpen ? "10.64.0.3" : "0.0.0.0");
+			return CommandResult::Ok;
+		}
+		if (value == 1 || value == 0)
+		{
+			// opening open bearer fails same as on SIM900
+			if (_isBearerOpen == (value == 1))
+			{
+				return CommandResult::Error;
+			}
+			_isBearerOpen = value == 1;
+		}
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "+HTTPINIT") == 0 || strcmp(command, "+HTTPTERM") == 0)
+	{
+		const auto isInit = command[5] == 'I';
+		if (_isHttpInitialized == isInit)
+		{
+			return CommandResult::Error;
+		}
+		_isHttpInitialized = isInit;
+		_httpResponse.clear();
+		return CommandResult::Ok;
+	}
+	char parameter[300];
+	if (sscanf(command, "+HTTPPARA=\"URL\",\"%299[^\"]\"", parameter) == 1)
+	{
+		_httpUrl = parameter;
+		return _isHttpInitialized ? CommandResult::Ok : CommandResult::Error;
+	}
+	if (sscanf(command, "+HTTPPARA=\"CONTENT\",\"%299[^\"]\"", parameter) == 1)
+	{
+		_httpContentType = parameter;
+		return _isHttpInitialized ? CommandResult::Ok : CommandResult::Error;
+	}
+	if (sscanf(command, "+HTTPDATA=%d,%d", &length, &value) == 2)
+	{
+		if (!_isHttpInitialized || length <= 0)
+		{
+			return CommandResult::Error;
+		}
+		EmitLine("DOWNLOAD");
+		_httpData.clear();
+		_dataTarget = &_httpData;
+		_dataLeft = length;
+		return CommandResult::Custom;
+	}
+	if (sscanf(command, "+HTTPACTION=%d", &value) == 1)
+	{
+		if (!_isHttpInitialized || _httpActionMethod >= 0 || value < 0 || value > 2)
+		{
+			return CommandResult::Error;
+		}
+		EmitLine("OK");
+		StartHttpAction(value);
+		return CommandResult::Custom;
+	}
+	unsigned offset;
+	unsigned readLength;
+	if (sscanf(command, "+HTTPREAD=%u,%u", &offset, &readLength) == 2)
+	{
+		if (!_isHttpInitialized || _httpActionMethod >= 0)
+		{
+			return CommandResult::Error;
+		}
+		if (offset >= _httpResponse.size())
+		{
+			return CommandResult::Ok;
+		}
+		const auto size = std::min<size_t>(readLength, _httpResponse.size() - offset);
+		EmitLine("+HTTPREAD: %d", static_cast<int>(size));
+		Emit(_httpResponse.c_str() + offset, size);
+		return CommandResult::Ok;
+	}
+	if (strncmp(command, "+FTP", 4) == 0)
+	{
+		return ProcessFtpCommand(command + 4);
+	}
+	// AT, ATE, AT+CSTT, AT+CIICR, AT+CFUN, AT+CSCLK, AT+IPR and other settings are accepted as is
+	return CommandResult::Ok;
+}
+
+void SimulatedModem::StartConnection(uint8_t mux, const char* protocol, const char* address, uint16_t port)
+{
+	auto& connection = _connections[mux];
+	CloseConnection(connection);
+	connection = Connection();
+	connection.IsUdp = strcmp(protocol, "UDP") == 0;
+	connection.Address = address;
+	connection.Port = port;
+	connection.State = MuxState::Connecting;
+	connection.ConnectStart = millis();
+
+	addrinfo hints = {};
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = connection.IsUdp ? SOCK_DGRAM : SOCK_STREAM;
+	addrinfo* info = nullptr;
+	char portStr[8];
+	snprintf(portStr, sizeof(portStr), "%d", port);
+	if (getaddrinfo(address, portStr, &hints, &info) != 0 || info == nullptr)
+	{
+		// reported as CONNECT FAIL by PumpConnection
+		return;
+	}
+	connection.Fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+	if (connection.Fd >= 0)
+	{
+		fcntl(connection.Fd, F_SETFL, fcntl(connection.Fd, F_GETFL, 0) | O_NONBLOCK);
+		if (connect(connection.Fd, info->ai_addr, info->ai_addrlen) != 0 && errno != EINPROGRESS)
+		{
+			close(connection.Fd);
+			connection.Fd = -1;
+		}
+	}
+	freeaddrinfo(info);
+}
+
+void SimulatedModem::CloseConnection(Connection& connection)
+{
+	if (connection.Fd >= 0)
+	{
+		close(connection.Fd);
+		connection.Fd = -1;
+	}
+	connection.Uplink.clear();
+	connection.Downlink.clear();
+	connection.RxBuffer.clear();
+	if (connection.State != MuxState::Initial)
+	{
+		connection.State = MuxState::Closed;
+	}
+}
+
+void SimulatedModem::QueueChunk(std::deque<Chunk>& queue, unsigned long& linkFreeAt, uint32_t bytesPerSecond, const char* data, size_t length, bool isUdp)
+{
+	const auto now = millis();
+	if (Shaping.LossPercent > 0 && static_cast<uint8_t>(rand() % 100) < Shaping.LossPercent)
+	{
+		_stats.LostChunks++;
+		if (isUdp)
+		{
+			return;
+		}
+		// TCP retransmission, chunk arrives one round trip later
+		linkFreeAt = (static_cast<long>(linkFreeAt - now) > 0 ? linkFreeAt : now) + Shaping.RoundTripMs;
+	}
+	const auto start = static_cast<long>(linkFreeAt - now) > 0 ? linkFreeAt : now;
+	linkFreeAt = start + (bytesPerSecond == 0 ? 0 : length * 1000 / bytesPerSecond);
+	Chunk chunk;
+	chunk.DeliverAt = linkFreeAt + Shaping.RoundTripMs / 2;
+	chunk.Data.assign(data, length);
+	queue.push_back(chunk);
+}
+
+void SimulatedModem::CompleteSend()
+{
+	auto& connection = _connections[_sendMux];
+	const auto length = _sendData.size();
+	QueueChunk(connection.Uplink, connection.UplinkFreeAt, Shaping.UplinkBytesPerSecond, _sendData.c_str(), length, connection.IsUdp);
+	connection.TxBytes += length;
+	if (_cipQSend)
+	{
+		EmitLine("DATA ACCEPT:%d,%d", _sendMux, static_cast<int>(length));
+	}
+	else
+	{
+		EmitLine("%d, SEND OK", _sendMux);
+	}
+	_sendMux = -1;
+	_sendData.clear();
+}
+
+void SimulatedModem::StartHttpAction(uint8_t method)
+{
+	_httpActionMethod = method;
+	_httpResponse.clear();
+	_httpStatus = 601;
+	_httpActionAt = millis() + Shaping.RoundTripMs * 2;
+	auto url = _httpUrl.c_str();
+	if (strncmp(url, "http://", 7) == 0)
+	{
+		url += 7;
+	}
+	char host[128];
+	const auto hostLength = strcspn(url, ":/");
+	if (!_isBearerOpen || hostLength == 0 || hostLength >= sizeof(host))
+	{
+		return;
+	}
+	memcpy(host, url, hostLength);
+	host[hostLength] = 0;
+	url += hostLength;
+	long port = 80;
+	if (*url == ':')
+	{
+		char* end;
+		port = strtol(url + 1, &end, 10);
+		url = end;
+	}
+	const std::string path = *url == '/' ? url : "/";
+	addrinfo hints = {};
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo* info = nullptr;
+	char portStr[8];
+	snprintf(portStr, sizeof(portStr), "%ld", port);
+	if (getaddrinfo(host, portStr, &hints, &info) != 0 || info == nullptr)
+	{
+		_httpStatus = 603;
+		return;
+	}
+	const auto fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+	const auto isConnected = fd >= 0 && connect(fd, info->ai_addr, info->ai_addrlen) == 0;
+	freeaddrinfo(info);
+	if (!isConnected)
+	{
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+		return;
+	}
+	// blocking exchange with local server, modem does the same in background
+	timeval timeout = { 5, 0 };
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	static const char* methods[] = { "GET", "POST", "HEAD" };
+	std::string request = std::string(methods[method]) + " " + path + " HTTP/1.0\r\nHost: " + host + "\r\n";
+	if (method == 1)
+	{
+		request += "Content-Type: " + _httpContentType + "\r\nContent-Length: " + std::to_string(_httpData.size()) + "\r\n";
+	}
+	request += "\r\n";
+	if (method == 1)
+	{
+		request += _httpData;
+	}
+	send(fd, request.c_str(), request.size(), MSG_NOSIGNAL);
+	std::string response;
+	char buffer[1460];
+	ssize_t received;
+	while ((received = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+	{
+		response.append(buffer, received);
+	}
+	close(fd);
+	const auto headerEnd = response.find("\r\n\r\n");
+	int status;
+	if (headerEnd == std::string::npos || sscanf(response.c_str(), "HTTP/%*s %d", &status) != 1)
+	{
+		return;
+	}
+	_httpStatus = status;
+	_httpResponse = response.substr(headerEnd + 4);
+	_stats.DownlinkBytes += response.size();
+	_stats.UplinkBytes += request.size();
+	if (Shaping.DownlinkBytesPerSecond != 0)
+	{
+		_httpActionAt += _httpResponse.size() * 1000 / Shaping.DownlinkBytesPerSecond;
+	}
+}
+
+SimulatedModem::CommandResult SimulatedModem::ProcessFtpCommand(const char* command)
+{
+	char value[128];
+	unsigned number;
+	if (sscanf(command, "PUTPATH=\"%127[^\"]\"", value) == 1)
+	{
+		_ftpPutPath = value;
+		return CommandResult::Ok;
+	}
+	if (sscanf(command, "PUTNAME=\"%127[^\"]\"", value) == 1)
+	{
+		_ftpPutName = value;
+		return CommandResult::Ok;
+	}
+	if (sscanf(command, "GETPATH=\"%127[^\"]\"", value) == 1)
+	{
+		_ftpGetPath = value;
+		return CommandResult::Ok;
+	}
+	if (sscanf(command, "GETNAME=\"%127[^\"]\"", value) == 1)
+	{
+		_ftpGetName = value;
+		return CommandResult::Ok;
+	}
+	if (sscanf(command, "PUTOPT=\"%127[^\"]\"", value) == 1)
+	{
+		_isFtpAppend = strcmp(value, "APPE") == 0;
+		return CommandResult::Ok;
+	}
+	if (sscanf(command, "REST=%u", &number) == 1)
+	{
+		_ftpRest = number;
+		return CommandResult::Ok;
+	}
+	if (strcmp(command, "SIZE") == 0)
+	{
+		EmitLine("OK");
+		const auto file = FtpFiles.find(_ftpGetPath + _ftpGetName);
+		if (!_isBearerOpen || file == FtpFiles.end())
+		{
+			EmitLine("+FTPSIZE: 1,66,0");
+		}
+		else
+		{
+			EmitLine("+FTPSIZE: 1,0,%u", static_cast<unsigned>(file->second.size()));
+		}
+		return CommandResult::Custom;
+	}
+	const auto now = millis();
+	if (strcmp(command, "PUT=1") == 0 || strcmp(command, "GET=1") == 0)
+	{
+		if (!_isBearerOpen || _ftpSession != FtpSession::None)
+		{
+			return CommandResult::Error;
+		}
+		_ftpSession = command[0] == 'P' ? FtpSession::Put : FtpSession::Get;
+		_ftpOpenAt = now + Shaping.RoundTripMs * 2;
+		_isFtpOpen = false;
+		_isFtpClosing = false;
+		_isFtpWaiting = false;
+		_ftpSessionBytes = 0;
+		_ftpLinkFreeAt = _ftpOpenAt;
+		if (_ftpSession == FtpSession::Put)
+		{
+			_ftpPutFile = _ftpPutPath + _ftpPutName;
+			auto& file = FtpFiles[_ftpPutFile];
+			if (!_isFtpAppend)
+			{
+				file.clear();
+			}
+		}
+		else
+		{
+			_ftpGetFile = _ftpGetPath + _ftpGetName;
+			_ftpGetPosition = _ftpRest;
+			if (FtpFiles.find(_ftpGetFile) == FtpFiles.end())
+			{
+				EmitLine("OK");
+				EmitLine("+FTPGET: 1,66");
+				_ftpSession = FtpSession::None;
+				return CommandResult::Custom;
+			}
+		}
+		return CommandResult::Ok;
+	}
+	if (sscanf(command, "PUT=2,%u", &number) == 1)
+	{
+		if (_ftpSession != FtpSession::Put || !_isFtpOpen || _isFtpClosing)
+		{
+			return CommandResult::Error;
+		}
+		if (number == 0)
+		{
+			_isFtpClosing = true;
+			return CommandResult::Ok;
+		}
+		// modem buffers about two chunks while previous ones are transmitted
+		if (FtpPendingUplinkBytes(now) >= FtpMaxChunkLength * 2u)
+		{
+			_isFtpWaiting = true;
+			EmitLine("+FTPPUT: 2,0");
+			return CommandResult::Ok;
+		}
+		const auto accepted = number < FtpMaxChunkLength ? number : FtpMaxChunkLength;
+		EmitLine("+FTPPUT: 2,%u", accepted);
+		_ftpChunk.clear();
+		_dataTarget = &_ftpChunk;
+		_dataLeft = accepted;
+		return CommandResult::Custom;
+	}
+	if (sscanf(command, "GET=2,%u", &number) == 1)
+	{
+		if (_ftpSession != FtpSession::Get || !_isFtpOpen)
+		{
+			return CommandResult::Error;
+		}
+		const auto readable = FtpReadableBytes(now);
+		auto length = number < readable ? number : readable;
+		length = length < MaxReadLength ? length : MaxReadLength;
+		EmitLine("+FTPGET: 2,%u", length);
+		Emit(FtpFiles[_ftpGetFile].c_str() + _ftpGetPosition, length);
+		_ftpGetPosition += length;
+		_ftpSessionBytes += length;
+		_isFtpWaiting = length < number;
+		if (_isFtpClosing && length == 0)
+		{
+			_ftpSession = FtpSession::None;
+		}
+		return CommandResult::Ok;
+	}
+	// FTPCID, FTPSERV, FTPPORT, FTPUN, FTPPW, FTPTYPE, FTPMODE
+	return CommandResult::Ok;
+}
+
+uint32_t SimulatedModem::FtpPendingUplinkBytes(unsigned long now)
+{
+	if (static_cast<long>(_ftpLinkFreeAt - now) <= 0 || Shaping.UplinkBytesPerSecond == 0)
+	{
+		return 0;
+	}
+	return (_ftpLinkFreeAt - now) * Shaping.UplinkBytesPerSecond / 1000;
+}
+
+uint32_t SimulatedModem::FtpReadableBytes(unsigned long now)
+{
+	const auto size = FtpFiles[_ftpGetFile].size();
+	const uint32_t total = size > _ftpRest ? size - _ftpRest : 0;
+	uint32_t arrived = total;
+	if (Shaping.DownlinkBytesPerSecond != 0)
+	{
+		const auto elapsed = static_cast<long>(now - _ftpOpenAt) > 0 ? now - _ftpOpenAt : 0;
+		const auto received = static_cast<uint64_t>(elapsed) * Shaping.DownlinkBytesPerSecond / 1000;
+		arrived = received < total ? received : total;
+	}
+	const auto read = _ftpGetPosition - _ftpRest;
+	return arrived > read ? arrived - read : 0;
+}
+
+void SimulatedModem::PumpFtp(unsigned long now)
+{
+	if (_ftpSession == FtpSession::None || static_cast<long>(now - _ftpOpenAt) < 0)
+	{
+		return;
+	}
+	const auto isPut = _ftpSession == FtpSession::Put;
+	if (FtpFailAfterBytes != 0 && _ftpSessionBytes >= FtpFailAfterBytes)
+	{
+		if (isPut)
+		{
+			// data still waiting in modem buffer never reaches server
+			auto& file = FtpFiles[_ftpPutFile];
+			file.resize(file.size() - std::min<size_t>(file.size(), FtpPendingUplinkBytes(now)));
+		}
+		EmitLine(isPut ? "+FTPPUT: 1,61" : "+FTPGET: 1,61");
+		FtpFailAfterBytes = 0;
+		_ftpSession = FtpSession::None;
+		return;
+	}
+	if (!_isFtpOpen)
+	{
+		_isFtpOpen = true;
+		if (isPut)
+		{
+			EmitLine("+FTPPUT: 1,1,%u", FtpMaxChunkLength);
+			return;
+		}
+		_isFtpWaiting = true;
+	}
+	if (isPut)
+	{
+		if (_isFtpClosing && FtpPendingUplinkBytes(now) == 0)
+		{
+			EmitLine("+FTPPUT: 1,0");
+			_ftpSession = FtpSession::None;
+		}
+		else if (_isFtpWaiting && FtpPendingUplinkBytes(now) < FtpMaxChunkLength)
+		{
+			_isFtpWaiting = false;
+			EmitLine("+FTPPUT: 1,1,%u", FtpMaxChunkLength);
+		}
+		return;
+	}
+	// server finished sending, data left in modem buffer is still read with AT+FTPGET=2
+	const auto size = FtpFiles[_ftpGetFile].size();
+	if (!_isFtpClosing && _ftpGetPosition + FtpReadableBytes(now) >= size)
+	{
+		_isFtpClosing = true;
+		EmitLine("+FTPGET: 1,0");
+	}
+	else if (!_isFtpClosing && _isFtpWaiting && FtpReadableBytes(now) > 0)
+	{
+		_isFtpWaiting = false;
+		EmitLine("+FTPGET: 1,1");
+	}
+}
+
+void SimulatedModem::Ring(const char* callerNumber)
+{
+	EmitLine("RING");
+	if (_isClip)
+	{
+		EmitLine("+CLIP: \"%s\",145,\"\",0,\"\",0", callerNumber);
+	}
+}
+
+void SimulatedModem::ReadConnection(uint8_t mux, uint16_t maxLength)
+{
+	auto& connection = _connections[mux];
+	size_t length = connection.RxBuffer.size();
+	if (length > maxLength)
+	{
+		length = maxLength;
+	}
+	if (length > MaxReadLength)
+	{
+		length = MaxReadLength;
+	}
+	EmitLine("+CIPRXGET: 2,%d,%d,%d", mux, static_cast<int>(length), static_cast<int>(connection.RxBuffer.size() - length));
+	// data follows header line, OK comes after it
+	Emit(connection.RxBuffer.c_str(), length);
+	connection.RxBuffer.erase(0, length);
+}
+
+void SimulatedModem::PumpConnection(uint8_t mux, Connection& connection, unsigned long now)
+{
+	if (connection.State == MuxState::Connecting)
+	{
+		if (connection.Fd < 0)
+		{
+			EmitLine("%d, CONNECT FAIL", mux);
+			connection.State = MuxState::Closed;
+			return;
+		}
+		// handshake takes one round trip
+		if (now - connection.ConnectStart < Shaping.RoundTripMs)
+		{
+			return;
+		}
+		pollfd pfd = { connection.Fd, POLLOUT, 0 };
+		if (poll(&pfd, 1, 0) <= 0)
+		{
+			if (now - connection.ConnectStart > SimulatedConnectTimeout)
+			{
+				EmitLine("%d, CONNECT FAIL", mux);
+				CloseConnection(connection);
+			}
+			return;
+		}
+		int error = 0;
+		socklen_t errorLength = sizeof(error);
+		getsockopt(connection.Fd, SOL_SOCKET, SO_ERROR, &error, &errorLength);
+		if (error != 0)
+		{
+			EmitLine("%d, CONNECT FAIL", mux);
+			CloseConnection(connection);
+			return;
+		}
+		connection.State = MuxState::Connected;
+		EmitLine("%d, CONNECT OK", mux);
+		return;
+	}
+	if (connection.State != MuxState::Connected)
+	{
+		return;
+	}
+
+	while (!connection.Uplink.empty() && static_cast<long>(now - connection.Uplink.front().DeliverAt) >= 0)
+	{
+		auto& chunk = connection.Uplink.front();
+		const auto sent = send(connection.Fd, chunk.Data.c_str(), chunk.Data.size(), MSG_NOSIGNAL);
+		if (sent < 0)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				break;
+			}
+			connection.IsRemoteClosed = true;
+			connection.Uplink.clear();
+			break;
+		}
+		_stats.UplinkBytes += sent;
+		connection.AckedBytes += sent;
+		if (static_cast<size_t>(sent) < chunk.Data.size())
+		{
+			chunk.Data.erase(0, sent);
+			break;
+		}
+		connection.Uplink.pop_front();
+	}
+
+	char buffer[1460];
+	while (!connection.IsRemoteClosed)
+	{
+		const auto received = recv(connection.Fd, buffer, sizeof(buffer), 0);
+		if (received > 0)
+		{
+			QueueChunk(connection.Downlink, connection.DownlinkFreeAt, Shaping.DownlinkBytesPerSecond, buffer, received, connection.IsUdp);
+			continue;
+		}
+		if (received == 0 && !connection.IsUdp)
+		{
+			connection.IsRemoteClosed = true;
+		}
+		else if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+		{
+			connection.IsRemoteClosed = !connection.IsUdp;
+		}
+		break;
+	}
+
+	while (!connection.Downlink.empty() && static_cast<long>(now - connection.Downlink.front().DeliverAt) >= 0)
+	{
+		auto& chunk = connection.Downlink.front();
+		connection.RxBuffer.append(chunk.Data);
+		_stats.DownlinkBytes += chunk.Data.size();
+		connection.Downlink.pop_front();
+	}
+
+	// report close once everything sent by remote was read
+	if (connection.IsRemoteClosed && connection.Downlink.empty() && connection.RxBuffer.empty())
+	{
+		CloseConnection(connection);
+		EmitLine("%d, CLOSED", mux);
+	}
+}
+
+void SimulatedModem::Pump()
+{
+	const auto now = millis();
+	if (Shaping.SerialBytesPerSecond != 0)
+	{
+		_outputCredit += static_cast<double>(now - _outputReleasedAt) * Shaping.SerialBytesPerSecond / 1000.0;
+		if (_outputCredit > _output.size())
+		{
+			_outputCredit = _output.size();
+		}
+	}
+	_outputReleasedAt = now;
+	// modem does not interleave URCs with CIPSEND data
+	if (_sendMux >= 0)
+	{
+		return;
+	}
+	for (uint8_t i = 0; i < SimulatedMuxCount; i++)
+	{
+		PumpConnection(i, _connections[i], now);
+	}
+	PumpFtp(now);
+	if (_isUssdPending && static_cast<long>(now - _ussdAt) >= 0)
+	{
+		EmitLine("+CUSD: 0,\"%s\",15", UssdReply.c_str());
+		_isUssdPending = false;
+	}
+	if (_httpActionMethod >= 0 && static_cast<long>(now - _httpActionAt) >= 0)
+	{
+		EmitLine("+HTTPACTION: %d,%d,%d", _httpActionMethod, _httpStatus, static_cast<int>(_httpResponse.size()));
+		_httpActionMethod = -1;
+	}
+}
+
+#endif
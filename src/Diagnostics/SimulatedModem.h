@@ -0,0 +1,223 @@
+#ifndef _SIMULATED_MODEM_H
+#define _SIMULATED_MODEM_H
+
+// host only, needs POSIX sockets and Arduino compatibility layer providing Stream and millis()
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <Arduino.h>
+#include <Stream.h>
+#include <FixedString.h>
+#include <deque>
+#include <map>
+#include <string>
+
+const int SimulatedMuxCount = 6;
+
+/*
+Link shaping applied between modem and remote host, defaults resemble GPRS class 10.
+Lost TCP segments are delayed by one round trip (retransmission), lost UDP datagrams are dropped.
+*/
+struct SimulatedLinkShaping
+{
+	SimulatedLinkShaping()
+	{
+		DownlinkBytesPerSecond = 5000;
+		UplinkBytesPerSecond = 2500;
+		RoundTripMs = 600;
+		LossPercent = 0;
+		SerialBytesPerSecond = 11520;
+	}
+	uint32_t DownlinkBytesPerSecond;
+	uint32_t UplinkBytesPerSecond;
+	uint32_t RoundTripMs;
+	uint8_t LossPercent;
+	// UART speed between library and modem, 0 for unlimited
+	uint32_t SerialBytesPerSecond;
+};
+
+struct SimulatedModemStats
+{
+	SimulatedModemStats()
+	{
+		Commands = 0;
+		UplinkBytes = 0;
+		DownlinkBytes = 0;
+		LostChunks = 0;
+	}
+	uint32_t Commands;
+	uint64_t UplinkBytes;
+	uint64_t DownlinkBytes;
+	uint32_t LostChunks;
+};
+
+/*
+Fake SIM900 on host side, pass it as serial to SimcomAtCommands.
+Answers commands used by GsmModule with canned responses and terminates
+CIPSTART/CIPSEND/CIPRXGET/CIPCLOSE on real TCP/UDP sockets, so GsmAsyncSocket
+and SocketManager can be measured end to end against local echo or sink server.
+AT+HTTPACTION runs plain HTTP/1.0 request against local server, AT+FTPPUT/FTPGET
+work on in-memory FtpFiles instead of real FTP server.
+Everything runs from Stream calls, no threads. +CIPRXGET: 1,n URCs are not sent,
+GsmModule reads sockets on every loop anyway.
+*/
+class SimulatedModem : public Stream
+{
+	enum class MuxState : uint8_t
+	{
+		Initial,
+		Connecting,
+		Connected,
+		Closed
+	};
+
+	enum class CommandResult : uint8_t
+	{
+		Ok,
+		Error,
+		// command wrote its own final response
+		Custom
+	};
+
+	struct Chunk
+	{
+		unsigned long DeliverAt;
+		std::string Data;
+	};
+
+	struct Connection
+	{
+		Connection();
+		int Fd;
+		bool IsUdp;
+		MuxState State;
+		unsigned long ConnectStart;
+		bool IsRemoteClosed;
+		unsigned long UplinkFreeAt;
+		unsigned long DownlinkFreeAt;
+		// +CIPACK counters, acknowledged means written to remote socket
+		uint32_t TxBytes;
+		uint32_t AckedBytes;
+		std::deque<Chunk> Uplink;
+		std::deque<Chunk> Downlink;
+		// delivered data waiting for CIPRXGET=2
+		std::string RxBuffer;
+		FixedString32 Address;
+		uint16_t Port;
+	};
+
+	Connection _connections[SimulatedMuxCount];
+	// bytes for library, released at serial speed
+	std::deque<char> _output;
+	unsigned long _outputReleasedAt;
+	double _outputCredit;
+	FixedString<300> _line;
+	bool _isEcho;
+	// LF after command CR is not part of CIPSEND data
+	bool _isLfSkipped;
+	bool _cipmux;
+	bool _cipQSend;
+	bool _isRxManual;
+	bool _isTransparent;
+	uint8_t _cregMode;
+	bool _isClip;
+	// +CUSD: is reported once this time passes
+	bool _isUssdPending;
+	unsigned long _ussdAt;
+	// CIPSEND data phase
+	int8_t _sendMux;
+	uint16_t _sendLeft;
+	std::string _sendData;
+	bool _isBearerOpen;
+	bool _isHttpInitialized;
+	std::string _httpUrl;
+	std::string _httpContentType;
+	// AT+HTTPDATA and AT+FTPPUT=2 data phase, data is not echoed
+	uint32_t _dataLeft;
+	std::string* _dataTarget;
+	std::string _httpData;
+	std::string _httpResponse;
+	// +HTTPACTION result is reported once this time passes, -1 when no request is running
+	int8_t _httpActionMethod;
+	unsigned long _httpActionAt;
+	uint16_t _httpStatus;
+	enum class FtpSession : uint8_t
+	{
+		None,
+		Put,
+		Get
+	};
+	std::string _ftpPutFile;
+	std::string _ftpGetFile;
+	std::string _ftpPutPath;
+	std::string _ftpPutName;
+	std::string _ftpGetPath;
+	std::string _ftpGetName;
+	bool _isFtpAppend;
+	uint32_t _ftpRest;
+	FtpSession _ftpSession;
+	// session URCs are not sent before this time
+	unsigned long _ftpOpenAt;
+	bool _isFtpOpen;
+	bool _isFtpClosing;
+	// upload: refused chunk, +FTPPUT: 1,1 is sent once buffer drains, download: +FTPGET: 1,1 is sent once data arrives
+	bool _isFtpWaiting;
+	uint32_t _ftpSessionBytes;
+	unsigned long _ftpLinkFreeAt;
+	std::string _ftpChunk;
+	// file offset of next downloaded byte
+	uint32_t _ftpGetPosition;
+	SimulatedModemStats _stats;
+
+	void Pump();
+	void PumpConnection(uint8_t mux, Connection& connection, unsigned long now);
+	void Emit(const char* data, size_t length);
+	void EmitLine(const char* format, ...);
+	void ProcessLine();
+	CommandResult ProcessCommand(const char* command);
+	void StartConnection(uint8_t mux, const char* protocol, const char* address, uint16_t port);
+	void CloseConnection(Connection& connection);
+	void QueueChunk(std::deque<Chunk>& queue, unsigned long& linkFreeAt, uint32_t bytesPerSecond, const char* data, size_t length, bool isUdp);
+	void ReadConnection(uint8_t mux, uint16_t maxLength);
+	void CompleteSend();
+	void StartHttpAction(uint8_t method);
+	CommandResult ProcessFtpCommand(const char* command);
+	void PumpFtp(unsigned long now);
+	uint32_t FtpPendingUplinkBytes(unsigned long now);
+	uint32_t FtpReadableBytes(unsigned long now);
+	static const char* StateToStr(MuxState state);
+public:
+	SimulatedModem();
+	~SimulatedModem();
+	SimulatedLinkShaping Shaping;
+	// largest CIPSEND accepted, SIM900 refuses more than 1460 bytes
+	uint16_t MaxSendLength = 1460;
+	uint16_t MaxReadLength = 1460;
+	// FTP server content, key is path followed by name, e.g. "/logs/" "a.txt" is "/logs/a.txt"
+	std::map<std::string, std::string> FtpFiles;
+	uint16_t FtpMaxChunkLength = 1360;
+	// one shot fault, FTP session fails with error 61 after that many bytes, data in flight is lost
+	uint32_t FtpFailAfterBytes = 0;
+	const SimulatedModemStats& GetStats()
+	{
+		return _stats;
+	}
+	// text of +CUSD: reply to every USSD request, sent UssdDelay ms after AT+CUSD=1 returned OK
+	std::string UssdReply = "Your balance is 12.34 EUR";
+	uint32_t UssdDelay = 3000;
+	// sends RING and +CLIP: URCs when caller id is enabled, call again every few seconds while call rings
+	void Ring(const char* callerNumber);
+	// advances sockets and shaping, also done by every Stream call
+	void Loop()
+	{
+		Pump();
+	}
+
+	int available() override;
+	int read() override;
+	int peek() override;
+	size_t write(uint8_t c) override;
+	void flush() override;
+};
+
+#endif
+#endif
@@ -0,0 +1,496 @@
+#include "SocketLoadTest.h"
+
+static const uint32_t LatencyBucketLimitsMs[LatencyBucketCount - 1] = { 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000 };
+// bytes at chunk start carrying sequence number
+static const uint8_t ChunkHeaderLength = 4;
+
+LatencyHistogram::LatencyHistogram()
+{
+	memset(Buckets, 0, sizeof(Buckets));
+	Count = 0;
+	MinMs = 0;
+	MaxMs = 0;
+	TotalMs = 0;
+}
+
+void LatencyHistogram::Add(uint32_t latencyMs)
+{
+	uint8_t bucket = 0;
+	while (bucket < LatencyBucketCount - 1 && latencyMs > LatencyBucketLimitsMs[bucket])
+	{
+		bucket++;
+	}
+	Buckets[bucket]++;
+	if (Count == 0 || latencyMs < MinMs)
+	{
+		MinMs = latencyMs;
+	}
+	if (latencyMs > MaxMs)
+	{
+		MaxMs = latencyMs;
+	}
+	Count++;
+	TotalMs += latencyMs;
+}
+
+uint32_t LatencyHistogram::Percentile(uint8_t percent) const
+{
+	if (Count == 0)
+	{
+		return 0;
+	}
+	const uint32_t target = (static_cast<uint64_t>(Count) * percent + 99) / 100;
+	uint32_t seen = 0;
+	for (uint8_t i = 0; i < LatencyBucketCount - 1; i++)
+	{
+		seen += Buckets[i];
+		if (seen >= target)
+		{
+			return LatencyBucketLimitsMs[i] < MaxMs ? LatencyBucketLimitsMs[i] : MaxMs;
+		}
+	}
+	return MaxMs;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+	if (other.Count == 0)
+	{
+		return;
+	}
+	for (uint8_t i = 0; i < LatencyBucketCount; i++)
+	{
+		Buckets[i] += other.Buckets[i];
+	}
+	if (Count == 0 || other.MinMs < MinMs)
+	{
+		MinMs = other.MinMs;
+	}
+	if (other.MaxMs > MaxMs)
+	{
+		MaxMs = other.MaxMs;
+	}
+	Count += other.Count;
+	TotalMs += other.TotalMs;
+}
+
+SocketLoadStats::SocketLoadStats()
+{
+	ChunksSent = 0;
+	ChunksVerified = 0;
+	ChunksLost = 0;
+	ChunksRetransmitted = 0;
+	BytesSent = 0;
+	BytesVerified = 0;
+	IntegrityErrors = 0;
+	Backpressure = 0;
+	PartialSends = 0;
+	Connects = 0;
+	Disconnects = 0;
+	ConnectedMs = 0;
+}
+
+void SocketLoadStats::Merge(const SocketLoadStats& other)
+{
+	ChunksSent += other.ChunksSent;
+	ChunksVerified += other.ChunksVerified;
+	ChunksLost += other.ChunksLost;
+	ChunksRetransmitted += other.ChunksRetransmitted;
+	BytesSent += other.BytesSent;
+	BytesVerified += other.BytesVerified;
+	IntegrityErrors += other.IntegrityErrors;
+	Backpressure += other.Backpressure;
+	PartialSends += other.PartialSends;
+	Connects += other.Connects;
+	Disconnects += other.Disconnects;
+	// sockets run in parallel, longest connected time is the base for total throughput
+	if (other.ConnectedMs > ConnectedMs)
+	{
+		ConnectedMs = other.ConnectedMs;
+	}
+	Latency.Merge(other.Latency);
+}
+
+SocketLoadTest::SocketLoadTest():
+	_laneCount(0),
+	_port(0),
+	_isRunning(false)
+{
+}
+
+uint32_t SocketLoadTest::PatternStart(PayloadPattern pattern, uint32_t sequence)
+{
+	if (pattern == PayloadPattern::Pseudorandom)
+	{
+		// xorshift state must not be zero
+		return sequence * 2654435761u | 1;
+	}
+	return sequence;
+}
+
+uint8_t SocketLoadTest::PatternNext(PayloadPattern pattern, uint32_t& state)
+{
+	switch (pattern)
+	{
+	case PayloadPattern::Pseudorandom:
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state & 0xFF;
+	case PayloadPattern::Text:
+		return ' ' + state++ % 95;
+	default:
+		return state++ & 0xFF;
+	}
+}
+
+bool SocketLoadTest::AddSocket(GsmAsyncSocket* socket, const SocketLoadConfig& config)
+{
+	if (socket == nullptr || _laneCount >= SocketCount)
+	{
+		return false;
+	}
+	auto& lane = _lanes[_laneCount++];
+	lane.Test = this;
+	lane.Socket = socket;
+	lane.Config = config;
+	if (lane.Config.ChunkSize > SocketLoadMaxChunkSize)
+	{
+		lane.Config.ChunkSize = SocketLoadMaxChunkSize;
+	}
+	if (lane.Config.ChunkSize <= ChunkHeaderLength)
+	{
+		lane.Config.ChunkSize = ChunkHeaderLength + 1;
+	}
+	lane.Stats = SocketLoadStats();
+	lane.NextSequence = 0;
+	lane.PendingHead = 0;
+	lane.PendingCount = 0;
+	lane.PendingSent = 0;
+	lane.InFlightBytes = 0;
+	lane.VerifyState = 0;
+	lane.VerifyPosition = 0;
+	lane.IsFailed = false;
+	lane.IsBackpressured = false;
+	lane.LastSend = 0;
+	lane.LastConnectAttempt = 0;
+	lane.ConnectedSince = 0;
+	lane.PartialSendsBase = socket->GetPartialSendCount();
+	lane.LastError.clear();
+	socket->OnSocketEvent(&lane, OnSocketEventStatic);
+	socket->OnDataRecieved(&lane, OnDataReceivedStatic);
+	return true;
+}
+
+void SocketLoadTest::Begin(const char* host, uint16_t port)
+{
+	_host.clear();
+	_host.append(host);
+	_port = port;
+	_isRunning = true;
+	for (uint8_t i = 0; i < _laneCount; i++)
+	{
+		// first connect is not delayed
+		_lanes[i].LastConnectAttempt = millis() - ReconnectInterval;
+	}
+}
+
+void SocketLoadTest::Stop()
+{
+	_isRunning = false;
+	for (uint8_t i = 0; i < _laneCount; i++)
+	{
+		if (!_lanes[i].Socket->IsClosed())
+		{
+			_lanes[i].Socket->Close();
+		}
+	}
+}
+
+void SocketLoadTest::Loop()
+{
+	for (uint8_t i = 0; i < _laneCount; i++)
+	{
+		LoopLane(_lanes[i]);
+	}
+}
+
+void SocketLoadTest::LoopLane(Lane& lane)
+{
+	auto socket = lane.Socket;
+	lane.Stats.PartialSends = socket->GetPartialSendCount() - lane.PartialSendsBase;
+	if (!_isRunning)
+	{
+		return;
+	}
+	if (socket->IsClosed())
+	{
+		if (socket->IsNetworkAvailable() && millis() - lane.LastConnectAttempt >= ReconnectInterval)
+		{
+			lane.LastConnectAttempt = millis();
+			socket->BeginConnect(_host.c_str(), _port);
+		}
+		return;
+	}
+	if (!socket->IsConnected())
+	{
+		return;
+	}
+	UpdateConnectedTime(lane);
+	if (lane.IsFailed)
+	{
+		// stream is out of sync, new connection starts from sequence 0
+		socket->Close();
+		return;
+	}
+	if (!ResendChunks(lane))
+	{
+		return;
+	}
+	while (millis() - lane.LastSend >= lane.Config.ChunkInterval)
+	{
+		if (!CanSendChunk(lane))
+		{
+			if (!lane.IsBackpressured)
+			{
+				lane.IsBackpressured = true;
+				lane.Stats.Backpressure++;
+			}
+			return;
+		}
+		lane.IsBackpressured = false;
+		SendChunk(lane);
+		if (lane.Config.ChunkInterval > 0)
+		{
+			return;
+		}
+	}
+}
+
+bool SocketLoadTest::CanSendChunk(Lane& lane)
+{
+	return lane.PendingCount < SocketLoadMaxPendingChunks &&
+		lane.InFlightBytes + lane.Config.ChunkSize <= lane.Config.MaxInFlight &&
+		lane.Socket->space() >= lane.Config.ChunkSize;
+}
+
+void SocketLoadTest::SendChunk(Lane& lane)
+{
+	auto& pending = lane.Pending[(lane.PendingHead + lane.PendingCount) % SocketLoadMaxPendingChunks];
+	pending.Sequence = lane.NextSequence++;
+	pending.Length = lane.Config.ChunkSize;
+	pending.SentAt = millis();
+	lane.PendingCount++;
+	lane.PendingSent++;
+	lane.InFlightBytes += lane.Config.ChunkSize;
+	lane.LastSend = millis();
+	lane.Stats.ChunksSent++;
+	lane.Stats.BytesSent += lane.Config.ChunkSize;
+	WriteChunk(lane, pending);
+}
+
+// sends chunks lost with previous connection, false while socket has no space for them
+bool SocketLoadTest::ResendChunks(Lane& lane)
+{
+	while (lane.PendingSent < lane.PendingCount)
+	{
+		auto& pending = lane.Pending[(lane.PendingHead + lane.PendingSent) % SocketLoadMaxPendingChunks];
+		if (lane.Socket->space() < pending.Length)
+		{
+			return false;
+		}
+		pending.SentAt = millis();
+		lane.PendingSent++;
+		lane.InFlightBytes += pending.Length;
+		lane.Stats.ChunksRetransmitted++;
+		WriteChunk(lane, pending);
+	}
+	return true;
+}
+
+void SocketLoadTest::WriteChunk(Lane& lane, const Lane::PendingChunk& chunk)
+{
+	_chunk.clear();
+	for (uint8_t i = 0; i < ChunkHeaderLength; i++)
+	{
+		_chunk.append(static_cast<char>(chunk.Sequence >> (i * 8)));
+	}
+	auto state = PatternStart(lane.Config.Pattern, chunk.Sequence);
+	while (_chunk.length() < chunk.Length)
+	{
+		_chunk.append(static_cast<char>(PatternNext(lane.Config.Pattern, state)));
+	}
+	lane.Socket->Send(_chunk);
+}
+
+void SocketLoadTest::OnSocketEventStatic(void* ctx, SocketEventType eventType)
+{
+	auto lane = reinterpret_cast<Lane*>(ctx);
+	lane->Test->OnSocketEvent(*lane, eventType);
+}
+
+void SocketLoadTest::OnDataReceivedStatic(void* ctx, FixedStringBase& data)
+{
+	auto lane = reinterpret_cast<Lane*>(ctx);
+	lane->Test->OnDataReceived(*lane, data);
+}
+
+void SocketLoadTest::OnSocketEvent(Lane& lane, SocketEventType eventType)
+{
+	switch (eventType)
+	{
+	case SocketEventType::ConnectSuccess:
+		lane.Stats.Connects++;
+		lane.ConnectedSince = millis();
+		if (lane.IsFailed)
+		{
+			// stream was out of sync, lost chunks are not re-sent
+			lane.NextSequence = 0;
+			lane.PendingHead = 0;
+			lane.PendingCount = 0;
+		}
+		lane.PendingSent = 0;
+		lane.InFlightBytes = 0;
+		lane.VerifyPosition = 0;
+		lane.IsFailed = false;
+		lane.IsBackpressured = false;
+		lane.LastSend = millis() - lane.Config.ChunkInterval;
+		break;
+	case SocketEventType::Disconnected:
+		if (lane.ConnectedSince == 0)
+		{
+			break;
+		}
+		UpdateConnectedTime(lane);
+		lane.ConnectedSince = 0;
+		lane.Stats.Disconnects++;
+		lane.Stats.ChunksLost += lane.PendingSent;
+		// kept in Pending and re-sent after reconnect
+		lane.PendingSent = 0;
+		lane.InFlightBytes = 0;
+		lane.VerifyPosition = 0;
+		lane.LastConnectAttempt = millis();
+		break;
+	case SocketEventType::ConnectFailed:
+		lane.LastConnectAttempt = millis();
+		break;
+	default:
+		break;
+	}
+}
+
+void SocketLoadTest::OnDataReceived(Lane& lane, FixedStringBase& data)
+{
+	for (size_t i = 0; i < data.length() && !lane.IsFailed; i++)
+	{
+		VerifyByte(lane, static_cast<uint8_t>(data[i]));
+	}
+}
+
+bool SocketLoadTest::VerifyByte(Lane& lane, uint8_t c)
+{
+	if (lane.PendingSent == 0)
+	{
+		lane.LastError.clear();
+		lane.LastError.appendFormat("Socket [%d] unexpected byte %d", lane.Socket->GetMux(), c);
+		Fail(lane);
+		return false;
+	}
+	auto& chunk = lane.Pending[lane.PendingHead];
+	uint8_t expected;
+	if (lane.VerifyPosition < ChunkHeaderLength)
+	{
+		expected = static_cast<uint8_t>(chunk.Sequence >> (lane.VerifyPosition * 8));
+		if (lane.VerifyPosition == ChunkHeaderLength - 1)
+		{
+			lane.VerifyState = PatternStart(lane.Config.Pattern, chunk.Sequence);
+		}
+	}
+	else
+	{
+		expected = PatternNext(lane.Config.Pattern, lane.VerifyState);
+	}
+	if (c != expected)
+	{
+		lane.LastError.clear();
+		lane.LastError.appendFormat("Socket [%d] chunk %u pos %u: expected %d got %d",
+			lane.Socket->GetMux(), chunk.Sequence, lane.VerifyPosition, expected, c);
+		Fail(lane);
+		return false;
+	}
+	lane.VerifyPosition++;
+	lane.Stats.BytesVerified++;
+	lane.InFlightBytes--;
+	if (lane.VerifyPosition == chunk.Length)
+	{
+		lane.Stats.ChunksVerified++;
+		lane.Stats.Latency.Add(millis() - chunk.SentAt);
+		lane.PendingHead = (lane.PendingHead + 1) % SocketLoadMaxPendingChunks;
+		lane.PendingCount--;
+		lane.PendingSent--;
+		lane.VerifyPosition = 0;
+	}
+	return true;
+}
+
+void SocketLoadTest::Fail(Lane& lane)
+{
+	lane.Stats.IntegrityErrors++;
+	lane.IsFailed = true;
+}
+
+void SocketLoadTest::UpdateConnectedTime(Lane& lane)
+{
+	const auto now = millis();
+	lane.Stats.ConnectedMs += now - lane.ConnectedSince;
+	lane.ConnectedSince = now;
+}
+
+SocketLoadStats SocketLoadTest::GetTotalStats()
+{
+	SocketLoadStats total;
+	for (uint8_t i = 0; i < _laneCount; i++)
+	{
+		total.Merge(_lanes[i].Stats);
+	}
+	return total;
+}
+
+void SocketLoadTest::PrintStats(Print& output, const SocketLoadStats& stats)
+{
+	FixedString128 line;
+	line.appendFormat("chunks sent %u verified %u lost %u retransmitted %u\r\n",
+		stats.ChunksSent, stats.ChunksVerified, stats.ChunksLost, stats.ChunksRetransmitted);
+	output.print(line.c_str());
+	line.clear();
+	line.appendFormat("bytes sent %u verified %u\r\n",
+		static_cast<uint32_t>(stats.BytesSent), static_cast<uint32_t>(stats.BytesVerified));
+	output.print(line.c_str());
+	line.clear();
+	line.appendFormat("integrity errors %u, partial sends %u, backpressure %u, connects %u, disconnects %u\r\n",
+		stats.IntegrityErrors, stats.PartialSends, stats.Backpressure, stats.Connects, stats.Disconnects);
+	output.print(line.c_str());
+	line.clear();
+	line.appendFormat("throughput %u B/s over %u ms\r\n", stats.ThroughputBytesPerSecond(), stats.ConnectedMs);
+	output.print(line.c_str());
+	line.clear();
+	line.appendFormat("latency min %u avg %u p50 %u p90 %u p99 %u max %u ms\r\n",
+		stats.Latency.MinMs, stats.Latency.AverageMs(), stats.Latency.Percentile(50),
+		stats.Latency.Percentile(90), stats.Latency.Percentile(99), stats.Latency.MaxMs);
+	output.print(line.c_str());
+	line.clear();
+	line.append("latency ms");
+	for (uint8_t i = 0; i < LatencyBucketCount; i++)
+	{
+		if (i < LatencyBucketCount - 1)
+		{
+			line.appendFormat(" <=%u:%u", LatencyBucketLimitsMs[i], stats.Latency.Buckets[i]);
+		}
+		else
+		{
+			line.appendFormat(" more:%u", stats.Latency.Buckets[i]);
+		}
+	}
+	line.append("\r\n");
+	output.print(line.c_str());
+}
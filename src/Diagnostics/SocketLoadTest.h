@@ -0,0 +1,177 @@
+#ifndef _SOCKET_LOAD_TEST_H
+#define _SOCKET_LOAD_TEST_H
+
+#include <Arduino.h>
+#include <FixedString.h>
+#include "../Network/GsmAsyncSocket.h"
+#include "../Network/SocketManager.h"
+
+const uint16_t SocketLoadMaxChunkSize = 1024;
+// chunks sent but not yet fully echoed, per socket
+const uint8_t SocketLoadMaxPendingChunks = 16;
+const uint8_t LatencyBucketCount = 10;
+
+enum class PayloadPattern : uint8_t
+{
+	// (sequence + position) & 0xFF, same as ConnectionDataValidator
+	Incrementing,
+	// xorshift stream seeded by chunk sequence
+	Pseudorandom,
+	// printable characters, readable in AT logs
+	Text
+};
+
+struct SocketLoadConfig
+{
+	SocketLoadConfig()
+	{
+		Pattern = PayloadPattern::Incrementing;
+		ChunkSize = 256;
+		ChunkInterval = 1000;
+		MaxInFlight = 1024;
+	}
+	PayloadPattern Pattern;
+	// first 4 bytes of each chunk carry its sequence number
+	uint16_t ChunkSize;
+	// ms between chunks, 0 sends as fast as MaxInFlight allows
+	uint32_t ChunkInterval;
+	// bytes sent but not yet echoed back
+	uint32_t MaxInFlight;
+};
+
+// latency of fully echoed chunks, bucket upper bounds are in LatencyBucketLimitsMs
+struct LatencyHistogram
+{
+	LatencyHistogram();
+	uint32_t Buckets[LatencyBucketCount];
+	uint32_t Count;
+	uint32_t MinMs;
+	uint32_t MaxMs;
+	uint64_t TotalMs;
+	void Add(uint32_t latencyMs);
+	// upper bound of bucket containing given percentile, MaxMs for last bucket
+	uint32_t Percentile(uint8_t percent) const;
+	uint32_t AverageMs() const
+	{
+		return Count == 0 ? 0 : TotalMs / Count;
+	}
+	void Merge(const LatencyHistogram& other);
+};
+
+struct SocketLoadStats
+{
+	SocketLoadStats();
+	uint32_t ChunksSent;
+	uint32_t ChunksVerified;
+	// chunks still in flight when connection was lost
+	uint32_t ChunksLost;
+	// lost chunks sent again after reconnect, TCP level retransmissions are not visible over AT
+	uint32_t ChunksRetransmitted;
+	uint64_t BytesSent;
+	uint64_t BytesVerified;
+	uint32_t IntegrityErrors;
+	// chunk was due but socket send buffer or in flight window was full
+	uint32_t Backpressure;
+	uint32_t PartialSends;
+	uint32_t Connects;
+	uint32_t Disconnects;
+	// time spent connected, base for throughput
+	uint32_t ConnectedMs;
+	LatencyHistogram Latency;
+	uint32_t ThroughputBytesPerSecond() const
+	{
+		return ConnectedMs == 0 ? 0 : BytesVerified * 1000 / ConnectedMs;
+	}
+	void Merge(const SocketLoadStats& other);
+};
+
+/*
+Drives several sockets against echo server with configurable payload and rate.
+Every echoed byte is compared with what was sent, so reordering, loss or corruption
+is reported per socket together with throughput and chunk round trip latency.
+Chunks in flight when connection drops are sent again after reconnect.
+Runs on device and on host against SimulatedModem, call Loop after GsmModule::Loop.
+*/
+class SocketLoadTest
+{
+	struct Lane
+	{
+		struct PendingChunk
+		{
+			uint32_t Sequence;
+			uint16_t Length;
+			uint32_t SentAt;
+		};
+
+		SocketLoadTest* Test;
+		GsmAsyncSocket* Socket;
+		SocketLoadConfig Config;
+		SocketLoadStats Stats;
+		uint32_t NextSequence;
+		PendingChunk Pending[SocketLoadMaxPendingChunks];
+		uint8_t PendingHead;
+		uint8_t PendingCount;
+		// pending chunks sent over current connection, the rest is re-sent after reconnect
+		uint8_t PendingSent;
+		uint32_t InFlightBytes;
+		// generator state of chunk being verified
+		uint32_t VerifyState;
+		uint16_t VerifyPosition;
+		// integrity error seen, socket is closed from Loop
+		bool IsFailed;
+		bool IsBackpressured;
+		unsigned long LastSend;
+		unsigned long LastConnectAttempt;
+		unsigned long ConnectedSince;
+		// socket counter is cumulative, stats count from AddSocket
+		uint32_t PartialSendsBase;
+		FixedString100 LastError;
+	};
+
+	Lane _lanes[SocketCount];
+	uint8_t _laneCount;
+	FixedString64 _host;
+	uint16_t _port;
+	bool _isRunning;
+	FixedString<SocketLoadMaxChunkSize> _chunk;
+
+	static void OnSocketEventStatic(void* ctx, SocketEventType eventType);
+	static void OnDataReceivedStatic(void* ctx, FixedStringBase& data);
+	void OnSocketEvent(Lane& lane, SocketEventType eventType);
+	void OnDataReceived(Lane& lane, FixedStringBase& data);
+	void LoopLane(Lane& lane);
+	bool CanSendChunk(Lane& lane);
+	void SendChunk(Lane& lane);
+	bool ResendChunks(Lane& lane);
+	void WriteChunk(Lane& lane, const Lane::PendingChunk& chunk);
+	bool VerifyByte(Lane& lane, uint8_t c);
+	void Fail(Lane& lane);
+	void UpdateConnectedTime(Lane& lane);
+	static uint32_t PatternStart(PayloadPattern pattern, uint32_t sequence);
+	static uint8_t PatternNext(PayloadPattern pattern, uint32_t& state);
+public:
+	SocketLoadTest();
+	// ms between reconnect attempts of closed socket
+	uint32_t ReconnectInterval = 5000;
+	// takes over socket event and data handlers
+	bool AddSocket(GsmAsyncSocket* socket, const SocketLoadConfig& config);
+	void Begin(const char* host, uint16_t port);
+	void Stop();
+	void Loop();
+	uint8_t GetSocketCount()
+	{
+		return _laneCount;
+	}
+	const SocketLoadStats& GetStats(uint8_t index)
+	{
+		return _lanes[index].Stats;
+	}
+	const char* GetLastError(uint8_t index)
+	{
+		return _lanes[index].LastError.c_str();
+	}
+	SocketLoadStats GetTotalStats();
+	static void PrintStats(Print& output, const SocketLoadStats& stats);
+};
+
+#endif
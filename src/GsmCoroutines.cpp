@@ -0,0 +1,101 @@
+#include "GsmCoroutines.h"
+
+#if defined(__cpp_impl_coroutine)
+
+uint8_t GsmCoroutinePool::_frames[GSM_COROUTINE_FRAME_COUNT][GSM_COROUTINE_FRAME_SIZE];
+bool GsmCoroutinePool::_isUsed[GSM_COROUTINE_FRAME_COUNT] = { false };
+
+void* GsmCoroutinePool::Allocate(size_t size)
+{
+	if (size > GSM_COROUTINE_FRAME_SIZE)
+	{
+		return nullptr;
+	}
+	for (int i = 0; i < GSM_COROUTINE_FRAME_COUNT; i++)
+	{
+		if (!_isUsed[i])
+		{
+			_isUsed[i] = true;
+			return _frames[i];
+		}
+	}
+	return nullptr;
+}
+
+void GsmCoroutinePool::Free(void* frame)
+{
+	for (int i = 0; i < GSM_COROUTINE_FRAME_COUNT; i++)
+	{
+		if (frame == _frames[i])
+		{
+			_isUsed[i] = false;
+			return;
+		}
+	}
+}
+
+uint8_t GsmCoroutinePool::FreeFrames()
+{
+	uint8_t count = 0;
+	for (int i = 0; i < GSM_COROUTINE_FRAME_COUNT; i++)
+	{
+		if (!_isUsed[i])
+		{
+			count++;
+		}
+	}
+	return count;
+}
+
+GsmScheduler::GsmScheduler():
+	_tasks{}
+{
+}
+
+bool GsmScheduler::Spawn(GsmTask task)
+{
+	auto handle = task.Release();
+	if (!handle)
+	{
+		return false;
+	}
+	for (int i = 0; i < GsmSchedulerTaskCount; i++)
+	{
+		if (!_tasks[i])
+		{
+			_tasks[i] = handle;
+			return true;
+		}
+	}
+	handle.destroy();
+	return false;
+}
+
+uint8_t GsmScheduler::Poll()
+{
+	uint8_t running = 0;
+	for (int i = 0; i < GsmSchedulerTaskCount; i++)
+	{
+		auto handle = _tasks[i];
+		if (!handle)
+		{
+			continue;
+		}
+		auto& promise = handle.promise();
+		if (promise.Awaiting == nullptr || promise.Awaiting->IsReady())
+		{
+			promise.Awaiting = nullptr;
+			handle.resume();
+		}
+		if (handle.done())
+		{
+			handle.destroy();
+			_tasks[i] = nullptr;
+			continue;
+		}
+		running++;
+	}
+	return running;
+}
+
+#endif
@@ -0,0 +1,358 @@
+#ifndef _GSM_COROUTINES_H
+#define _GSM_COROUTINES_H
+
+/*
+Coroutine API on top of non blocking SimcomAtCommands::Begin* methods and GsmAsyncSocket.
+Requires C++20 coroutines (-std=c++20), without them this header is empty.
+Coroutine frames come from a fixed pool, nothing is allocated on heap per operation.
+
+	GsmTask Report(SimcomAtCommands& at, GsmAsyncSocket& socket)
+	{
+		int16_t quality;
+		if (co_await AwaitSignalQuality(at, quality) != AtResultType::Success) co_return;
+		if (!co_await AwaitConnect(socket, "example.com", 80)) co_return;
+		...
+	}
+
+	scheduler.Spawn(Report(at, *socket));
+	void loop() { gsm.Loop(); scheduler.Poll(); }
+*/
+
+#if defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <Arduino.h>
+#include <FixedString.h>
+#include "SimcomAtCommands.h"
+#include "Network/GsmAsyncSocket.h"
+
+#ifndef GSM_COROUTINE_FRAME_SIZE
+#define GSM_COROUTINE_FRAME_SIZE 256
+#endif
+#ifndef GSM_COROUTINE_FRAME_COUNT
+#define GSM_COROUTINE_FRAME_COUNT 8
+#endif
+
+const int GsmSchedulerTaskCount = GSM_COROUTINE_FRAME_COUNT;
+
+class GsmCoroutinePool
+{
+	alignas(8) static uint8_t _frames[GSM_COROUTINE_FRAME_COUNT][GSM_COROUTINE_FRAME_SIZE];
+	static bool _isUsed[GSM_COROUTINE_FRAME_COUNT];
+public:
+	// nullptr when frame is too big or pool is exhausted
+	static void* Allocate(size_t size);
+	static void Free(void* frame);
+	static uint8_t FreeFrames();
+};
+
+// everything a suspended coroutine can wait on, polled by GsmScheduler
+class GsmAwaiter
+{
+public:
+	virtual bool IsReady() = 0;
+};
+
+class GsmTask
+{
+public:
+	struct promise_type
+	{
+		GsmAwaiter* Awaiting = nullptr;
+
+		static void* operator new(size_t size) noexcept
+		{
+			return GsmCoroutinePool::Allocate(size);
+		}
+		static void operator delete(void* frame)
+		{
+			GsmCoroutinePool::Free(frame);
+		}
+		static GsmTask get_return_object_on_allocation_failure()
+		{
+			return GsmTask(nullptr);
+		}
+		GsmTask get_return_object()
+		{
+			return GsmTask(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+		// started by GsmScheduler::Poll once task has a slot, dropped task never sends a command
+		std::suspend_always initial_suspend() noexcept
+		{
+			return {};
+		}
+		// frame is destroyed by scheduler
+		std::suspend_always final_suspend() noexcept
+		{
+			return {};
+		}
+		void return_void()
+		{
+		}
+		void unhandled_exception()
+		{
+		}
+	};
+	typedef std::coroutine_handle<promise_type> Handle;
+
+	explicit GsmTask(Handle handle):
+		_handle(handle)
+	{
+	}
+	GsmTask(GsmTask&& other) noexcept:
+		_handle(other._handle)
+	{
+		other._handle = nullptr;
+	}
+	GsmTask(const GsmTask&) = delete;
+	~GsmTask()
+	{
+		if (_handle)
+		{
+			_handle.destroy();
+		}
+	}
+	Handle Release()
+	{
+		auto handle = _handle;
+		_handle = nullptr;
+		return handle;
+	}
+private:
+	Handle _handle;
+};
+
+// base for awaiters, registers itself in promise so scheduler knows what to poll
+class GsmAwaitable : public GsmAwaiter
+{
+public:
+	bool await_ready()
+	{
+		return IsReady();
+	}
+	void await_suspend(GsmTask::Handle handle)
+	{
+		handle.promise().Awaiting = this;
+	}
+};
+
+template<typename TBegin>
+class AtCommandAwaiter : public GsmAwaitable
+{
+	SimcomAtCommands& _at;
+	TBegin _begin;
+	bool _isStarted;
+	bool _isDone;
+	AtResultType _result;
+public:
+	AtCommandAwaiter(SimcomAtCommands& at, TBegin begin):
+		_at(at),
+		_begin(begin),
+		_isStarted(false),
+		_isDone(false),
+		_result(AtResultType::Timeout)
+	{
+	}
+	// frame destroyed while command is pending, parser must not write into it
+	~AtCommandAwaiter()
+	{
+		if (_isStarted && !_isDone)
+		{
+			_at.CancelCommand();
+		}
+	}
+	bool IsReady() override
+	{
+		if (!_isStarted)
+		{
+			// another command may still be pending, retried on next poll
+			_isStarted = _begin();
+			return false;
+		}
+		_isDone = _at.PollCommand(_result);
+		return _isDone;
+	}
+	AtResultType await_resume()
+	{
+		return _result;
+	}
+};
+
+template<typename TBegin>
+AtCommandAwaiter<TBegin> MakeAtCommandAwaiter(SimcomAtCommands& at, TBegin begin)
+{
+	return AtCommandAwaiter<TBegin>(at, begin);
+}
+
+inline auto AwaitAt(SimcomAtCommands& at)
+{
+	return MakeAtCommandAwaiter(at, [&at]() { return at.BeginAt(); });
+}
+inline auto AwaitSignalQuality(SimcomAtCommands& at, int16_t& signalQuality)
+{
+	return MakeAtCommandAwaiter(at, [&at, &signalQuality]() { return at.BeginGetSignalQuality(signalQuality); });
+}
+inline auto AwaitBatteryStatus(SimcomAtCommands& at, BatteryStatus& batteryStatus)
+{
+	return MakeAtCommandAwaiter(at, [&at, &batteryStatus]() { return at.BeginGetBatteryStatus(batteryStatus); });
+}
+inline auto AwaitIpState(SimcomAtCommands& at, SimcomIpState& ipState)
+{
+	return MakeAtCommandAwaiter(at, [&at, &ipState]() { return at.BeginGetIpState(ipState); });
+}
+
+class DelayAwaiter : public GsmAwaitable
+{
+	unsigned long _start;
+	unsigned long _delay;
+public:
+	DelayAwaiter(unsigned long delayMs):
+		_start(millis()),
+		_delay(delayMs)
+	{
+	}
+	bool IsReady() override
+	{
+		return millis() - _start >= _delay;
+	}
+	void await_resume()
+	{
+	}
+};
+
+inline DelayAwaiter AwaitDelay(unsigned long delayMs)
+{
+	return DelayAwaiter(delayMs);
+}
+
+// CIPSTART is sent once no other command is pending, coroutine resumes once CONNECT OK/FAIL is received by GsmModule::Loop
+class ConnectAwaiter : public GsmAwaitable
+{
+	GsmAsyncSocket& _socket;
+	bool _isStarted;
+	const char* _host;
+	uint16_t _port;
+public:
+	ConnectAwaiter(GsmAsyncSocket& socket, const char* host, uint16_t port):
+		_socket(socket),
+		_isStarted(false),
+		_host(host),
+		_port(port)
+	{
+	}
+	bool IsReady() override
+	{
+		if (!_isStarted)
+		{
+			// blocking CIPSTART would wait for command of another coroutine, retried on next poll
+			if (_socket.At().IsCommandPending())
+			{
+				return false;
+			}
+			_isStarted = true;
+			if (!_socket.BeginConnect(_host, _port))
+			{
+				return true;
+			}
+		}
+		return _socket.GetState() != SocketStateType::Connecting;
+	}
+	bool await_resume()
+	{
+		return _socket.IsConnected();
+	}
+};
+
+inline ConnectAwaiter AwaitConnect(GsmAsyncSocket& socket, const char* host, uint16_t port)
+{
+	return ConnectAwaiter(socket, host, port);
+}
+
+/*
+Collects data received by socket so coroutine can read it, takes over socket's OnDataRecieved handler
+*/
+template<size_t Size>
+class SocketReceiveBuffer
+{
+public:
+	GsmAsyncSocket& Socket;
+private:
+	FixedString<Size> _data;
+	uint32_t _droppedBytes;
+public:
+	SocketReceiveBuffer(GsmAsyncSocket& socket):
+		Socket(socket),
+		_droppedBytes(0)
+	{
+		socket.OnDataRecieved(this, [](void* ctx, FixedStringBase& data)
+		{
+			auto buffer = reinterpret_cast<SocketReceiveBuffer*>(ctx);
+			if (data.length() > buffer->_data.freeBytes())
+			{
+				buffer->_droppedBytes += data.length() - buffer->_data.freeBytes();
+			}
+			buffer->_data.append(data.c_str(), data.length());
+		});
+	}
+	FixedStringBase& Data()
+	{
+		return _data;
+	}
+	uint32_t DroppedBytes()
+	{
+		return _droppedBytes;
+	}
+};
+
+// resumes when buffer has data or socket is closed, returns number of bytes moved to output
+template<size_t Size>
+class ReadAwaiter : public GsmAwaitable
+{
+	SocketReceiveBuffer<Size>& _buffer;
+	FixedStringBase& _output;
+public:
+	ReadAwaiter(SocketReceiveBuffer<Size>& buffer, FixedStringBase& output):
+		_buffer(buffer),
+		_output(output)
+	{
+	}
+	bool IsReady() override
+	{
+		return _buffer.Data().length() > 0 || !_buffer.Socket.IsConnected();
+	}
+	size_t await_resume()
+	{
+		auto& data = _buffer.Data();
+		const size_t length = data.length() < _output.freeBytes() ? data.length() : _output.freeBytes();
+		_output.append(data.c_str(), length);
+		FixedString<Size> rest;
+		rest.append(data.c_str() + length, data.length() - length);
+		data.clear();
+		data.append(rest.c_str(), rest.length());
+		return length;
+	}
+};
+
+template<size_t Size>
+ReadAwaiter<Size> AwaitRead(SocketReceiveBuffer<Size>& buffer, FixedStringBase& output)
+{
+	return ReadAwaiter<Size>(buffer, output);
+}
+
+/*
+Resumes suspended coroutines whose awaited operation is done. Single threaded, call Poll from loop()
+*/
+class GsmScheduler
+{
+	GsmTask::Handle _tasks[GsmSchedulerTaskCount];
+public:
+	GsmScheduler();
+	// false when task could not be allocated or scheduler is full
+	bool Spawn(GsmTask task);
+	// returns number of coroutines still running
+	uint8_t Poll();
+};
+
+#endif
+
+#endif
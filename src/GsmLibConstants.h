@@ -2,6 +2,38 @@
 #define _GSMLIBCONSTANTS_H
 
 const int AT_DEFAULT_TIMEOUT = 1500;
+// AT probe timeouts used by baud rate detection, quick pass first, then slow pass
+const int BAUD_RATE_PROBE_TIMEOUT = 20;
+const int BAUD_RATE_PROBE_TIMEOUT_SLOW = 100;
+// AT probe timeout used while waking modem from sleep and upper bound for whole wake up
+const int SLEEP_WAKE_PROBE_TIMEOUT = 20;
+const int SLEEP_WAKE_TIMEOUT = 2000;
+// shortest DTR high pulse modem reliably detects when wake up edge is repeated
+const int SLEEP_WAKE_DTR_PULSE = 20;
+// transparent mode: silence required before and after +++ and upper bound for CIPSTART to report CONNECT
+const int TRANSPARENT_ESCAPE_GUARD = 1000;
+const uint32_t TRANSPARENT_CONNECT_TIMEOUT = 75000;
+// socket waits this long for CONNECT OK before connect attempt is aborted, modem itself gives up only after 75s
+const uint32_t SOCKET_CONNECT_TIMEOUT = 30000;
+// longest host name accepted by BeginConnect, AT+CIPSTART and +CDNSGIP line with it must fit 256 byte buffers
+const uint8_t SOCKET_MAX_HOST_LENGTH = 200;
+// upper bound for +CDNSGIP result after OK and default lifetime of cached DNS entry
+const uint32_t DNS_RESOLVE_TIMEOUT = 20000;
+const uint32_t DNS_CACHE_TTL = 600000;
+// largest data length accepted by single AT+CIPSEND in multi connection mode
+const uint16_t CIPSEND_MAX_LENGTH = 1460;
+// datagrams waiting for CIPSEND per socket
+const uint8_t SOCKET_DATAGRAM_QUEUE_SIZE = 8;
+// AT+SAPBR=1 may take this long when PDP context has to be activated, HTTPACTION result waits at most HTTP_ACTION_TIMEOUT
+const uint32_t BEARER_OPEN_TIMEOUT = 85000;
+const uint32_t HTTP_ACTION_TIMEOUT = 120000;
+// upper bound for +FTPSIZE result after OK, FTP transfer waits this long for +FTPPUT/+FTPGET session URC
+const uint32_t FTP_SIZE_TIMEOUT = 30000;
+const uint32_t FTP_SESSION_TIMEOUT = 60000;
+// longest USSD text in GSM 7 bit alphabet
+const uint8_t USSD_MAX_LENGTH = 182;
+// outbound queue polls AT+CIPACK this often while sent data waits for acknowledgement
+const uint32_t OUTBOUND_QUEUE_ACK_INTERVAL = 2000;
 
 const uint64_t _defaultBaudRates[] =
 {
@@ -7,15 +7,29 @@
 GsmLogger::GsmLogger()
 {
 	_onLog = nullptr;
+	_categoryMask = 0xFF;
 }
 void GsmLogger::OnLog(GsmLogCallback onLog)
 {
 	_onLog = onLog;
 }
 
-void GsmLogger::Log(const __FlashStringHelper* format, ...)
+void GsmLogger::EnableCategory(GsmLogCategory category, bool enable)
+{
+	const uint8_t bit = 1 << static_cast<uint8_t>(category);
+	if (enable)
+	{
+		_categoryMask |= bit;
+	}
+	else
+	{
+		_categoryMask &= ~bit;
+	}
+}
+
+void GsmLogger::Write(const __FlashStringHelper* format, ...)
 {
-	if (!LogEnabled)
+	if (_onLog == nullptr)
 	{
 		return;
 	}
@@ -24,21 +38,18 @@ void GsmLogger::Log(const __FlashStringHelper* format, ...)
 
 	FixedString128 buffer;
 	buffer.appendFormatV(format, argptr);
-	if (_onLog != nullptr)
-	{
-		_onLog(buffer.c_str(), false);
-	}
+	_onLog(buffer.c_str(), false);
 
 	va_end(argptr);
 }
 
-void GsmLogger::LogAt(const __FlashStringHelper* format, ...)
+void GsmLogger::Log(const __FlashStringHelper* format, ...)
 {
-	if (!LogEnabled)
+	if (!IsEnabled(GsmLogLevel::Info, GsmLogCategory::General))
 	{
 		return;
 	}
-	if (!LogAtCommands)
+	if (_onLog == nullptr)
 	{
 		return;
 	}
@@ -47,10 +58,7 @@ void GsmLogger::LogAt(const __FlashStringHelper* format, ...)
 
 	FixedString128 buffer;
 	buffer.appendFormatV(format, argptr);
-	if (_onLog != nullptr)
-	{
-		_onLog(buffer.c_str(), false);
-	}
+	_onLog(buffer.c_str(), false);
 
 	va_end(argptr);
 }
@@ -61,4 +69,4 @@ void GsmLogger::Flush()
 	{
 		_onLog("", true);
 	}
-}
\ No newline at end of file
+}
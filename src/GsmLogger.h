@@ -3,19 +3,98 @@
 
 #include <pgmspace.h>
 #include <WString.h>
+#include <stdint.h>
 
 typedef void(*GsmLogCallback)(const char* logLine, bool flush);
 
+enum class GsmLogLevel : uint8_t
+{
+	Debug,
+	Info,
+	Warning,
+	Error,
+	None
+};
+
+enum class GsmLogCategory : uint8_t
+{
+	General,
+	At,
+	Socket,
+	State,
+	Parser
+};
+
+// Messages below this level are compiled out, e.g. -DGSM_LOG_MIN_LEVEL=2 keeps only warnings and errors
+#ifndef GSM_LOG_MIN_LEVEL
+#define GSM_LOG_MIN_LEVEL 0
+#endif
+
+constexpr GsmLogLevel GsmLogMinLevel = static_cast<GsmLogLevel>(GSM_LOG_MIN_LEVEL);
+
 class GsmLogger
 {
 	GsmLogCallback _onLog;
+	uint8_t _categoryMask;
+	void Write(const __FlashStringHelper* format, ...);
 public:
 	bool LogEnabled = true;
 	bool LogAtCommands = false;
-	GsmLogger();	 
+	GsmLogLevel Level = GsmLogLevel::Debug;
+	GsmLogger();
 	void OnLog(GsmLogCallback onLog);
+	void EnableCategory(GsmLogCategory category, bool enable);
+	bool IsCategoryEnabled(GsmLogCategory category)
+	{
+		return (_categoryMask & (1 << static_cast<uint8_t>(category))) != 0;
+	}
+	static constexpr bool IsCompiledIn(GsmLogLevel level)
+	{
+		return level >= GsmLogMinLevel;
+	}
+	bool IsEnabled(GsmLogLevel level, GsmLogCategory category)
+	{
+		return IsCompiledIn(level) && LogEnabled && level >= Level && IsCategoryEnabled(category);
+	}
+
+	template<typename... Args>
+	void Log(GsmLogLevel level, GsmLogCategory category, const __FlashStringHelper* format, Args... args)
+	{
+		if (IsEnabled(level, category))
+		{
+			Write(format, args...);
+		}
+	}
+	template<typename... Args>
+	void Debug(GsmLogCategory category, const __FlashStringHelper* format, Args... args)
+	{
+		Log(GsmLogLevel::Debug, category, format, args...);
+	}
+	template<typename... Args>
+	void Info(GsmLogCategory category, const __FlashStringHelper* format, Args... args)
+	{
+		Log(GsmLogLevel::Info, category, format, args...);
+	}
+	template<typename... Args>
+	void Warning(GsmLogCategory category, const __FlashStringHelper* format, Args... args)
+	{
+		Log(GsmLogLevel::Warning, category, format, args...);
+	}
+	template<typename... Args>
+	void Error(GsmLogCategory category, const __FlashStringHelper* format, Args... args)
+	{
+		Log(GsmLogLevel::Error, category, format, args...);
+	}
+	template<typename... Args>
+	void LogAt(const __FlashStringHelper* format, Args... args)
+	{
+		if (LogAtCommands)
+		{
+			Debug(GsmLogCategory::At, format, args...);
+		}
+	}
+
 	void Log(const __FlashStringHelper * format, ...);
-	void LogAt(const __FlashStringHelper* format, ...);
 	void Flush();
 };
 
@@ -6,19 +6,128 @@
 GsmModule::GsmModule(SimcomAtCommands &gsm):
 	_logger(gsm.Logger()),
 	_gsm(gsm), 
-	_socketManager(gsm, gsm.Logger()),
+	_socketManager(gsm, _timers, gsm.Logger()),
+	_transparentSocket(gsm, gsm.Logger()),
+	_dnsCache(gsm, gsm.Logger()),
 	_state(GsmState::Initial),
 	_isInSleepMode(false),
+	_onIncomingCall(nullptr),
+	_onIncomingCallCtx(nullptr),
+	_onUssdResponse(nullptr),
+	_onUssdResponseCtx(nullptr),
+	_isUssdResponsePending(false),
+	_ussdStatus(UssdStatus::NoResponse),
+	_isConfigVerified(false),
 	ApnName(""),
 	ApnUser(""),
 	ApnPassword(""),
 	BaudRate(115200ull)
 {
 	Serial.println("GsmModule::GsmModule");
+	_socketManager.SetDnsCache(&_dnsCache);
 	_gsm.OnGsmModuleEvent(this, [](void*ctx, GsmModuleEventType eventType) 
 	{
 		reinterpret_cast<GsmModule*>(ctx)->OnGsmModuleEvent(eventType);
 	});
+	_ringTimer.OnElapsed(this, [](void* ctx)
+	{
+		reinterpret_cast<GsmModule*>(ctx)->OnRingTimeout();
+	});
+	_gsm.OnUssdResponse(this, [](void* ctx, UssdStatus status, FixedStringBase& response)
+	{
+		reinterpret_cast<GsmModule*>(ctx)->OnUssdResponseInternal(status, response);
+	});
+	_ussdTimer.OnElapsed(this, [](void* ctx)
+	{
+		FixedString<1> response;
+		reinterpret_cast<GsmModule*>(ctx)->OnUssdResponseInternal(UssdStatus::NoResponse, response);
+	});
+}
+
+void GsmModule::DispatchIncomingCall()
+{
+	FixedString32 callerNumber;
+	if (!_gsm.PopIncomingCall(callerNumber))
+	{
+		return;
+	}
+	_timers.Start(_ringTimer, RingTimeout);
+	const auto isNewCall = !callInfo.HasIncomingCall;
+	const auto isNumberChanged = callerNumber.length() > 0 && !callerNumber.equals(callInfo.CallerNumber);
+	if (!isNewCall && !isNumberChanged)
+	{
+		return;
+	}
+	callInfo.HasIncomingCall = true;
+	if (isNumberChanged)
+	{
+		callInfo.CallerNumber = callerNumber;
+	}
+	_logger.Info(GsmLogCategory::General, F("Incoming call from '%s'"), callInfo.CallerNumber.c_str());
+	if (_onIncomingCall != nullptr)
+	{
+		_onIncomingCall(_onIncomingCallCtx, callInfo);
+	}
+}
+
+void GsmModule::OnRingTimeout()
+{
+	if (!callInfo.HasIncomingCall)
+	{
+		return;
+	}
+	_logger.Info(GsmLogCategory::General, F("Incoming call from '%s' ended"), callInfo.CallerNumber.c_str());
+	callInfo.HasIncomingCall = false;
+	callInfo.CallerNumber.clear();
+	if (_onIncomingCall != nullptr)
+	{
+		_onIncomingCall(_onIncomingCallCtx, callInfo);
+	}
+}
+
+AtResultType GsmModule::SendUssd(const char* ussd)
+{
+	const auto result = _gsm.SendUssd(ussd);
+	if (result == AtResultType::Success)
+	{
+		_timers.Start(_ussdTimer, UssdTimeout);
+	}
+	return result;
+}
+
+void GsmModule::OnUssdResponseInternal(UssdStatus status, FixedStringBase& response)
+{
+	_timers.Stop(_ussdTimer);
+	_isUssdResponsePending = true;
+	_ussdStatus = status;
+	_ussdResponse.clear();
+	_ussdResponse.append(response.c_str(), response.length());
+}
+
+void GsmModule::DispatchUssdResponse()
+{
+	if (!_isUssdResponsePending)
+	{
+		return;
+	}
+	_isUssdResponsePending = false;
+	_logger.Info(GsmLogCategory::General, F("USSD response %d: '%s'"), static_cast<int>(_ussdStatus), _ussdResponse.c_str());
+	if (_onUssdResponse != nullptr)
+	{
+		_onUssdResponse(_onUssdResponseCtx, _ussdStatus, _ussdResponse);
+	}
+}
+
+void GsmModule::OnUssdResponse(void* ctx, UssdResponseHandler onUssdResponse)
+{
+	_onUssdResponseCtx = ctx;
+	_onUssdResponse = onUssdResponse;
+}
+
+void GsmModule::OnIncomingCall(void* ctx, GsmIncomingCallHandler onIncomingCall)
+{
+	_onIncomingCallCtx = ctx;
+	_onIncomingCall = onIncomingCall;
 }
 void GsmModule::OnGsmModuleEvent(GsmModuleEventType eventType)
 {
@@ -41,8 +150,8 @@ bool GsmModule::ReadModemProperties(bool force)
 {
 	if (!force)
 	{
-		static IntervalTimer getVariablesTimer(GetPropertiesInterval);
-		if (!getVariablesTimer.IsElapsed())
+		EnsureTimerStarted(_getPropertiesTimer, GetPropertiesInterval);
+		if (!_getPropertiesTimer.IsElapsed())
 		{
 			return true;
 		}
@@ -68,10 +177,6 @@ bool GsmModule::ReadModemProperties(bool force)
 			return false;
 		}
 	}
-	if (_gsm.GetIncomingCall(callInfo) == AtResultType::Timeout)
-	{
-		return false;
-	}
 	if (_state == GsmState::ConnectedToGprs)
 	{
 		if (_gsm.GetIpState(ipStatus) == AtResultType::Timeout)
@@ -97,11 +202,11 @@ bool GsmModule::RequestSleepIfEnabled()
 	if (_gsm.EnterSleepMode() == AtResultType::Success)
 	{
 		_isInSleepMode = true;
-		_logger.Log(F("Successfully entered sleep mode"));
+		_logger.Debug(GsmLogCategory::State, F("Successfully entered sleep mode"));
 		return true;
 	}
 	
-	_logger.Log(F("   Failed to enter sleep mode"));	
+	_logger.Warning(GsmLogCategory::State, F("   Failed to enter sleep mode"));	
 	return false;
 }
 
@@ -117,11 +222,67 @@ bool GsmModule::ExitSleepIfEnabled()
 		_isInSleepMode = false;
 		return true;
 	}
-	_logger.Log(F("   Failed to exit sleep mode"));
+	_logger.Warning(GsmLogCategory::State, F("   Failed to exit sleep mode"));
 	return false;
 	
 }
 
+void GsmModule::VerifyAppliedConfig()
+{
+	_isConfigVerified = false;
+	if (!_appliedConfig.IsValid)
+	{
+		return;
+	}
+	ModemConfiguration modemConfig;
+	if (_gsm.GetModemConfiguration(modemConfig) != AtResultType::Success)
+	{
+		return;
+	}
+	_isConfigVerified = modemConfig.Matches(_appliedConfig);
+	_logger.Info(GsmLogCategory::State, F("Modem configuration %s"), _isConfigVerified ? "unchanged" : "changed");
+}
+
+void GsmModule::SnapshotAppliedConfig()
+{
+	_appliedConfig.Cipmux = !TransparentMode;
+	_appliedConfig.CipQSend = true;
+	_appliedConfig.IsRxManual = !TransparentMode;
+	_appliedConfig.IsTransparent = TransparentMode;
+	_appliedConfig.CregMode = 2;
+	_appliedConfig.IsValid = true;
+	_isConfigVerified = true;
+	if (SaveModemProfile)
+	{
+		_gsm.SaveProfile();
+	}
+}
+
+/*
+Returns ms until GsmModule needs to talk to modem again, 
+modem activity (URCs, incoming data) can still wake CPU earlier
+*/
+uint64_t GsmModule::GetTimeToNextWork()
+{
+	if (_socketManager.HasPendingWork())
+	{
+		return _timers.TimeUntil(_loopTimer);
+	}
+	// loop tick has nothing to do without socket work, it is restarted by next Loop call
+	_timers.Stop(_loopTimer);
+	// connect deadlines and reconnect backoff of sockets are on the wheel as well
+	return _timers.TimeToNextDeadline();
+}
+
+void GsmModule::EnsureTimerStarted(GsmTimer& timer, uint32_t period)
+{
+	timer.SetPeriod(period);
+	if (!timer.IsScheduled())
+	{
+		_timers.Start(timer, 0, period);
+	}
+}
+
 bool GsmModule::UpdateRegistrationMode()
 {
 	if (OperatorSelectionMode == RegistrationMode::Automatic)
@@ -147,21 +308,39 @@ void GsmModule::Loop()
 	{
 		return;
 	}
-	static IntervalTimer loopIntervalTimer(TickInterval);
-	loopIntervalTimer.SetDelay(TickInterval);
-	if (!loopIntervalTimer.IsElapsed())
+	if (!_gsm.ExpirePendingCommand())
+	{
+		// non blocking command owns the parser until PollCommand completes it or it times out
+		return;
+	}
+	_timers.Advance();
+	if (_transparentSocket.IsBusy())
 	{
-		if (_state == GsmState::ConnectedToGprs)
+		// UART carries socket data, AT commands would be sent to remote host
+		_transparentSocket.Poll();
+		return;
+	}
+	EnsureTimerStarted(_loopTimer, TickInterval);
+	if (!_loopTimer.IsElapsed())
+	{
+		if (_state == GsmState::ConnectedToGprs && SleepEnabled)
 		{
-			if (SleepEnabled)
+			const auto sleepTime = GetTimeToNextWork();
+			if (sleepTime >= MinCpuSleepTime)
 			{
 				RequestSleepIfEnabled();
-				_gsm.CpuSleep(TickInterval);			
+				_gsm.CpuSleep(sleepTime);
+				// woken up either by deadline or by modem activity, handle it on next tick
+				_timers.Start(_loopTimer, 0, TickInterval);
 			}
 		}
 		return;
 	}
-	
+	// URCs like RING arrive between commands, parse them before properties are polled
+	_gsm.wait(0);
+	DispatchIncomingCall();
+	DispatchUssdResponse();
+
 	if (!ExitSleepIfEnabled())
 	{
 		_error = "Exit sleep failed";
@@ -187,16 +366,23 @@ void GsmModule::Loop()
 		_gsm.SetDtr(false);
 		if (!_gsm.EnsureModemConnected(BaudRate))
 		{
-			delay(500);
+			delay(NoShieldRetryDelay);
 			return;
 		}
 		ReadModemProperties(true);
+		VerifyAppliedConfig();
 		ChangeState(GsmState::Initializing);
 		return;
 	}
 
 	if (_state == GsmState::Initializing)
 	{
+		if (_isConfigVerified)
+		{
+			// modem kept settings from previous session, no need for flight mode reset
+			ChangeState(GsmState::SearchingForNetwork);
+			return;
+		}
 		bool cipmux;
 		if (_gsm.GetCipmux(cipmux) == AtResultType::Timeout)
 		{
@@ -224,6 +410,7 @@ void GsmModule::Loop()
 			return;
 		}
 		_gsm.SetCregMode(2);
+		_gsm.SetCallerIdNotification(true);
 		//_gsm.Cipshut();
 		ChangeState(GsmState::SearchingForNetwork);
 		return;
@@ -281,43 +468,63 @@ void GsmModule::Loop()
 
 	if (_state == GsmState::ConnectingToGprs)
 	{
-		_logger.Log(F("Connecting to GPRS"));
-		_logger.Log(F("Executing CIPSHUT"));
-		_gsm.Cipshut();
-
-		_logger.Log(F("Executing CIPQSEND"));
-		if (_gsm.SetSipQuickSend(true) == AtResultType::Timeout)
+		_logger.Info(GsmLogCategory::State, F("Connecting to GPRS"));
+		if (_isConfigVerified)
 		{
-			ChangeState(GsmState::NoShield);
-			return;
+			// PDP context may have survived serial glitch, reuse it if modem still has ip address
+			if (_gsm.GetIpAddress(ipAddress) == AtResultType::Success)
+			{
+				_logger.Info(GsmLogCategory::State, F("Reusing GPRS connection"));
+				ChangeState(GsmState::ConnectedToGprs);
+				return;
+			}
 		}
+		_logger.Debug(GsmLogCategory::State, F("Executing CIPSHUT"));
+		_gsm.Cipshut();
 
-		bool cipQsend;
-		if (_gsm.GetCipQuickSend(cipQsend) == AtResultType::Timeout)
-		{
-			ChangeState(GsmState::NoShield);
-			return;
-		}
-		_logger.Log(F("Executing CIPMUX=1"));
-		if (_gsm.SetCipmux(true) == AtResultType::Timeout)
-		{
-			ChangeState(GsmState::NoShield);
-			return;
-		}
-		_logger.Log(F("Executing CIPRXGET=1"));
-		if (_gsm.SetRxMode(true) == AtResultType::Timeout)
+		if (!_isConfigVerified)
 		{
-			ChangeState(GsmState::NoShield);
-			return;
+			_logger.Debug(GsmLogCategory::State, F("Executing CIPQSEND"));
+			if (_gsm.SetSipQuickSend(true) == AtResultType::Timeout)
+			{
+				ChangeState(GsmState::NoShield);
+				return;
+			}
+
+			bool cipQsend;
+			if (_gsm.GetCipQuickSend(cipQsend) == AtResultType::Timeout)
+			{
+				ChangeState(GsmState::NoShield);
+				return;
+			}
+			_logger.Debug(GsmLogCategory::State, F("Executing CIPMUX=%d"), TransparentMode ? 0 : 1);
+			if (_gsm.SetCipmux(!TransparentMode) == AtResultType::Timeout)
+			{
+				ChangeState(GsmState::NoShield);
+				return;
+			}
+			_logger.Debug(GsmLogCategory::State, F("Executing CIPMODE=%d"), TransparentMode ? 1 : 0);
+			if (_gsm.SetTransparentMode(TransparentMode) == AtResultType::Timeout)
+			{
+				ChangeState(GsmState::NoShield);
+				return;
+			}
+			// manual receive only works in non transparent mode
+			_logger.Debug(GsmLogCategory::State, F("Executing CIPRXGET=%d"), TransparentMode ? 0 : 1);
+			if (_gsm.SetRxMode(!TransparentMode) == AtResultType::Timeout)
+			{
+				ChangeState(GsmState::NoShield);
+				return;
+			}
 		}
-		_logger.Log(F("Executing CSTT"));
+		_logger.Debug(GsmLogCategory::State, F("Executing CSTT"));
 		auto apnResult = _gsm.SetApn(ApnName, ApnUser, ApnPassword);
 		if (apnResult == AtResultType::Timeout)
 		{
 			ChangeState(GsmState::NoShield);
 			return;
 		}
-		_logger.Log(F("Executing CIICR"));
+		_logger.Debug(GsmLogCategory::State, F("Executing CIICR"));
 		auto attachResult = _gsm.AttachGprs();
 		if (attachResult == AtResultType::Timeout)
 		{
@@ -328,7 +535,7 @@ void GsmModule::Loop()
 		{
 			return;
 		}
-		_logger.Log(F("Executing CIFSR"));
+		_logger.Debug(GsmLogCategory::State, F("Executing CIFSR"));
 		auto ipAddressResult = _gsm.GetIpAddress(ipAddress);
 		if (ipAddressResult == AtResultType::Timeout)
 		{
@@ -339,6 +546,7 @@ void GsmModule::Loop()
 		{
 			return;
 		}
+		SnapshotAppliedConfig();
 		ChangeState(GsmState::ConnectedToGprs);
 		return;
 	}
@@ -351,26 +559,33 @@ void GsmModule::Loop()
 		}
 		if (_socketManager.AnyConnectAtTimeouted())
 		{
-			_logger.Log(F("At timeout on connect detected"));
+			_logger.Warning(GsmLogCategory::Socket, F("At timeout on connect detected"));
 			ChangeState(GsmState::NoShield);
 			return;
 		}
+		if (!_socketManager.CheckConnectDeadlines())
+		{
+			_logger.Warning(GsmLogCategory::Socket, F("Timeout while closing socket after connect timeout"));
+			ChangeState(GsmState::NoShield);
+			return;
+		}
+		_socketManager.ProcessReconnects();
 		if (!_socketManager.SendDataFromSockets())
 		{
-			_logger.Log(F("Timeout while trying to send data from socket"));
+			_logger.Warning(GsmLogCategory::Socket, F("Timeout while trying to send data from socket"));
 			ChangeState(GsmState::NoShield);
 			return;
 		}
 
 		if (!_socketManager.ReadDataFromSockets())
 		{
-			_logger.Log(F("Timeout while trying to read data from socket"));
+			_logger.Warning(GsmLogCategory::Socket, F("Timeout while trying to read data from socket"));
 			ChangeState(GsmState::NoShield);
 			return;
 		}
 	}
-	static IntervalTimer simStatusTimer(SimStatusInterval);
-	if (simStatusTimer.IsElapsed())
+	EnsureTimerStarted(_simStatusTimer, SimStatusInterval);
+	if (_simStatusTimer.IsElapsed())
 	{
 		if (_gsm.GetSimStatus(simStatus) == AtResultType::Success)
 		{
@@ -445,6 +660,26 @@ const __FlashStringHelper* GsmModule::StateToStr(GsmState state)
 	default: return F("Unknown");
 	}
 }
+AtResultType GsmModule::OpenBearer()
+{
+	BearerStatus status;
+	GsmIp bearerIp;
+	auto result = _gsm.GetBearerStatus(status, bearerIp);
+	if (result != AtResultType::Success || status == BearerStatus::Connected)
+	{
+		return result;
+	}
+	if ((result = _gsm.SetBearerParameter("CONTYPE", "GPRS")) != AtResultType::Success ||
+		(result = _gsm.SetBearerParameter("APN", ApnName)) != AtResultType::Success ||
+		(result = _gsm.SetBearerParameter("USER", ApnUser)) != AtResultType::Success ||
+		(result = _gsm.SetBearerParameter("PWD", ApnPassword)) != AtResultType::Success)
+	{
+		return result;
+	}
+	_logger.Info(GsmLogCategory::General, F("Opening bearer, APN: '%s'"), ApnName);
+	return _gsm.OpenBearer();
+}
+
 void GsmModule::OnLog(GsmLogCallback onLog)
 {
 	_gsm.Logger().OnLog(onLog);
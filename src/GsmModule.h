@@ -5,10 +5,17 @@
 #include <WString.h>
 #include "Network/GsmAsyncSocket.h"
 #include "Network/SocketManager.h"
+#include "Network/GsmTransparentSocket.h"
+#include "Network/GsmDnsCache.h"
 #include "GsmLogger.h"
 #include "SimcomGsmTypes.h"
+#include "GsmLibHelpers.h"
+#include "TimerWheel.h"
 #include <vector>
 
+// called when call starts ringing, when caller number becomes known and when ringing stops
+typedef void(*GsmIncomingCallHandler)(void* ctx, IncomingCallInfo& callInfo);
+
 enum class GsmState :uint8_t
 {
 	Initial,
@@ -29,10 +36,35 @@ class GsmModule
 	GsmLogger& _logger;
 	SimcomAtCommands& _gsm;	
 	SocketManager _socketManager;
+	GsmTransparentSocket _transparentSocket;
+	GsmDnsCache _dnsCache;
 	GsmState _state;
 
 	FixedString128 _error;
 	bool _isInSleepMode;
+	TimerWheel _timers;
+	GsmTimer _loopTimer;
+	GsmTimer _getPropertiesTimer;
+	GsmTimer _simStatusTimer;
+	// restarted by every RING, call is over when it expires
+	GsmTimer _ringTimer;
+	GsmIncomingCallHandler _onIncomingCall;
+	void* _onIncomingCallCtx;
+	// called from Loop so handler may send AT commands
+	void DispatchIncomingCall();
+	void OnRingTimeout();
+	// running while USSD request waits for +CUSD:
+	GsmTimer _ussdTimer;
+	UssdResponseHandler _onUssdResponse;
+	void* _onUssdResponseCtx;
+	// reply arrives inside whatever command parser is running, it is kept here until Loop dispatches it
+	bool _isUssdResponsePending;
+	UssdStatus _ussdStatus;
+	FixedString<USSD_MAX_LENGTH> _ussdResponse;
+	void OnUssdResponseInternal(UssdStatus status, FixedStringBase& response);
+	void DispatchUssdResponse();
+	// interval fields are public and may change at any time, period is refreshed before each check
+	void EnsureTimerStarted(GsmTimer& timer, uint32_t period);
 	void GetStateStringFromProg(char* stateStr, GsmState state)
 	{
 		strcpy_P(stateStr, (PGM_P)StateToStr(state));
@@ -49,10 +81,11 @@ class GsmModule
 			char outState[20];
 			GetStateStringFromProg(inState, _state);
 			GetStateStringFromProg(outState, newState);
-			_logger.Log(F("State changed %s -> %s"), inState, outState);
+			_logger.Info(GsmLogCategory::State, F("State changed %s -> %s"), inState, outState);
 				
 			_state = newState;
 			_socketManager.SetIsNetworkAvailable(_state == GsmState::ConnectedToGprs);
+			_transparentSocket.SetIsNetworkAvailable(_state == GsmState::ConnectedToGprs);
 			_lastStateChange = millis();
 		}
 		if (_state == GsmState::NoShield)
@@ -63,17 +96,34 @@ class GsmModule
 	bool ReadModemProperties(bool force = false);
 	bool RequestSleepIfEnabled();
 	bool ExitSleepIfEnabled();
+	uint64_t GetTimeToNextWork();
 	uint64_t _lastStateChange = 0;
 	bool UpdateRegistrationMode();
+	// configuration applied to modem by last successful initialization
+	ModemConfiguration _appliedConfig;
+	bool _isConfigVerified;
+	void VerifyAppliedConfig();
+	void SnapshotAppliedConfig();
 public:
 	GsmModule(SimcomAtCommands &gsm);
 	bool GarbageDetectedDEBUG = false;
 	
 	bool SleepEnabled = false;
 	uint16_t TickInterval = 100;
+	uint16_t NoShieldRetryDelay = 100;
+	// store modem settings with AT&W after successful GPRS connection
+	bool SaveModemProfile = false;
+	// single connection in transparent mode (CIPMODE=1) instead of multiplexed sockets, set before first Loop
+	bool TransparentMode = false;
 	uint16_t SimStatusInterval = 1000;
 	uint16_t GetPropertiesInterval = 1000;
 	uint16_t GetTemperatureInterval = 5000;
+	// SIM900 repeats RING every 5 s, incoming call is reported as ended when next one does not come in time
+	uint16_t RingTimeout = 7000;
+	// network usually answers USSD within few seconds, handler gets NoResponse after that
+	uint32_t UssdTimeout = 30000;
+	// CPU is not put to sleep when next scheduled work is closer than that
+	uint16_t MinCpuSleepTime = 10;
 	const char *ApnName;
 	const char* ApnUser;
 	const char* ApnPassword;
@@ -87,6 +137,11 @@ public:
 	{
 		return _gsm;
 	}
+	// timers started here are advanced by Loop() and taken into account when choosing CPU sleep time
+	TimerWheel& Timers()
+	{
+		return _timers;
+	}
 	void OnGsmModuleEvent(GsmModuleEventType eventType);
 
 	FixedStringBase& Error()
@@ -96,8 +151,25 @@ public:
 
 	GsmAsyncSocket* CreateSocket(uint8_t mux, ProtocolType protocolType)
 	{
+		if (TransparentMode)
+		{
+			return nullptr;
+		}
 		return _socketManager.CreateSocket(mux, protocolType);
 	}
+	// disabled by default, set DnsCache().Enabled to connect sockets by cached address
+	GsmDnsCache& DnsCache()
+	{
+		return _dnsCache;
+	}
+	ConnectStats GetConnectStats()
+	{
+		return _socketManager.GetConnectStats();
+	}
+	GsmTransparentSocket* GetTransparentSocket()
+	{
+		return TransparentMode ? &_transparentSocket : nullptr;
+	}
 	GsmState GetState()
 	{
 		return _state;
@@ -119,6 +191,18 @@ public:
 	uint16_t Lac = 0;
 	uint16_t CellId = 0;
 	void OnLog(GsmLogCallback onLog);
+	// callInfo is updated from RING/+CLIP URCs and handler is called from Loop on first tick after they arrive
+	void OnIncomingCall(void* ctx, GsmIncomingCallHandler onIncomingCall);
+	// e.g. "*100#" balance check, returns once modem accepted request and sockets keep working meanwhile.
+	// Reply or NoResponse after UssdTimeout is passed to OnUssdResponse handler from Loop, handler may send AT commands
+	AtResultType SendUssd(const char* ussd);
+	bool IsUssdPending()
+	{
+		return _ussdTimer.IsScheduled();
+	}
+	void OnUssdResponse(void* ctx, UssdResponseHandler onUssdResponse);
+	// opens bearer profile 1 used by modem HTTP stack with module APN, does nothing when already open
+	AtResultType OpenBearer();
 	void Loop();
 	void Wait(uint64_t delayInMs)
 	{
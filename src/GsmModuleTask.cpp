@@ -0,0 +1,309 @@
+#include "GsmModuleTask.h"
+
+#if defined(ESP32) || defined(__linux__) || defined(__APPLE__)
+
+GsmModuleTask::GsmModuleTask(GsmModule& module):
+	_module(module),
+	_isRunning(false),
+	_state(GsmState::Initial),
+	_droppedSendBytes(0),
+#ifdef ESP32
+	_taskHandle(nullptr),
+#endif
+	_onStateChangedCtx(nullptr),
+	_onStateChanged(nullptr),
+	_onSocketEventCtx(nullptr),
+	_onSocketEvent(nullptr),
+	_onDataReceivedCtx(nullptr),
+	_onDataReceived(nullptr)
+{
+	for (uint8_t mux = 0; mux < SocketCount; mux++)
+	{
+		_slots[mux].Task = this;
+		_slots[mux].Mux = mux;
+		_slots[mux].Socket = nullptr;
+	}
+}
+
+GsmModuleTask::~GsmModuleTask()
+{
+	Stop();
+}
+
+bool GsmModuleTask::Start(uint32_t stackSize, uint8_t priority, int core)
+{
+	if (_isRunning)
+	{
+		return false;
+	}
+	// CPU sleep would stop application task too
+	_module.SleepEnabled = false;
+	_isRunning = true;
+#ifdef ESP32
+	if (xTaskCreatePinnedToCore(TaskMain, "gsm", stackSize, this, priority, &_taskHandle, core) != pdPASS)
+	{
+		_isRunning = false;
+		return false;
+	}
+#else
+	(void)stackSize;
+	(void)priority;
+	(void)core;
+	_thread = std::thread(TaskMain, this);
+#endif
+	return true;
+}
+
+void GsmModuleTask::Stop()
+{
+	if (!_isRunning)
+	{
+		return;
+	}
+	_isRunning = false;
+#ifdef ESP32
+	while (_taskHandle != nullptr)
+	{
+		vTaskDelay(1);
+	}
+#else
+	if (_thread.joinable())
+	{
+		_thread.join();
+	}
+#endif
+}
+
+void GsmModuleTask::TaskMain(void* ctx)
+{
+	auto task = reinterpret_cast<GsmModuleTask*>(ctx);
+	task->Run();
+#ifdef ESP32
+	task->_taskHandle = nullptr;
+	vTaskDelete(nullptr);
+#endif
+}
+
+void GsmModuleTask::Yield()
+{
+#ifdef ESP32
+	vTaskDelay(1);
+#else
+	std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+}
+
+void GsmModuleTask::Run()
+{
+	while (_isRunning)
+	{
+		GsmTaskCommand* command;
+		while ((command = _commands.Front()) != nullptr)
+		{
+			if (!ExecuteCommand(*command))
+			{
+				// socket send buffer is full, retry after module loop flushed it
+				break;
+			}
+			_commands.Pop();
+		}
+
+		_module.Loop();
+
+		const auto state = _module.GetState();
+		if (state != _state)
+		{
+			_state = state;
+			GsmTaskEvent event;
+			event.Type = GsmTaskEventType::StateChanged;
+			event.State = state;
+			PushEvent(event);
+		}
+		Yield();
+	}
+}
+
+bool GsmModuleTask::ExecuteCommand(GsmTaskCommand& command)
+{
+	auto& slot = _slots[command.Mux];
+	if (command.Type == GsmTaskCommandType::Connect)
+	{
+		if (slot.Socket == nullptr)
+		{
+			slot.Socket = _module.CreateSocket(command.Mux, command.Protocol);
+			if (slot.Socket == nullptr)
+			{
+				OnSocketEvent(command.Mux, SocketEventType::ConnectFailed);
+				return true;
+			}
+			slot.Socket->OnSocketEvent(&slot, [](void* ctx, SocketEventType eventType)
+			{
+				auto slot = reinterpret_cast<SocketSlot*>(ctx);
+				slot->Task->OnSocketEvent(slot->Mux, eventType);
+			});
+			slot.Socket->OnDataRecieved(&slot, [](void* ctx, FixedStringBase& data)
+			{
+				auto slot = reinterpret_cast<SocketSlot*>(ctx);
+				slot->Task->OnDataReceived(slot->Mux, data);
+			});
+		}
+		slot.Socket->BeginConnect(command.Data, command.Port);
+		return true;
+	}
+	if (slot.Socket == nullptr)
+	{
+		if (command.Type == GsmTaskCommandType::Send)
+		{
+			_droppedSendBytes += command.Length;
+		}
+		return true;
+	}
+	if (command.Type == GsmTaskCommandType::Send)
+	{
+		if (slot.Socket->space() < command.Length)
+		{
+			return false;
+		}
+		slot.Socket->Send(command.Data, command.Length);
+		return true;
+	}
+	slot.Socket->Close();
+	return true;
+}
+
+void GsmModuleTask::PushEvent(const GsmTaskEvent& event)
+{
+	// application is slow, hold modem task rather than lose received data
+	while (!_events.Push(event) && _isRunning)
+	{
+		Yield();
+	}
+}
+
+void GsmModuleTask::OnSocketEvent(uint8_t mux, SocketEventType eventType)
+{
+	GsmTaskEvent event;
+	event.Type = GsmTaskEventType::SocketEvent;
+	event.Mux = mux;
+	event.SocketEvent = eventType;
+	PushEvent(event);
+}
+
+void GsmModuleTask::OnDataReceived(uint8_t mux, FixedStringBase& data)
+{
+	GsmTaskEvent event;
+	event.Type = GsmTaskEventType::DataReceived;
+	event.Mux = mux;
+	for (size_t offset = 0; offset < data.length(); offset += event.Length)
+	{
+		event.Length = data.length() - offset > GsmTaskChunkSize ? GsmTaskChunkSize : data.length() - offset;
+		memcpy(event.Data, data.c_str() + offset, event.Length);
+		PushEvent(event);
+	}
+}
+
+void GsmModuleTask::OnStateChanged(void* ctx, GsmTaskStateHandler handler)
+{
+	_onStateChanged = handler;
+	_onStateChangedCtx = ctx;
+}
+
+void GsmModuleTask::OnSocketEvent(void* ctx, GsmTaskSocketEventHandler handler)
+{
+	_onSocketEvent = handler;
+	_onSocketEventCtx = ctx;
+}
+
+void GsmModuleTask::OnDataReceived(void* ctx, GsmTaskDataHandler handler)
+{
+	_onDataReceived = handler;
+	_onDataReceivedCtx = ctx;
+}
+
+bool GsmModuleTask::Connect(uint8_t mux, ProtocolType protocol, const char* host, uint16_t port)
+{
+	const auto hostLength = strlen(host);
+	if (mux >= SocketCount || hostLength >= GsmTaskChunkSize)
+	{
+		return false;
+	}
+	GsmTaskCommand command;
+	command.Type = GsmTaskCommandType::Connect;
+	command.Mux = mux;
+	command.Protocol = protocol;
+	command.Port = port;
+	command.Length = hostLength;
+	memcpy(command.Data, host, hostLength + 1);
+	return _commands.Push(command);
+}
+
+uint16_t GsmModuleTask::Send(uint8_t mux, const char* data, uint16_t length)
+{
+	if (mux >= SocketCount)
+	{
+		return 0;
+	}
+	GsmTaskCommand command;
+	command.Type = GsmTaskCommandType::Send;
+	command.Mux = mux;
+	uint16_t queued = 0;
+	while (queued < length)
+	{
+		command.Length = length - queued > GsmTaskChunkSize ? GsmTaskChunkSize : length - queued;
+		memcpy(command.Data, data + queued, command.Length);
+		if (!_commands.Push(command))
+		{
+			break;
+		}
+		queued += command.Length;
+	}
+	return queued;
+}
+
+bool GsmModuleTask::Close(uint8_t mux)
+{
+	if (mux >= SocketCount)
+	{
+		return false;
+	}
+	GsmTaskCommand command;
+	command.Type = GsmTaskCommandType::Close;
+	command.Mux = mux;
+	command.Length = 0;
+	return _commands.Push(command);
+}
+
+uint8_t GsmModuleTask::ProcessEvents()
+{
+	uint8_t count = 0;
+	GsmTaskEvent* event;
+	while ((event = _events.Front()) != nullptr)
+	{
+		switch (event->Type)
+		{
+		case GsmTaskEventType::StateChanged:
+			if (_onStateChanged != nullptr)
+			{
+				_onStateChanged(_onStateChangedCtx, event->State);
+			}
+			break;
+		case GsmTaskEventType::SocketEvent:
+			if (_onSocketEvent != nullptr)
+			{
+				_onSocketEvent(_onSocketEventCtx, event->Mux, event->SocketEvent);
+			}
+			break;
+		case GsmTaskEventType::DataReceived:
+			if (_onDataReceived != nullptr)
+			{
+				_onDataReceived(_onDataReceivedCtx, event->Mux, event->Data, event->Length);
+			}
+			break;
+		}
+		_events.Pop();
+		count++;
+	}
+	return count;
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef _GSM_MODULE_TASK_H
+#define _GSM_MODULE_TASK_H
+
+// needs FreeRTOS tasks or host std::thread, other boards use GsmModule::Loop directly
+#if defined(ESP32) || defined(__linux__) || defined(__APPLE__)
+
+#include <atomic>
+#include "GsmModule.h"
+#include "SpscQueue.h"
+
+#ifdef ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <thread>
+#endif
+
+const uint16_t GsmTaskChunkSize = 128;
+const size_t GsmTaskQueueLength = 16;
+
+enum class GsmTaskCommandType : uint8_t
+{
+	Connect,
+	Send,
+	Close
+};
+
+struct GsmTaskCommand
+{
+	GsmTaskCommandType Type;
+	uint8_t Mux;
+	ProtocolType Protocol;
+	uint16_t Port;
+	uint16_t Length;
+	// host name for Connect, payload for Send
+	char Data[GsmTaskChunkSize];
+};
+
+enum class GsmTaskEventType : uint8_t
+{
+	StateChanged,
+	SocketEvent,
+	DataReceived
+};
+
+struct GsmTaskEvent
+{
+	GsmTaskEventType Type;
+	uint8_t Mux;
+	GsmState State;
+	SocketEventType SocketEvent;
+	uint16_t Length;
+	char Data[GsmTaskChunkSize];
+};
+
+typedef void(*GsmTaskStateHandler)(void* ctx, GsmState state);
+typedef void(*GsmTaskSocketEventHandler)(void* ctx, uint8_t mux, SocketEventType eventType);
+typedef void(*GsmTaskDataHandler)(void* ctx, uint8_t mux, const char* data, uint16_t length);
+
+/*
+Runs GsmModule::Loop in its own task (FreeRTOS on ESP32, std::thread elsewhere).
+Application talks to it only through two lock free queues so it never waits on serial:
+Connect/Send/Close are queued for the modem task, ProcessEvents delivers state changes,
+socket events and received data on application thread.
+Modem task stops reading sockets when event queue is full until application drains it.
+*/
+class GsmModuleTask
+{
+	struct SocketSlot
+	{
+		GsmModuleTask* Task;
+		uint8_t Mux;
+		GsmAsyncSocket* Socket;
+	};
+
+	GsmModule& _module;
+	SpscQueue<GsmTaskCommand, GsmTaskQueueLength> _commands;
+	SpscQueue<GsmTaskEvent, GsmTaskQueueLength> _events;
+	SocketSlot _slots[SocketCount];
+	std::atomic<bool> _isRunning;
+	std::atomic<GsmState> _state;
+	std::atomic<uint32_t> _droppedSendBytes;
+#ifdef ESP32
+	// cleared by task right before it deletes itself
+	TaskHandle_t volatile _taskHandle;
+#else
+	std::thread _thread;
+#endif
+
+	void* _onStateChangedCtx;
+	GsmTaskStateHandler _onStateChanged;
+	void* _onSocketEventCtx;
+	GsmTaskSocketEventHandler _onSocketEvent;
+	void* _onDataReceivedCtx;
+	GsmTaskDataHandler _onDataReceived;
+
+	static void TaskMain(void* ctx);
+	void Run();
+	void Yield();
+	// modem task side
+	bool ExecuteCommand(GsmTaskCommand& command);
+	void PushEvent(const GsmTaskEvent& event);
+	void OnSocketEvent(uint8_t mux, SocketEventType eventType);
+	void OnDataReceived(uint8_t mux, FixedStringBase& data);
+public:
+	GsmModuleTask(GsmModule& module);
+	~GsmModuleTask();
+	// stack size, priority and core are ignored outside of ESP32
+	bool Start(uint32_t stackSize = 8192, uint8_t priority = 1, int core = 0);
+	void Stop();
+	bool IsRunning()
+	{
+		return _isRunning;
+	}
+	GsmState GetState()
+	{
+		return _state;
+	}
+	// bytes of Send calls that targeted mux with no socket
+	uint32_t GetDroppedSendBytes()
+	{
+		return _droppedSendBytes;
+	}
+
+	// application side, none of these block
+	void OnStateChanged(void* ctx, GsmTaskStateHandler handler);
+	void OnSocketEvent(void* ctx, GsmTaskSocketEventHandler handler);
+	void OnDataReceived(void* ctx, GsmTaskDataHandler handler);
+	bool Connect(uint8_t mux, ProtocolType protocol, const char* host, uint16_t port);
+	// returns number of bytes queued, less than length when command queue is full
+	uint16_t Send(uint8_t mux, const char* data, uint16_t length);
+	bool Close(uint8_t mux);
+	// call from application loop, returns number of delivered events
+	uint8_t ProcessEvents();
+};
+
+#endif
+#endif
@@ -0,0 +1,220 @@
+#include "FileQueueStorage.h"
+
+#if defined(ESP32) || defined(__linux__) || defined(__APPLE__)
+
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char SegmentExtension[] = ".seg";
+
+FileQueueStorage::FileQueueStorage(const char* directory, uint32_t segmentSize, uint16_t maxSegments):
+	_segmentSize(segmentSize),
+	_maxSegments(maxSegments),
+	_head(0),
+	_tail(0),
+	_writer(nullptr),
+	_reader(nullptr),
+	_readerSegment(0)
+{
+	_directory.append(directory);
+}
+
+FileQueueStorage::~FileQueueStorage()
+{
+	CloseReader();
+	if (_writer != nullptr)
+	{
+		fclose(_writer);
+	}
+}
+
+void FileQueueStorage::SegmentPath(uint32_t segment, FixedStringBase& path)
+{
+	path.clear();
+	path.appendFormat("%s/%08x%s", _directory.c_str(), segment, SegmentExtension);
+}
+
+void FileQueueStorage::CloseReader()
+{
+	if (_reader != nullptr)
+	{
+		fclose(_reader);
+		_reader = nullptr;
+	}
+}
+
+bool FileQueueStorage::Begin()
+{
+	auto dir = opendir(_directory.c_str());
+	if (dir == nullptr)
+	{
+		mkdir(_directory.c_str(), 0755);
+		dir = opendir(_directory.c_str());
+		if (dir == nullptr)
+		{
+			return false;
+		}
+	}
+	bool isAnySegment = false;
+	uint32_t first = 0;
+	uint32_t last = 0;
+	dirent* entry;
+	while ((entry = readdir(dir)) != nullptr)
+	{
+		unsigned int segment;
+		char extension[5];
+		if (sscanf(entry->d_name, "%8x%4s", &segment, extension) != 2 || strcmp(extension, SegmentExtension) != 0)
+		{
+			continue;
+		}
+		if (!isAnySegment || segment < first)
+		{
+			first = segment;
+		}
+		if (!isAnySegment || segment > last)
+		{
+			last = segment;
+		}
+		isAnySegment = true;
+	}
+	closedir(dir);
+	if (!isAnySegment)
+	{
+		_head = 0;
+		_tail = 0;
+		return true;
+	}
+	FixedString128 path;
+	SegmentPath(last, path);
+	struct stat info;
+	const uint32_t lastSize = stat(path.c_str(), &info) == 0 ? info.st_size : 0;
+	_head = static_cast<uint64_t>(first) * _segmentSize;
+	_tail = static_cast<uint64_t>(last) * _segmentSize + lastSize;
+	return true;
+}
+
+uint16_t FileQueueStorage::Append(const char* data, uint16_t length)
+{
+	FixedString128 path;
+	uint16_t written = 0;
+	while (written < length)
+	{
+		const auto segment = static_cast<uint32_t>(_tail / _segmentSize);
+		const auto position = static_cast<uint32_t>(_tail % _segmentSize);
+		if (_writer == nullptr || position == 0)
+		{
+			if (segment - static_cast<uint32_t>(_head / _segmentSize) >= _maxSegments)
+			{
+				// storage full
+				break;
+			}
+			if (_writer != nullptr)
+			{
+				fclose(_writer);
+			}
+			SegmentPath(segment, path);
+			_writer = fopen(path.c_str(), "ab");
+			if (_writer == nullptr)
+			{
+				break;
+			}
+		}
+		auto chunk = _segmentSize - position;
+		if (chunk > static_cast<uint32_t>(length - written))
+		{
+			chunk = length - written;
+		}
+		const auto count = fwrite(data + written, 1, chunk, _writer);
+		written += count;
+		_tail += count;
+		if (count < chunk)
+		{
+			break;
+		}
+	}
+	if (_writer != nullptr)
+	{
+		fflush(_writer);
+	}
+	return written;
+}
+
+uint16_t FileQueueStorage::Read(uint64_t offset, char* buffer, uint16_t length)
+{
+	if (offset < _head || offset >= _tail)
+	{
+		return 0;
+	}
+	if (length > _tail - offset)
+	{
+		length = _tail - offset;
+	}
+	FixedString128 path;
+	uint16_t read = 0;
+	while (read < length)
+	{
+		const auto segment = static_cast<uint32_t>((offset + read) / _segmentSize);
+		const auto position = static_cast<uint32_t>((offset + read) % _segmentSize);
+		if (_reader == nullptr || _readerSegment != segment)
+		{
+			CloseReader();
+			SegmentPath(segment, path);
+			_reader = fopen(path.c_str(), "rb");
+			if (_reader == nullptr)
+			{
+				break;
+			}
+			_readerSegment = segment;
+		}
+		auto chunk = _segmentSize - position;
+		if (chunk > static_cast<uint32_t>(length - read))
+		{
+			chunk = length - read;
+		}
+		if (fseek(_reader, position, SEEK_SET) != 0)
+		{
+			break;
+		}
+		const auto count = fread(buffer + read, 1, chunk, _reader);
+		read += count;
+		if (count < chunk)
+		{
+			break;
+		}
+	}
+	return read;
+}
+
+void FileQueueStorage::Trim(uint64_t offset)
+{
+	if (offset > _tail)
+	{
+		offset = _tail;
+	}
+	if (offset <= _head)
+	{
+		return;
+	}
+	const auto firstKept = static_cast<uint32_t>(offset / _segmentSize);
+	if (_writer != nullptr && static_cast<uint32_t>((_tail - 1) / _segmentSize) < firstKept)
+	{
+		// everything written was acknowledged exactly at segment end
+		fclose(_writer);
+		_writer = nullptr;
+	}
+	FixedString128 path;
+	for (auto segment = static_cast<uint32_t>(_head / _segmentSize); segment < firstKept; segment++)
+	{
+		if (_reader != nullptr && _readerSegment == segment)
+		{
+			CloseReader();
+		}
+		SegmentPath(segment, path);
+		remove(path.c_str());
+	}
+	_head = offset;
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef _FILE_QUEUE_STORAGE_H
+#define _FILE_QUEUE_STORAGE_H
+
+// stdio and dirent are provided by ESP-IDF VFS (SPIFFS, FAT) and by host OS
+#if defined(ESP32) || defined(__linux__) || defined(__APPLE__)
+
+#include <stdio.h>
+#include <FixedString.h>
+#include "OutboundQueueStorage.h"
+
+/*
+Queue stored as fixed size segment files named by segment index, <directory>/0000002a.seg.
+Whole segments are deleted once acknowledged, so flash is never rewritten in place.
+Position inside oldest segment is not persisted, after reboot its acknowledged part
+is sent again (at least once delivery). On ESP32 mount SPIFFS first and pass
+directory below mount point, e.g. "/spiffs/q".
+*/
+class FileQueueStorage : public OutboundQueueStorage
+{
+	FixedString64 _directory;
+	uint32_t _segmentSize;
+	uint16_t _maxSegments;
+	uint64_t _head;
+	uint64_t _tail;
+	FILE* _writer;
+	FILE* _reader;
+	uint32_t _readerSegment;
+
+	void SegmentPath(uint32_t segment, FixedStringBase& path);
+	void CloseReader();
+public:
+	FileQueueStorage(const char* directory, uint32_t segmentSize = 16384, uint16_t maxSegments = 16);
+	~FileQueueStorage();
+	// creates directory or recovers queue left there by previous run
+	bool Begin();
+	uint16_t Append(const char* data, uint16_t length) override;
+	uint16_t Read(uint64_t offset, char* buffer, uint16_t length) override;
+	void Trim(uint64_t offset) override;
+	uint64_t Head() override
+	{
+		return _head;
+	}
+	uint64_t Tail() override
+	{
+		return _tail;
+	}
+};
+
+#endif
+#endif
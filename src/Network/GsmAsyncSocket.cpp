@@ -1,17 +1,32 @@
 #include "GsmAsyncSocket.h"
 #include "../GsmModule.h"
 #include "../GsmLibHelpers.h"
+#include "GsmDnsCache.h"
+#include "GsmOutboundQueue.h"
 
-GsmAsyncSocket::GsmAsyncSocket(SimcomAtCommands& gsm, uint8_t mux, ProtocolType protocol, GsmLogger& logger):
+GsmAsyncSocket::GsmAsyncSocket(SimcomAtCommands& gsm, TimerWheel& timers, uint8_t mux, ProtocolType protocol, GsmLogger& logger):
 	_logger(logger),
 	_gsm(gsm),
+	_timers(timers),
 	_mux(mux),
 	_isNetworkAvailable(false),
 	_connectAtTimeouted(false),
+	_connectStart(0),
+	_dnsCache(nullptr),
+	_outboundQueue(nullptr),
+	_datagramHead(0),
+	_datagramCount(0),
 	_protocol(protocol),
 	_state(SocketStateType::Closed),
 	_receivedBytes(0),
 	_sentBytes(0),
+	_partialSendCount(0),
+	_sendBufferDrops(0),
+	_reconnectPort(0),
+	_isReconnectArmed(false),
+	_isReconnectScheduled(false),
+	_isBreakerOpen(false),
+	_reconnectFailures(0),
 	_onSocketEventCtx(nullptr),
 	_onSocketEvent(nullptr),
 	_onSocketDataReceivedCtx(nullptr),
@@ -35,16 +50,59 @@ bool GsmAsyncSocket::IsConnected()
 	return _state == SocketStateType::Connected;
 }
 bool GsmAsyncSocket::BeginConnect(const char* host, uint16_t port)
+{
+	if (strlen(host) > SOCKET_MAX_HOST_LENGTH)
+	{
+		_logger.Error(GsmLogCategory::Socket, F("Socket [%d] host name longer than %d characters"), _mux, SOCKET_MAX_HOST_LENGTH);
+		return false;
+	}
+	_isReconnectArmed = Reconnect.Enabled;
+	if (_isReconnectArmed && host != _reconnectHost.c_str())
+	{
+		_reconnectHost.clear();
+		_reconnectHost.append(host);
+	}
+	_reconnectPort = port;
+	_isReconnectScheduled = false;
+	_timers.Stop(_reconnectTimer);
+	_isBreakerOpen = false;
+	_reconnectFailures = 0;
+	return Connect(host, port);
+}
+
+bool GsmAsyncSocket::Connect(const char* host, uint16_t port)
 {
 	RaiseEvent(SocketEventType::ConnectBegin);
-	_sendBuffer.clear();
-	auto connectResult = _gsm.BeginConnect(_protocol, _mux, host, port);
+	ClearSendBuffer();
+	_cachedHost.clear();
+	auto address = host;
+	FixedString32 ipStr;
+	if (_dnsCache != nullptr && _dnsCache->Enabled)
+	{
+		GsmIp ip;
+		const auto resolveResult = _dnsCache->Resolve(host, ip);
+		if (resolveResult == AtResultType::Success)
+		{
+			ipStr = ip.ToString();
+			address = ipStr.c_str();
+			_cachedHost.append(host);
+		}
+		else if (resolveResult == AtResultType::Timeout)
+		{
+			_logger.Warning(GsmLogCategory::Socket, F("DNS resolve AT timeouted"));
+			_connectAtTimeouted = true;
+			RaiseEvent(SocketEventType::ConnectFailed);
+			return false;
+		}
+		// lookup error, let CIPSTART resolve name itself
+	}
+	auto connectResult = _gsm.BeginConnect(_protocol, _mux, address, port);
 	
 	if (connectResult != AtResultType::Success)
 	{
 		if (connectResult == AtResultType::Timeout)
 		{
-			_logger.Log(F("_gsm::BeginConnect AT timeouted"));
+			_logger.Warning(GsmLogCategory::Socket, F("_gsm::BeginConnect AT timeouted"));
 			_connectAtTimeouted = true;
 		}
 		RaiseEvent(SocketEventType::ConnectFailed);
@@ -60,7 +118,10 @@ size_t GsmAsyncSocket::space()
 
 bool GsmAsyncSocket::Close()
 {
-	_logger.Log(F("Socket [%d] Close"), _mux);
+	_logger.Info(GsmLogCategory::Socket, F("Socket [%d] Close"), _mux);
+	_isReconnectArmed = false;
+	_isReconnectScheduled = false;
+	_timers.Stop(_reconnectTimer);
 	RaiseEvent(SocketEventType::Disconnecting);
 	const auto result = _gsm.CloseConnection(_mux);
 	return result == AtResultType::Success;
@@ -68,20 +129,60 @@ bool GsmAsyncSocket::Close()
 
 int16_t GsmAsyncSocket::Send(FixedStringBase & data)
 {
-	_sendBuffer.append(data.c_str(), data.length());
-	return data.length();
+	return Send(data.c_str(), data.length());
 }
 
 int16_t GsmAsyncSocket::Send(const char * data, uint16_t length)
 {
+	if (_outboundQueue != nullptr)
+	{
+		return _outboundQueue->Write(data, length);
+	}
 	_sendBuffer.append(data, length);
 	return length;
 }
 
 int16_t GsmAsyncSocket::Send(const char * data)
 {
-	auto length = strlen(data);
+	return Send(data, strlen(data));
+}
+
+bool GsmAsyncSocket::SendDatagram(const char* data, uint16_t length)
+{
+	if (length == 0 || length > CIPSEND_MAX_LENGTH ||
+		_datagramCount == SOCKET_DATAGRAM_QUEUE_SIZE || _sendBuffer.freeBytes() < length)
+	{
+		return false;
+	}
+	const auto index = (_datagramHead + _datagramCount) % SOCKET_DATAGRAM_QUEUE_SIZE;
+	_datagramLengths[index] = length;
+	_datagramQueuedAt[index] = millis();
+	_datagramCount++;
 	_sendBuffer.append(data, length);
+	return true;
+}
+
+void GsmAsyncSocket::ClearSendBuffer()
+{
+	_datagramStats.Failed += _datagramCount;
+	_datagramCount = 0;
+	_sendBuffer.clear();
+}
+
+uint16_t GsmAsyncSocket::OnDatagramSent(uint16_t sentBytes)
+{
+	const auto length = _datagramLengths[_datagramHead];
+	if (sentBytes < length)
+	{
+		// rest would go out as separate datagram, drop it to keep boundaries
+		_datagramStats.Failed++;
+	}
+	else
+	{
+		_datagramStats.AddSent(length, millis() - _datagramQueuedAt[_datagramHead]);
+	}
+	_datagramHead = (_datagramHead + 1) % SOCKET_DATAGRAM_QUEUE_SIZE;
+	_datagramCount--;
 	return length;
 }
 bool GsmAsyncSocket::ChangeState(SocketStateType newState)
@@ -90,18 +191,132 @@ bool GsmAsyncSocket::ChangeState(SocketStateType newState)
 	{
 		return false;
 	}
+	const auto oldState = _state;
 	_state = newState;
+	if (newState == SocketStateType::Connecting)
+	{
+		_connectStart = millis();
+		_connectStats.Attempts++;
+		if (ConnectTimeout > 0)
+		{
+			_timers.Start(_connectTimer, ConnectTimeout);
+		}
+	}
+	if (oldState == SocketStateType::Connecting)
+	{
+		_timers.Stop(_connectTimer);
+	}
+	if (oldState == SocketStateType::Connecting && newState == SocketStateType::Connected)
+	{
+		_connectStats.AddSuccess(millis() - _connectStart);
+		_reconnectFailures = 0;
+		_isBreakerOpen = false;
+		if (_outboundQueue != nullptr)
+		{
+			_outboundQueue->BeginConnection();
+		}
+	}
+	else if (oldState == SocketStateType::Connecting && newState == SocketStateType::Closed)
+	{
+		_connectStats.Failures++;
+		if (_dnsCache != nullptr && _cachedHost.length() > 0)
+		{
+			// address may be stale, resolve again on next attempt
+			_dnsCache->Invalidate(_cachedHost.c_str());
+		}
+	}
 	if (newState == SocketStateType::Closed)
 	{
 		_receivedBytes = 0;
 		_sentBytes = 0;
+		OnConnectionLost();
 	}
 	return true;
 }
 
+/*
+Called whenever socket ends up closed, schedules next attempt according to Reconnect policy.
+Closes caused by lost network are not counted as failures, SetIsNetworkAvailable
+schedules reconnect once network is back.
+*/
+void GsmAsyncSocket::OnConnectionLost()
+{
+	_isReconnectScheduled = false;
+	_timers.Stop(_reconnectTimer);
+	if (!Reconnect.Enabled || !_isReconnectArmed || !_isNetworkAvailable)
+	{
+		return;
+	}
+	_reconnectFailures++;
+	if (Reconnect.MaxAttempts > 0 && _reconnectFailures >= Reconnect.MaxAttempts)
+	{
+		_logger.Warning(GsmLogCategory::Socket, F("Socket [%d] giving up after %d failed attempts"), _mux, _reconnectFailures);
+		_isReconnectArmed = false;
+		return;
+	}
+	if (Reconnect.BreakerThreshold > 0 && _reconnectFailures >= Reconnect.BreakerThreshold)
+	{
+		if (!_isBreakerOpen)
+		{
+			_logger.Warning(GsmLogCategory::Socket, F("Socket [%d] circuit breaker open for %d ms"), _mux, Reconnect.BreakerOpenTime);
+			_isBreakerOpen = true;
+			_connectStats.BreakerTrips++;
+		}
+		ScheduleReconnect(Reconnect.BreakerOpenTime);
+		return;
+	}
+	uint32_t delay = Reconnect.MinDelay;
+	for (uint16_t i = 1; i < _reconnectFailures && delay < Reconnect.MaxDelay; i++)
+	{
+		delay *= 2;
+	}
+	if (delay > Reconnect.MaxDelay)
+	{
+		delay = Reconnect.MaxDelay;
+	}
+	ScheduleReconnect(delay);
+}
+
+void GsmAsyncSocket::ScheduleReconnect(uint32_t delay)
+{
+	if (Reconnect.JitterPercent > 0)
+	{
+		const int32_t jitter = static_cast<int32_t>(delay / 100 * Reconnect.JitterPercent);
+		delay += random(-jitter, jitter + 1);
+	}
+	_timers.Start(_reconnectTimer, delay);
+	_isReconnectScheduled = true;
+	_logger.Info(GsmLogCategory::Socket, F("Socket [%d] reconnect in %d ms"), _mux, delay);
+}
+
+void GsmAsyncSocket::ProcessReconnect()
+{
+	if (!_isReconnectScheduled || !_isReconnectArmed || !_isNetworkAvailable || _state != SocketStateType::Closed)
+	{
+		return;
+	}
+	// elapsed flag stays set until socket is ready to reconnect
+	if (!_reconnectTimer.IsElapsed())
+	{
+		return;
+	}
+	_isReconnectScheduled = false;
+	_connectStats.Reconnects++;
+	Connect(_reconnectHost.c_str(), _reconnectPort);
+}
+
 void GsmAsyncSocket::SetIsNetworkAvailable(bool isNetworkAvailable)
 {
+	const auto wasNetworkAvailable = _isNetworkAvailable;
 	_isNetworkAvailable = isNetworkAvailable;
+	if (isNetworkAvailable && !wasNetworkAvailable && Reconnect.Enabled &&
+		_isReconnectArmed && _state == SocketStateType::Closed)
+	{
+		// outage is over, start backoff from scratch
+		_reconnectFailures = 0;
+		_isBreakerOpen = false;
+		ScheduleReconnect(Reconnect.MinDelay);
+	}
 
 	if (!_isNetworkAvailable)
 	{
@@ -137,7 +352,7 @@ void GsmAsyncSocket::RaiseEvent(SocketEventType eventType)
 		return;
 	}
 	
-	_logger.Log(F("Socket [%d] event: %s"), _mux, SocketEventTypeToStr(eventType));
+	_logger.Info(GsmLogCategory::Socket, F("Socket [%d] event: %s"), _mux, SocketEventTypeToStr(eventType));
 	if (_onSocketEvent != nullptr)
 	{
 		_onSocketEvent(_onSocketEventCtx, eventType);
@@ -168,7 +383,7 @@ bool GsmAsyncSocket::OnMuxEvent(FixedStringBase & eventStr)
 	}
 	else
 	{
-		_logger.Log(F("Failed to parse socket event: %s"), eventStr.c_str());
+		_logger.Warning(GsmLogCategory::Socket, F("Failed to parse socket event: %s"), eventStr.c_str());
 		return false;
 	}
 	return true;
@@ -206,30 +421,139 @@ bool GsmAsyncSocket::GetAndResetHasConnectTimeout()
 	return false;
 }
 
+/*
+Aborts connect attempt that did not finish within ConnectTimeout.
+Returns false on AT timeout while closing
+*/
+bool GsmAsyncSocket::CheckConnectDeadline()
+{
+	if (!_connectTimer.IsElapsed() || _state != SocketStateType::Connecting)
+	{
+		return true;
+	}
+	_logger.Warning(GsmLogCategory::Socket, F("Socket [%d] connect timeout after %d ms"), _mux, millis() - _connectStart);
+	_connectStats.Timeouts++;
+	RaiseEvent(SocketEventType::ConnectFailed);
+	return _gsm.CloseConnection(_mux) != AtResultType::Timeout;
+}
+
 bool GsmAsyncSocket::SendPendingData()
 {
+	if (_outboundQueue != nullptr)
+	{
+		_outboundQueue->Flush();
+		if (_state != SocketStateType::Connected)
+		{
+			return true;
+		}
+		if (_sendBuffer.length() == 0)
+		{
+			_outboundQueue->PeekUnsent(_sendBuffer);
+		}
+	}
 	uint16_t totalSentBytes = 0;
 	while (totalSentBytes < _sendBuffer.length())
 	{
 		uint16_t sentBytes = 0;
-		auto sendResult = _gsm.Send(_mux, _sendBuffer, totalSentBytes, _sendBuffer.length()-totalSentBytes, sentBytes);
+		uint16_t length = _sendBuffer.length() - totalSentBytes;
+		if (length > CIPSEND_MAX_LENGTH)
+		{
+			length = CIPSEND_MAX_LENGTH;
+		}
+		if (_datagramCount > 0)
+		{
+			// whole datagram in single CIPSEND, SendDatagram limits it to CIPSEND_MAX_LENGTH
+			length = _datagramLengths[_datagramHead];
+		}
+		auto sendResult = _gsm.Send(_mux, _sendBuffer, totalSentBytes, length, sentBytes);
 		if (sendResult != AtResultType::Success)
 		{
-			_sendBuffer.clear();
+			if (_outboundQueue != nullptr)
+			{
+				// rest stays in queue and is sent again after reconnect
+				_outboundQueue->MarkSent(totalSentBytes);
+			}
+			ClearSendBuffer();
 			if (sendResult == AtResultType::Timeout)
 			{
+				_sendBufferDrops++;
 				return false;
 			}
 			RaiseEvent(SocketEventType::Disconnected);
 			return true;
 		}
-		totalSentBytes += sentBytes;
+		if (sentBytes < length)
+		{
+			_partialSendCount++;
+		}
 		_sentBytes += sentBytes;
+		if (_datagramCount > 0)
+		{
+			totalSentBytes += OnDatagramSent(sentBytes);
+		}
+		else
+		{
+			totalSentBytes += sentBytes;
+		}
 	}
 	_sendBuffer.clear();
+	if (_outboundQueue == nullptr)
+	{
+		return true;
+	}
+	_outboundQueue->MarkSent(totalSentBytes);
+	return UpdateQueueAck();
+}
+
+/*
+Trims queue by data remote host has acknowledged.
+UDP has no acknowledgement, datagram is done once modem accepted it
+*/
+bool GsmAsyncSocket::UpdateQueueAck()
+{
+	if (_outboundQueue->AckMode != QueueAckMode::Transport)
+	{
+		return true;
+	}
+	if (_protocol == ProtocolType::Udp)
+	{
+		_outboundQueue->Acknowledge(_outboundQueue->UnacknowledgedBytes());
+		return true;
+	}
+	if (!_outboundQueue->IsAckQueryDue())
+	{
+		return true;
+	}
+	uint32_t sentBytes = 0;
+	uint32_t ackedBytes = 0;
+	const auto result = _gsm.GetAckedBytes(_mux, sentBytes, ackedBytes);
+	if (result == AtResultType::Timeout)
+	{
+		return false;
+	}
+	if (result == AtResultType::Success)
+	{
+		_outboundQueue->OnTransportAck(ackedBytes);
+	}
 	return true;
 }
 
+bool GsmAsyncSocket::HasPendingWork()
+{
+	if (_outboundQueue != nullptr && _outboundQueue->StagedBytes() > 0)
+	{
+		return true;
+	}
+	if (_outboundQueue != nullptr && _state == SocketStateType::Connected &&
+		(_outboundQueue->UnsentBytes() > 0 || _outboundQueue->UnacknowledgedBytes() > 0))
+	{
+		return true;
+	}
+	return _sendBuffer.length() > 0 ||
+		_state == SocketStateType::Connecting ||
+		_state == SocketStateType::Closing;
+}
+
 bool GsmAsyncSocket::ReadIncomingData()
 {
 	if (_state != SocketStateType::Connected)
@@ -257,7 +581,7 @@ bool GsmAsyncSocket::ReadIncomingData()
 	{
 		return true;
 	}
-	_logger.Log(F("Read %d bytes from socket [%d]"), dataBuffer.length(), _mux);
+	_logger.Debug(GsmLogCategory::Socket, F("Read %d bytes from socket [%d]"), dataBuffer.length(), _mux);
 	_receivedBytes += dataBuffer.length();
 
 	if (_onSocketDataReceived != nullptr)
@@ -5,6 +5,8 @@
 #include "../SimcomGsmTypes.h"
 #include "../SimcomAtCommands.h"
 #include "../GsmLogger.h"
+#include "../GsmLibConstants.h"
+#include "../TimerWheel.h"
 #include <FixedString.h>
 class GsmModule;
 
@@ -30,6 +32,8 @@ typedef void(*SocketDataReceivedHandler)(void *ctx, FixedStringBase& data);
 typedef void(*OnPollHandler)(void *ctx);
 
 class SocketManager;
+class GsmDnsCache;
+class GsmOutboundQueue;
 
 class GsmAsyncSocket
 {
@@ -37,14 +41,42 @@ class GsmAsyncSocket
 
 	GsmLogger& _logger;
 	SimcomAtCommands& _gsm;
+	TimerWheel& _timers;
 	FixedString<2000> _sendBuffer;
 	uint8_t _mux;
 	bool _isNetworkAvailable;
 	bool _connectAtTimeouted;
+	unsigned long _connectStart;
+	// runs while Connecting, attempt is aborted once it elapses
+	GsmTimer _connectTimer;
+	ConnectStats _connectStats;
+	GsmDnsCache* _dnsCache;
+	GsmOutboundQueue* _outboundQueue;
+	// boundaries of datagrams in _sendBuffer, each one goes out as single CIPSEND
+	uint16_t _datagramLengths[SOCKET_DATAGRAM_QUEUE_SIZE];
+	unsigned long _datagramQueuedAt[SOCKET_DATAGRAM_QUEUE_SIZE];
+	uint8_t _datagramHead;
+	uint8_t _datagramCount;
+	DatagramStats _datagramStats;
+	// host connected through cached address, invalidated when connect fails
+	FixedString<SOCKET_MAX_HOST_LENGTH> _cachedHost;
 	ProtocolType _protocol;
 	SocketStateType _state;
 	uint64_t _receivedBytes;
 	uint64_t _sentBytes;
+	// CIPSEND calls that modem accepted only partially, remainder is sent again
+	uint32_t _partialSendCount;
+	// send buffer dropped after AT timeout while connection stayed up
+	uint32_t _sendBufferDrops;
+	// target of last BeginConnect, reused by auto reconnect, kept only when Reconnect is enabled
+	FixedString<SOCKET_MAX_HOST_LENGTH> _reconnectHost;
+	uint16_t _reconnectPort;
+	// cleared by Close so closing socket on purpose does not bring it back
+	bool _isReconnectArmed;
+	bool _isReconnectScheduled;
+	bool _isBreakerOpen;
+	uint16_t _reconnectFailures;
+	GsmTimer _reconnectTimer;
 
 	void* _onSocketEventCtx;
 	SocketEventHandler _onSocketEvent;
@@ -60,20 +92,56 @@ class GsmAsyncSocket
 	bool OnMuxEvent(FixedStringBase &eventStr);
 	void OnCipstatusInfo(ConnectionInfo& connectionInfo);
 	bool GetAndResetHasConnectTimeout();
+	bool CheckConnectDeadline();
+	bool Connect(const char* host, uint16_t port);
+	void ScheduleReconnect(uint32_t delay);
+	void OnConnectionLost();
+	void ProcessReconnect();
 	bool SendPendingData();
+	bool UpdateQueueAck();
+	void ClearSendBuffer();
+	// returns length of head datagram, which is removed from queue whether it was sent whole or not
+	uint16_t OnDatagramSent(uint16_t sentBytes);
 	bool ReadIncomingData();	
+	bool HasPendingWork();
 public:
-	GsmAsyncSocket(SimcomAtCommands& gsm, uint8_t mux, ProtocolType protocol, GsmLogger& logger);
+	GsmAsyncSocket(SimcomAtCommands& gsm, TimerWheel& timers, uint8_t mux, ProtocolType protocol, GsmLogger& logger);
+	// ms from ConnectBegin until connect is aborted with ConnectFailed, 0 waits for modem
+	uint32_t ConnectTimeout = SOCKET_CONNECT_TIMEOUT;
+	// auto reconnect after connect failure or remote close, disabled by default
+	ReconnectPolicy Reconnect;
+	SimcomAtCommands& At()
+	{
+		return _gsm;
+	}
+	// module timer wheel, advanced by GsmModule::Loop
+	TimerWheel& Timers()
+	{
+		return _timers;
+	}
+	uint8_t GetMux()
+	{
+		return _mux;
+	}
+	const ConnectStats& GetConnectStats()
+	{
+		return _connectStats;
+	}
 	SocketStateType GetState()
 	{
 		return _state;
 	}
+	ProtocolType GetProtocol()
+	{
+		return _protocol;
+	}
 	void OnSocketEvent(void *ctx, SocketEventHandler socketEventHandler);
 	void OnDataRecieved(void *ctx, SocketDataReceivedHandler onSocketDataReceived);
 	void OnPoll(void* ctx, OnPollHandler onPollHandler);
 	bool IsNetworkAvailable();
 	bool IsClosed();
 	bool IsConnected();
+	// false without connecting when host is longer than SOCKET_MAX_HOST_LENGTH
 	bool BeginConnect(const char* host, uint16_t port);
 	size_t space();
 	uint64_t GetSentBytes()
@@ -84,10 +152,47 @@ public:
 	{
 		return _receivedBytes;
 	}
+	uint32_t GetPartialSendCount()
+	{
+		return _partialSendCount;
+	}
+	// increments when buffered data was lost without Disconnected, stream has a gap
+	uint32_t GetSendBufferDrops()
+	{
+		return _sendBufferDrops;
+	}
+	uint16_t GetReconnectFailures()
+	{
+		return _reconnectFailures;
+	}
+	bool IsReconnectPending()
+	{
+		return _isReconnectArmed && _isReconnectScheduled;
+	}
+	bool IsBreakerOpen()
+	{
+		return _isBreakerOpen;
+	}
 	bool Close();
+	// Send goes through queue while attached, data survives send errors and disconnects
+	void SetOutboundQueue(GsmOutboundQueue* queue)
+	{
+		_outboundQueue = queue;
+	}
+	GsmOutboundQueue* GetOutboundQueue()
+	{
+		return _outboundQueue;
+	}
 	int16_t Send(FixedStringBase& data);
 	int16_t Send(const char* data, uint16_t length);
 	int16_t Send(const char* data);
+	// UDP, sent as one CIPSEND so boundary is kept. False when too long or queue is full,
+	// do not mix with Send on same socket
+	bool SendDatagram(const char* data, uint16_t length);
+	const DatagramStats& GetDatagramStats()
+	{
+		return _datagramStats;
+	}
 };
 
 #endif
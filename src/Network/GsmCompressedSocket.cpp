@@ -0,0 +1,129 @@
+#include "GsmCompressedSocket.h"
+
+// raw bytes compressed at once, output of one block always fits compressed buffer
+static const uint16_t CompressBlockSize = 256;
+
+GsmCompressedSocket::GsmCompressedSocket(GsmAsyncSocket& socket):
+	_socket(socket),
+	_sendBufferDrops(socket.GetSendBufferDrops()),
+	_onSocketEventCtx(nullptr),
+	_onSocketEvent(nullptr),
+	_onSocketDataReceivedCtx(nullptr),
+	_onSocketDataReceived(nullptr)
+{
+	_socket.OnSocketEvent(this, [](void* ctx, SocketEventType eventType)
+	{
+		reinterpret_cast<GsmCompressedSocket*>(ctx)->OnSocketEventInternal(eventType);
+	});
+	_socket.OnDataRecieved(this, [](void* ctx, FixedStringBase& data)
+	{
+		reinterpret_cast<GsmCompressedSocket*>(ctx)->OnDataReceivedInternal(data);
+	});
+}
+
+void GsmCompressedSocket::OnSocketEvent(void* ctx, SocketEventHandler socketEventHandler)
+{
+	_onSocketEvent = socketEventHandler;
+	_onSocketEventCtx = ctx;
+}
+
+void GsmCompressedSocket::OnDataRecieved(void* ctx, SocketDataReceivedHandler onSocketDataReceived)
+{
+	_onSocketDataReceived = onSocketDataReceived;
+	_onSocketDataReceivedCtx = ctx;
+}
+
+void GsmCompressedSocket::OnSocketEventInternal(SocketEventType eventType)
+{
+	if (eventType == SocketEventType::ConnectSuccess)
+	{
+		// remote starts with empty window as well
+		_encoder.Reset();
+		_decoder.Reset();
+		_sendBufferDrops = _socket.GetSendBufferDrops();
+	}
+	if (_onSocketEvent != nullptr)
+	{
+		_onSocketEvent(_onSocketEventCtx, eventType);
+	}
+}
+
+void GsmCompressedSocket::OnDataReceivedInternal(FixedStringBase& data)
+{
+	_stats.CompressedBytesReceived += data.length();
+	const auto start = micros();
+	_decoder.Decompress(data.c_str(), data.length(), this, [](void* ctx, FixedStringBase& decoded)
+	{
+		auto compressedSocket = reinterpret_cast<GsmCompressedSocket*>(ctx);
+		compressedSocket->_stats.RawBytesReceived += decoded.length();
+		if (compressedSocket->_onSocketDataReceived != nullptr)
+		{
+			compressedSocket->_onSocketDataReceived(compressedSocket->_onSocketDataReceivedCtx, decoded);
+		}
+	});
+	// includes time spent in data handler
+	_stats.DecompressUs += micros() - start;
+}
+
+void GsmCompressedSocket::CloseBrokenStream()
+{
+	// encoder window already holds lost data, only new connection brings both sides back in sync
+	_stats.StreamErrors++;
+	_socket.Close();
+}
+
+int16_t GsmCompressedSocket::Send(const char* data, uint16_t length)
+{
+	if (_socket.GetSendBufferDrops() != _sendBufferDrops && _socket.IsConnected())
+	{
+		_sendBufferDrops = _socket.GetSendBufferDrops();
+		CloseBrokenStream();
+		return 0;
+	}
+	FixedString<LzMaxCompressedLength(CompressBlockSize)> compressed;
+	uint16_t accepted = 0;
+	while (accepted < length)
+	{
+		auto blockLength = length - accepted;
+		if (blockLength > CompressBlockSize)
+		{
+			blockLength = CompressBlockSize;
+		}
+		if (_socket.space() < LzMaxCompressedLength(blockLength))
+		{
+			break;
+		}
+		compressed.clear();
+		const auto start = micros();
+		_encoder.Compress(data + accepted, blockLength, compressed);
+		_stats.CompressUs += micros() - start;
+		const auto sentLength = _socket.Send(compressed);
+		if (sentLength != static_cast<int16_t>(compressed.length()))
+		{
+			// block is not counted as accepted, caller sees where stream ended
+			CloseBrokenStream();
+			break;
+		}
+		_stats.RawBytesSent += blockLength;
+		_stats.CompressedBytesSent += compressed.length();
+		accepted += blockLength;
+	}
+	return accepted;
+}
+
+int16_t GsmCompressedSocket::Send(FixedStringBase& data)
+{
+	return Send(data.c_str(), data.length());
+}
+
+int16_t GsmCompressedSocket::Send(const char* data)
+{
+	return Send(data, strlen(data));
+}
+
+size_t GsmCompressedSocket::space()
+{
+	const auto space = _socket.space();
+	// incompressible data grows by one token byte per literal run
+	return space <= 1 ? 0 : (space - 1) * LzMaxLiteralRun / (LzMaxLiteralRun + 1);
+}
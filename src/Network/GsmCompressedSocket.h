@@ -0,0 +1,80 @@
+#ifndef _GSM_COMPRESSED_SOCKET_H
+#define _GSM_COMPRESSED_SOCKET_H
+
+#include "GsmAsyncSocket.h"
+#include "GsmStreamCodec.h"
+
+struct CompressionStats
+{
+	CompressionStats()
+	{
+		RawBytesSent = 0;
+		CompressedBytesSent = 0;
+		CompressedBytesReceived = 0;
+		RawBytesReceived = 0;
+		CompressUs = 0;
+		DecompressUs = 0;
+		StreamErrors = 0;
+	}
+	uint64_t RawBytesSent;
+	uint64_t CompressedBytesSent;
+	uint64_t CompressedBytesReceived;
+	uint64_t RawBytesReceived;
+	uint32_t CompressUs;
+	uint32_t DecompressUs;
+	// compressed data lost before reaching modem, remote decoder is out of sync so connection was closed
+	uint32_t StreamErrors;
+	// compressed size in percent of raw size, 100 when nothing was sent
+	uint8_t SendRatioPercent() const
+	{
+		return RawBytesSent == 0 ? 100 : CompressedBytesSent * 100 / RawBytesSent;
+	}
+	uint8_t ReceiveRatioPercent() const
+	{
+		return RawBytesReceived == 0 ? 100 : CompressedBytesReceived * 100 / RawBytesReceived;
+	}
+};
+
+/*
+Compresses everything sent through socket and decompresses everything received,
+remote side has to run same codec (GsmStreamCodec.h). Takes over socket event and
+data handlers, register them here instead. Codec state restarts with every connection,
+so do not combine with GsmOutboundQueue which replays stream from the middle.
+*/
+class GsmCompressedSocket
+{
+	GsmAsyncSocket& _socket;
+	LzEncoder _encoder;
+	LzDecoder _decoder;
+	CompressionStats _stats;
+	uint32_t _sendBufferDrops;
+	void* _onSocketEventCtx;
+	SocketEventHandler _onSocketEvent;
+	void* _onSocketDataReceivedCtx;
+	SocketDataReceivedHandler _onSocketDataReceived;
+
+	void OnSocketEventInternal(SocketEventType eventType);
+	void OnDataReceivedInternal(FixedStringBase& data);
+	void CloseBrokenStream();
+public:
+	GsmCompressedSocket(GsmAsyncSocket& socket);
+	GsmAsyncSocket& Socket()
+	{
+		return _socket;
+	}
+	const CompressionStats& GetStats()
+	{
+		return _stats;
+	}
+	void OnSocketEvent(void* ctx, SocketEventHandler socketEventHandler);
+	void OnDataRecieved(void* ctx, SocketDataReceivedHandler onSocketDataReceived);
+	// raw bytes accepted, stops early when socket send buffer is full. Closes socket and
+	// returns 0 when compressed data was lost, e.g. send buffer dropped after AT timeout
+	int16_t Send(const char* data, uint16_t length);
+	int16_t Send(FixedStringBase& data);
+	int16_t Send(const char* data);
+	// raw bytes that surely fit into socket send buffer after compression
+	size_t space();
+};
+
+#endif
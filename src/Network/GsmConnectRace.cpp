@@ -0,0 +1,165 @@
+#include "GsmConnectRace.h"
+
+GsmConnectRace::GsmConnectRace(GsmLogger& logger):
+	_logger(logger),
+	_candidateCount(0),
+	_winner(nullptr),
+	_isRunning(false),
+	_isDecided(false),
+	_startTime(0),
+	_timeToConnect(0),
+	_onCompleteCtx(nullptr),
+	_onComplete(nullptr)
+{
+}
+
+void GsmConnectRace::OnComplete(void* ctx, ConnectRaceCompleteHandler onComplete)
+{
+	_onComplete = onComplete;
+	_onCompleteCtx = ctx;
+}
+
+bool GsmConnectRace::AddCandidate(GsmAsyncSocket* socket, const char* host, uint16_t port)
+{
+	if (_isRunning || socket == nullptr || _candidateCount >= MaxRaceCandidates || strlen(host) > SOCKET_MAX_HOST_LENGTH)
+	{
+		return false;
+	}
+	if (!socket->IsClosed())
+	{
+		_logger.Warning(GsmLogCategory::Socket, F("Race candidate socket [%d] is not closed"), socket->GetMux());
+		return false;
+	}
+	auto& candidate = _candidates[_candidateCount++];
+	candidate.Race = this;
+	candidate.Socket = socket;
+	candidate.Host.clear();
+	candidate.Host.append(host);
+	candidate.Port = port;
+	candidate.IsFinished = false;
+	return true;
+}
+
+void GsmConnectRace::ClearCandidates()
+{
+	for (uint8_t i = 0; i < _candidateCount; i++)
+	{
+		if (_candidates[i].Socket != _winner)
+		{
+			_candidates[i].Socket->OnSocketEvent(nullptr, nullptr);
+		}
+	}
+	_candidateCount = 0;
+	_winner = nullptr;
+	_isRunning = false;
+	_isDecided = false;
+}
+
+bool GsmConnectRace::Begin()
+{
+	if (_isRunning || _candidateCount == 0)
+	{
+		return false;
+	}
+	_winner = nullptr;
+	_isDecided = false;
+	_isRunning = true;
+	_timeToConnect = 0;
+	_startTime = millis();
+	for (uint8_t i = 0; i < _candidateCount; i++)
+	{
+		auto& candidate = _candidates[i];
+		candidate.IsFinished = false;
+		candidate.Socket->OnSocketEvent(&candidate, [](void* ctx, SocketEventType eventType)
+		{
+			auto candidate = reinterpret_cast<Candidate*>(ctx);
+			candidate->Race->OnCandidateEvent(*candidate, eventType);
+		});
+	}
+	for (uint8_t i = 0; i < _candidateCount && !_isDecided; i++)
+	{
+		auto& candidate = _candidates[i];
+		_logger.Info(GsmLogCategory::Socket, F("Race candidate [%d] %s:%d"), candidate.Socket->GetMux(), candidate.Host.c_str(), candidate.Port);
+		// failed CIPSTART raises ConnectFailed which finishes candidate
+		candidate.Socket->BeginConnect(candidate.Host.c_str(), candidate.Port);
+	}
+	return true;
+}
+
+void GsmConnectRace::OnCandidateEvent(Candidate& candidate, SocketEventType eventType)
+{
+	if (!_isRunning)
+	{
+		return;
+	}
+	switch (eventType)
+	{
+	case SocketEventType::ConnectSuccess:
+		if (_winner == nullptr)
+		{
+			_winner = candidate.Socket;
+			_timeToConnect = millis() - _startTime;
+			_isDecided = true;
+			_logger.Info(GsmLogCategory::Socket, F("Race won by socket [%d] in %d ms"), _winner->GetMux(), _timeToConnect);
+		}
+		break;
+	case SocketEventType::ConnectFailed:
+	case SocketEventType::Disconnected:
+		candidate.IsFinished = true;
+		if (candidate.Socket == _winner)
+		{
+			// winner lost before result was reported, report failure instead
+			_winner = nullptr;
+		}
+		if (_winner == nullptr && AllFinished())
+		{
+			_isDecided = true;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+bool GsmConnectRace::AllFinished()
+{
+	for (uint8_t i = 0; i < _candidateCount; i++)
+	{
+		if (!_candidates[i].IsFinished)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void GsmConnectRace::Loop()
+{
+	if (!_isRunning || !_isDecided)
+	{
+		return;
+	}
+	Complete();
+}
+
+void GsmConnectRace::Complete()
+{
+	_isRunning = false;
+	for (uint8_t i = 0; i < _candidateCount; i++)
+	{
+		auto socket = _candidates[i].Socket;
+		socket->OnSocketEvent(nullptr, nullptr);
+		if (socket != _winner && !socket->IsClosed())
+		{
+			socket->Close();
+		}
+	}
+	if (_winner == nullptr)
+	{
+		_logger.Warning(GsmLogCategory::Socket, F("Race failed, no candidate connected"));
+	}
+	if (_onComplete != nullptr)
+	{
+		_onComplete(_onCompleteCtx, _winner);
+	}
+}
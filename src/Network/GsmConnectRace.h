@@ -0,0 +1,72 @@
+#ifndef _GSM_CONNECT_RACE_H
+#define _GSM_CONNECT_RACE_H
+
+#include "GsmAsyncSocket.h"
+#include "SocketManager.h"
+#include "../GsmLogger.h"
+#include <FixedString.h>
+
+const int MaxRaceCandidates = SocketCount;
+
+typedef void(*ConnectRaceCompleteHandler)(void* ctx, GsmAsyncSocket* winner);
+
+/*
+Connects several sockets at once (e.g. to server replicas) and keeps the first one
+that reports CONNECT OK, remaining attempts are closed.
+Race takes over event handler of candidate sockets, winner is handed over
+without handler in OnComplete. Losing attempts are closed from Loop because
+mux events are raised while AT response is being parsed.
+*/
+class GsmConnectRace
+{
+	struct Candidate
+	{
+		GsmConnectRace* Race;
+		GsmAsyncSocket* Socket;
+		FixedString<SOCKET_MAX_HOST_LENGTH> Host;
+		uint16_t Port;
+		bool IsFinished;
+	};
+
+	GsmLogger& _logger;
+	Candidate _candidates[MaxRaceCandidates];
+	uint8_t _candidateCount;
+	GsmAsyncSocket* _winner;
+	bool _isRunning;
+	bool _isDecided;
+	unsigned long _startTime;
+	uint32_t _timeToConnect;
+
+	void* _onCompleteCtx;
+	ConnectRaceCompleteHandler _onComplete;
+
+	void OnCandidateEvent(Candidate& candidate, SocketEventType eventType);
+	bool AllFinished();
+	void Complete();
+public:
+	GsmConnectRace(GsmLogger& logger);
+	// socket must be closed and belong to module that is connected to GPRS
+	bool AddCandidate(GsmAsyncSocket* socket, const char* host, uint16_t port);
+	// releases sockets from previous race
+	void ClearCandidates();
+	bool Begin();
+	// closes losing attempts and reports result, call after GsmModule::Loop
+	void Loop();
+	void OnComplete(void* ctx, ConnectRaceCompleteHandler onComplete);
+	bool IsRunning()
+	{
+		return _isRunning;
+	}
+	// null until race is won or when all candidates failed
+	GsmAsyncSocket* GetWinner()
+	{
+		return _winner;
+	}
+	// ms from Begin until winner connected
+	uint32_t GetTimeToConnect()
+	{
+		return _timeToConnect;
+	}
+};
+
+#endif
@@ -0,0 +1,185 @@
+#include "GsmDatagramSocket.h"
+#include <Arduino.h>
+
+static const uint8_t FrameHeaderLength = 2;
+
+GsmDatagramSocket::GsmDatagramSocket(GsmAsyncSocket& socket):
+	_socket(socket),
+	_batchMessages(0),
+	_receiveLength(0),
+	_receiveHeaderBytes(0),
+	_onSocketEventCtx(nullptr),
+	_onSocketEvent(nullptr),
+	_onMessageCtx(nullptr),
+	_onMessage(nullptr),
+	Mtu(512),
+	BatchDelay(50),
+	Framing(true)
+{
+	_socket.OnSocketEvent(this, [](void* ctx, SocketEventType eventType)
+	{
+		reinterpret_cast<GsmDatagramSocket*>(ctx)->OnSocketEventInternal(eventType);
+	});
+	_socket.OnDataRecieved(this, [](void* ctx, FixedStringBase& data)
+	{
+		reinterpret_cast<GsmDatagramSocket*>(ctx)->OnDataReceivedInternal(data);
+	});
+	_socket.OnPoll(this, [](void* ctx)
+	{
+		reinterpret_cast<GsmDatagramSocket*>(ctx)->OnPollInternal();
+	});
+	_batchTimer.OnElapsed(this, [](void* ctx)
+	{
+		reinterpret_cast<GsmDatagramSocket*>(ctx)->Flush();
+	});
+}
+
+GsmDatagramSocket::~GsmDatagramSocket()
+{
+	_socket.Timers().Stop(_batchTimer);
+}
+
+void GsmDatagramSocket::OnSocketEvent(void* ctx, SocketEventHandler socketEventHandler)
+{
+	_onSocketEvent = socketEventHandler;
+	_onSocketEventCtx = ctx;
+}
+
+void GsmDatagramSocket::OnMessage(void* ctx, DatagramMessageHandler onMessage)
+{
+	_onMessage = onMessage;
+	_onMessageCtx = ctx;
+}
+
+void GsmDatagramSocket::OnSocketEventInternal(SocketEventType eventType)
+{
+	if (eventType == SocketEventType::ConnectSuccess)
+	{
+		_receiveLength = 0;
+		_receiveHeaderBytes = 0;
+		_receiveMessage.clear();
+	}
+	if (_onSocketEvent != nullptr)
+	{
+		_onSocketEvent(_onSocketEventCtx, eventType);
+	}
+}
+
+void GsmDatagramSocket::OnPollInternal()
+{
+	// BatchDelay elapsed but socket queue was full, retry while socket has work
+	if (_batchMessages > 0 && !_batchTimer.IsScheduled())
+	{
+		Flush();
+	}
+}
+
+void GsmDatagramSocket::DeliverMessage(const char* data, uint16_t length)
+{
+	_stats.MessagesReceived++;
+	if (_onMessage != nullptr)
+	{
+		_onMessage(_onMessageCtx, data, length);
+	}
+}
+
+void GsmDatagramSocket::OnDataReceivedInternal(FixedStringBase& data)
+{
+	if (!Framing)
+	{
+		DeliverMessage(data.c_str(), data.length());
+		return;
+	}
+	for (uint16_t i = 0; i < data.length(); i++)
+	{
+		const auto c = static_cast<uint8_t>(data.c_str()[i]);
+		if (_receiveHeaderBytes < FrameHeaderLength)
+		{
+			_receiveLength = (_receiveLength << 8) | c;
+			if (++_receiveHeaderBytes < FrameHeaderLength)
+			{
+				continue;
+			}
+			if (_receiveLength > _receiveMessage.capacity())
+			{
+				// lost sync, remaining data of this read can not be framed
+				_stats.MalformedDatagrams++;
+				_receiveLength = 0;
+				_receiveHeaderBytes = 0;
+				return;
+			}
+		}
+		else
+		{
+			_receiveMessage.append(static_cast<char>(c));
+		}
+		if (_receiveMessage.length() == _receiveLength)
+		{
+			DeliverMessage(_receiveMessage.c_str(), _receiveMessage.length());
+			_receiveMessage.clear();
+			_receiveLength = 0;
+			_receiveHeaderBytes = 0;
+		}
+	}
+}
+
+bool GsmDatagramSocket::Send(const char* data, uint16_t length)
+{
+	const auto mtu = Mtu < _batch.capacity() ? Mtu : _batch.capacity();
+	if (!Framing)
+	{
+		if (length > mtu || !_socket.SendDatagram(data, length))
+		{
+			_stats.MessagesRejected++;
+			return false;
+		}
+		_stats.MessagesSent++;
+		return true;
+	}
+	if (static_cast<size_t>(length) + FrameHeaderLength > mtu)
+	{
+		_stats.MessagesRejected++;
+		return false;
+	}
+	if (_batch.length() + FrameHeaderLength + length > mtu && !Flush())
+	{
+		_stats.MessagesRejected++;
+		return false;
+	}
+	if (_batchMessages == 0 && BatchDelay > 0)
+	{
+		_socket.Timers().Start(_batchTimer, BatchDelay);
+	}
+	_batch.append(static_cast<char>(length >> 8));
+	_batch.append(static_cast<char>(length & 0xFF));
+	_batch.append(data, length);
+	_batchMessages++;
+	if (BatchDelay == 0)
+	{
+		Flush();
+	}
+	return true;
+}
+
+bool GsmDatagramSocket::Send(FixedStringBase& data)
+{
+	return Send(data.c_str(), data.length());
+}
+
+bool GsmDatagramSocket::Flush()
+{
+	if (_batchMessages == 0)
+	{
+		return true;
+	}
+	if (!_socket.SendDatagram(_batch.c_str(), _batch.length()))
+	{
+		// batch is kept, next poll retries
+		return false;
+	}
+	_socket.Timers().Stop(_batchTimer);
+	_stats.MessagesSent += _batchMessages;
+	_batchMessages = 0;
+	_batch.clear();
+	return true;
+}
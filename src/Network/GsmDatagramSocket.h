@@ -0,0 +1,88 @@
+#ifndef _GSM_DATAGRAM_SOCKET_H
+#define _GSM_DATAGRAM_SOCKET_H
+
+#include "GsmAsyncSocket.h"
+
+typedef void(*DatagramMessageHandler)(void* ctx, const char* data, uint16_t length);
+
+struct DatagramMessageStats
+{
+	DatagramMessageStats()
+	{
+		MessagesSent = 0;
+		MessagesRejected = 0;
+		MessagesReceived = 0;
+		MalformedDatagrams = 0;
+	}
+	uint32_t MessagesSent;
+	// too long or socket queue was full
+	uint32_t MessagesRejected;
+	uint32_t MessagesReceived;
+	uint32_t MalformedDatagrams;
+	// messages per datagram sent by socket
+	float MessagesPerDatagram(const DatagramStats& datagramStats) const
+	{
+		return datagramStats.Sent == 0 ? 0 : static_cast<float>(MessagesSent) / datagramStats.Sent;
+	}
+};
+
+/*
+Message oriented API over UDP GsmAsyncSocket. With Framing every message is prefixed
+by 2 byte big endian length and small messages are coalesced into one datagram up to Mtu,
+datagram is sent when next message does not fit or BatchDelay elapses. Modem delivers
+received UDP data through CIPRXGET as byte stream, length prefix restores message
+boundaries there. Without Framing one message is one datagram and received data is
+passed through as is. Takes over socket event, data and poll handlers.
+*/
+class GsmDatagramSocket
+{
+	GsmAsyncSocket& _socket;
+	FixedString<CIPSEND_MAX_LENGTH> _batch;
+	uint8_t _batchMessages;
+	// BatchDelay deadline on module timer wheel, so CPU sleep does not hold staged batch back
+	GsmTimer _batchTimer;
+	FixedString<CIPSEND_MAX_LENGTH> _receiveMessage;
+	uint16_t _receiveLength;
+	uint8_t _receiveHeaderBytes;
+	DatagramMessageStats _stats;
+	void* _onSocketEventCtx;
+	SocketEventHandler _onSocketEvent;
+	void* _onMessageCtx;
+	DatagramMessageHandler _onMessage;
+
+	void OnSocketEventInternal(SocketEventType eventType);
+	void OnDataReceivedInternal(FixedStringBase& data);
+	void OnPollInternal();
+	void DeliverMessage(const char* data, uint16_t length);
+public:
+	// datagram payload limit, keep below path MTU to avoid fragmentation
+	uint16_t Mtu;
+	// ms, 0 sends every message immediately
+	uint16_t BatchDelay;
+	bool Framing;
+
+	GsmDatagramSocket(GsmAsyncSocket& socket);
+	GsmDatagramSocket(const GsmDatagramSocket&) = delete;
+	~GsmDatagramSocket();
+	GsmAsyncSocket& Socket()
+	{
+		return _socket;
+	}
+	const DatagramMessageStats& GetStats()
+	{
+		return _stats;
+	}
+	const DatagramStats& GetDatagramStats()
+	{
+		return _socket.GetDatagramStats();
+	}
+	void OnSocketEvent(void* ctx, SocketEventHandler socketEventHandler);
+	void OnMessage(void* ctx, DatagramMessageHandler onMessage);
+	// false when message can not fit into datagram or socket queue is full
+	bool Send(const char* data, uint16_t length);
+	bool Send(FixedStringBase& data);
+	// sends pending batch now
+	bool Flush();
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "GsmDnsCache.h"
+#include "../Parsing/ParsingHelpers.h"
+
+GsmDnsCache::GsmDnsCache(SimcomAtCommands& gsm, GsmLogger& logger):
+	_logger(logger),
+	_gsm(gsm),
+	_hits(0),
+	_misses(0)
+{
+	Clear();
+}
+
+void GsmDnsCache::Clear()
+{
+	for (int i = 0; i < DnsCacheSize; i++)
+	{
+		_entries[i].IsValid = false;
+	}
+}
+
+GsmDnsCache::Entry* GsmDnsCache::Find(const char* host)
+{
+	for (int i = 0; i < DnsCacheSize; i++)
+	{
+		auto& entry = _entries[i];
+		if (entry.IsValid && strcmp(entry.Host.c_str(), host) == 0)
+		{
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+GsmDnsCache::Entry& GsmDnsCache::FreeEntry()
+{
+	auto oldest = &_entries[0];
+	for (int i = 0; i < DnsCacheSize; i++)
+	{
+		auto& entry = _entries[i];
+		if (!entry.IsValid)
+		{
+			return entry;
+		}
+		if (static_cast<long>(entry.LastUsed - oldest->LastUsed) < 0)
+		{
+			oldest = &entry;
+		}
+	}
+	return *oldest;
+}
+
+AtResultType GsmDnsCache::Resolve(const char* host, GsmIp& ip)
+{
+	FixedString<SOCKET_MAX_HOST_LENGTH> hostStr;
+	if (!hostStr.append(host))
+	{
+		_logger.Warning(GsmLogCategory::Socket, F("Host name longer than %d characters is not cached"), SOCKET_MAX_HOST_LENGTH);
+		return AtResultType::Error;
+	}
+	// ParseIpAddress would also take names with four labels such as a.b.example.com
+	const auto isNumeric = strspn(host, "0123456789.") == hostStr.length();
+	if (isNumeric && ParsingHelpers::ParseIpAddress(hostStr, ip))
+	{
+		return AtResultType::Success;
+	}
+	const auto now = millis();
+	auto entry = Find(host);
+	if (entry != nullptr)
+	{
+		if (now - entry->ResolvedAt < Ttl)
+		{
+			entry->LastUsed = now;
+			ip = entry->Ip;
+			_hits++;
+			return AtResultType::Success;
+		}
+		entry->IsValid = false;
+	}
+	_misses++;
+	GsmIp resolvedIp;
+	const auto result = _gsm.ResolveHost(host, resolvedIp);
+	if (result != AtResultType::Success)
+	{
+		_logger.Warning(GsmLogCategory::Socket, F("Failed to resolve %s"), host);
+		return result;
+	}
+	auto& newEntry = FreeEntry();
+	newEntry.Host = hostStr;
+	newEntry.Ip = resolvedIp;
+	newEntry.ResolvedAt = millis();
+	newEntry.LastUsed = newEntry.ResolvedAt;
+	newEntry.IsValid = true;
+	ip = resolvedIp;
+	_logger.Info(GsmLogCategory::Socket, F("Resolved %s to %s"), host, resolvedIp.ToString().c_str());
+	return AtResultType::Success;
+}
+
+void GsmDnsCache::Invalidate(const char* host)
+{
+	auto entry = Find(host);
+	if (entry != nullptr)
+	{
+		entry->IsValid = false;
+	}
+}
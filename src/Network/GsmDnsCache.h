@@ -0,0 +1,57 @@
+#ifndef _GSM_DNS_CACHE_H
+#define _GSM_DNS_CACHE_H
+
+#include "../SimcomAtCommands.h"
+#include "../SimcomGsmTypes.h"
+#include "../GsmLogger.h"
+#include <FixedString.h>
+
+const int DnsCacheSize = 4;
+
+/*
+Resolves host names with AT+CDNSGIP and keeps results for Ttl ms so reconnects
+can pass IP address to CIPSTART instead of letting modem resolve name again.
+CDNSGIP does not report record TTL, entries expire after configured Ttl.
+When table is full least recently used entry is replaced.
+*/
+class GsmDnsCache
+{
+	struct Entry
+	{
+		FixedString<SOCKET_MAX_HOST_LENGTH> Host;
+		GsmIp Ip;
+		unsigned long ResolvedAt;
+		unsigned long LastUsed;
+		bool IsValid;
+	};
+
+	GsmLogger& _logger;
+	SimcomAtCommands& _gsm;
+	Entry _entries[DnsCacheSize];
+	uint32_t _hits;
+	uint32_t _misses;
+
+	Entry* Find(const char* host);
+	Entry& FreeEntry();
+public:
+	GsmDnsCache(SimcomAtCommands& gsm, GsmLogger& logger);
+	// sockets resolve through cache only when enabled
+	bool Enabled = false;
+	uint32_t Ttl = DNS_CACHE_TTL;
+	// host can also be IP address, it is returned without lookup. Hosts longer than
+	// SOCKET_MAX_HOST_LENGTH are not resolved, Error lets CIPSTART resolve them
+	AtResultType Resolve(const char* host, GsmIp& ip);
+	// call when connecting to cached address failed, next Resolve asks modem again
+	void Invalidate(const char* host);
+	void Clear();
+	uint32_t GetHits()
+	{
+		return _hits;
+	}
+	uint32_t GetMisses()
+	{
+		return _misses;
+	}
+};
+
+#endif
@@ -0,0 +1,360 @@
+#include "GsmFtpClient.h"
+
+// modem error codes after which retrying does not help
+static const uint8_t FtpUserError = 71;
+static const uint8_t FtpPasswordError = 72;
+// download checks for data this often when +FTPGET: 1,1 did not come
+static const uint16_t FtpDownloadPollInterval = 1000;
+
+GsmFtpClient::GsmFtpClient(GsmModule& module):
+	_module(module),
+	_gsm(module.At()),
+	_logger(module.At().Logger()),
+	_state(FtpTransferState::Idle),
+	_isUpload(false),
+	_length(0),
+	_offset(0),
+	_ctx(nullptr),
+	_source(nullptr),
+	_sink(nullptr),
+	_maxChunkLength(0),
+	_isReady(false),
+	_isFinished(false),
+	_lastError(0),
+	_startedAt(0),
+	_lastActivity(0),
+	_resumeAt(0)
+{
+	_gsm.OnFtpSession(this, [](void* ctx, bool isUpload, uint8_t status, uint16_t maxLength)
+	{
+		reinterpret_cast<GsmFtpClient*>(ctx)->OnFtpSessionInternal(isUpload, status, maxLength);
+	});
+}
+
+bool GsmFtpClient::IsSessionActive()
+{
+	return _state == FtpTransferState::Opening || _state == FtpTransferState::Transferring || _state == FtpTransferState::Closing;
+}
+
+bool GsmFtpClient::IsBusy()
+{
+	return IsSessionActive() || _state == FtpTransferState::WaitingToResume;
+}
+
+bool GsmFtpClient::BeginUpload(const char* path, const char* name, uint32_t length, void* ctx, FtpUploadSource source)
+{
+	if (IsBusy())
+	{
+		return false;
+	}
+	_length = length;
+	_ctx = ctx;
+	_source = source;
+	return Begin(true, path, name);
+}
+
+bool GsmFtpClient::BeginDownload(const char* path, const char* name, void* ctx, FtpDownloadSink sink)
+{
+	if (IsBusy())
+	{
+		return false;
+	}
+	_length = 0;
+	_ctx = ctx;
+	_sink = sink;
+	return Begin(false, path, name);
+}
+
+bool GsmFtpClient::Begin(bool isUpload, const char* path, const char* name)
+{
+	_isUpload = isUpload;
+	_path = path;
+	_name = name;
+	_offset = 0;
+	_lastError = 0;
+	_stats = FtpTransferStats();
+	_startedAt = millis();
+	StartSession();
+	// errors before session opened are retried as well
+	return _state != FtpTransferState::Failed;
+}
+
+bool GsmFtpClient::Configure()
+{
+	return _gsm.FtpSetParameter("CID", 1u) == AtResultType::Success &&
+		_gsm.FtpSetParameter("SERV", Server) == AtResultType::Success &&
+		_gsm.FtpSetParameter("PORT", static_cast<uint32_t>(Port)) == AtResultType::Success &&
+		_gsm.FtpSetParameter("UN", User) == AtResultType::Success &&
+		_gsm.FtpSetParameter("PW", Password) == AtResultType::Success &&
+		_gsm.FtpSetParameter("TYPE", "I") == AtResultType::Success &&
+		_gsm.FtpSetParameter("MODE", 1u) == AtResultType::Success &&
+		// GETNAME is also used by AT+FTPSIZE
+		_gsm.FtpSetParameter("GETPATH", _path.c_str()) == AtResultType::Success &&
+		_gsm.FtpSetParameter("GETNAME", _name.c_str()) == AtResultType::Success &&
+		(!_isUpload ||
+			(_gsm.FtpSetParameter("PUTPATH", _path.c_str()) == AtResultType::Success &&
+			_gsm.FtpSetParameter("PUTNAME", _name.c_str()) == AtResultType::Success));
+}
+
+bool GsmFtpClient::StartSession()
+{
+	_isReady = false;
+	_isFinished = false;
+	_maxChunkLength = 0;
+	_lastActivity = millis();
+	if (_module.GetState() != GsmState::ConnectedToGprs)
+	{
+		Fail(0, "no GPRS connection");
+		return false;
+	}
+	if (_module.OpenBearer() != AtResultType::Success || !Configure())
+	{
+		Fail(0, "configuration");
+		return false;
+	}
+	uint32_t serverSize;
+	if (_isUpload)
+	{
+		// server keeps what arrived before failure, modem buffer is lost
+		if (_stats.Resumes > 0)
+		{
+			_offset = _gsm.FtpGetSize(serverSize) == AtResultType::Success && serverSize <= _length ? serverSize : 0;
+			if (_offset == _length && _length > 0)
+			{
+				Complete();
+				return true;
+			}
+		}
+		if (_gsm.FtpSetParameter("PUTOPT", _offset > 0 ? "APPE" : "STOR") != AtResultType::Success ||
+			_gsm.FtpPutOpen() != AtResultType::Success)
+		{
+			Fail(0, "FTPPUT");
+			return false;
+		}
+	}
+	else
+	{
+		// size is only used to detect truncated download, some servers do not support SIZE
+		if (_length == 0 && _gsm.FtpGetSize(serverSize) == AtResultType::Success)
+		{
+			_length = serverSize;
+		}
+		if (_gsm.FtpSetParameter("REST", _offset) != AtResultType::Success ||
+			_gsm.FtpGetOpen() != AtResultType::Success)
+		{
+			Fail(0, "FTPGET");
+			return false;
+		}
+	}
+	_state = FtpTransferState::Opening;
+	return true;
+}
+
+void GsmFtpClient::Fail(uint8_t error, const char* reason)
+{
+	_lastError = error;
+	_logger.Warning(GsmLogCategory::General, F("FTP transfer failed at %u b: %s (%d)"), _offset, reason, error);
+	_stats.ElapsedMs = millis() - _startedAt;
+	if (_stats.Resumes >= MaxResumes || error == FtpUserError || error == FtpPasswordError)
+	{
+		_state = FtpTransferState::Failed;
+		return;
+	}
+	_state = FtpTransferState::WaitingToResume;
+	_resumeAt = millis() + ResumeDelay;
+}
+
+void GsmFtpClient::Complete()
+{
+	_state = FtpTransferState::Completed;
+	_stats.ElapsedMs = millis() - _startedAt;
+	_logger.Info(GsmLogCategory::General, F("FTP transfer of %u b completed in %u ms, %u B/s"), _offset, _stats.ElapsedMs, _stats.BytesPerSecond());
+}
+
+void GsmFtpClient::OnFtpSessionInternal(bool isUpload, uint8_t status, uint16_t maxLength)
+{
+	if (isUpload != _isUpload || !IsSessionActive())
+	{
+		return;
+	}
+	_lastActivity = millis();
+	if (status == 1)
+	{
+		if (isUpload)
+		{
+			_maxChunkLength = maxLength < _buffer.capacity() ? maxLength : _buffer.capacity();
+			if (_maxChunkLength > _stats.MaxChunkLength)
+			{
+				_stats.MaxChunkLength = _maxChunkLength;
+			}
+		}
+		_isReady = true;
+		_state = _state == FtpTransferState::Opening ? FtpTransferState::Transferring : _state;
+		return;
+	}
+	if (status == 0)
+	{
+		if (!isUpload)
+		{
+			// data still buffered in modem is read before completing
+			_isFinished = true;
+			_state = _state == FtpTransferState::Opening ? FtpTransferState::Transferring : _state;
+			return;
+		}
+		if (_state == FtpTransferState::Closing)
+		{
+			Complete();
+			return;
+		}
+	}
+	Fail(status, "session closed");
+}
+
+void GsmFtpClient::Upload()
+{
+	for (uint8_t i = 0; i < ChunksPerLoop && _isReady && _state == FtpTransferState::Transferring; i++)
+	{
+		if (_offset == _length)
+		{
+			if (_gsm.FtpPutClose() != AtResultType::Success)
+			{
+				Fail(0, "closing");
+				return;
+			}
+			_state = FtpTransferState::Closing;
+			_lastActivity = millis();
+			return;
+		}
+		auto length = _length - _offset;
+		if (length > _maxChunkLength)
+		{
+			length = _maxChunkLength;
+		}
+		_buffer.clear();
+		_source(_ctx, _offset, length, _buffer);
+		if (_buffer.length() == 0)
+		{
+			_logger.Error(GsmLogCategory::General, F("FTP upload source returned no data at %u b"), _offset);
+			_state = FtpTransferState::Failed;
+			return;
+		}
+		// next chunk follows without waiting for +FTPPUT: 1,1 until modem refuses it
+		uint16_t acceptedLength;
+		if (_gsm.FtpPutWrite(_buffer.c_str(), _buffer.length(), acceptedLength) != AtResultType::Success)
+		{
+			if (_state == FtpTransferState::Transferring)
+			{
+				Fail(0, "FTPPUT");
+			}
+			return;
+		}
+		if (acceptedLength == 0)
+		{
+			_stats.RefusedChunks++;
+			_isReady = false;
+			return;
+		}
+		_offset += acceptedLength;
+		_stats.Bytes += acceptedLength;
+		_stats.Chunks++;
+		_lastActivity = millis();
+	}
+}
+
+void GsmFtpClient::Download()
+{
+	for (uint8_t i = 0; i < ChunksPerLoop && _state == FtpTransferState::Transferring; i++)
+	{
+		if (!_isReady && !_isFinished && millis() - _lastActivity < FtpDownloadPollInterval)
+		{
+			return;
+		}
+		_buffer.clear();
+		uint16_t readBytes = 0;
+		const auto result = _gsm.FtpGetRead(_buffer.capacity(), _buffer, readBytes);
+		if (result != AtResultType::Success && !_isFinished)
+		{
+			if (_state == FtpTransferState::Transferring)
+			{
+				Fail(0, "FTPGET");
+			}
+			return;
+		}
+		if (readBytes == 0)
+		{
+			_isReady = false;
+			_lastActivity = millis();
+			if (!_isFinished)
+			{
+				return;
+			}
+			if (_length != 0 && _offset < _length)
+			{
+				Fail(0, "download truncated");
+				return;
+			}
+			Complete();
+			return;
+		}
+		_sink(_ctx, _offset, _buffer);
+		_offset += readBytes;
+		_stats.Bytes += readBytes;
+		_stats.Chunks++;
+		_lastActivity = millis();
+	}
+}
+
+FtpTransferState GsmFtpClient::Loop()
+{
+	if (_state == FtpTransferState::WaitingToResume)
+	{
+		if (static_cast<long>(millis() - _resumeAt) >= 0 && _module.GetState() == GsmState::ConnectedToGprs)
+		{
+			_stats.Resumes++;
+			_logger.Info(GsmLogCategory::General, F("Resuming FTP transfer at %u b, attempt %d"), _offset, _stats.Resumes);
+			StartSession();
+		}
+		return _state;
+	}
+	if (!IsSessionActive())
+	{
+		return _state;
+	}
+	// session URCs are picked up without waiting for next command
+	if (!_gsm.IsCommandPending())
+	{
+		_gsm.wait(0);
+	}
+	if (_module.GetState() != GsmState::ConnectedToGprs)
+	{
+		Fail(0, "GPRS connection lost");
+		return _state;
+	}
+	if (_state == FtpTransferState::Transferring)
+	{
+		if (_isUpload)
+		{
+			Upload();
+		}
+		else
+		{
+			Download();
+		}
+	}
+	if (IsSessionActive() && millis() - _lastActivity > FTP_SESSION_TIMEOUT)
+	{
+		Fail(0, "timeout");
+	}
+	_stats.ElapsedMs = millis() - _startedAt;
+	return _state;
+}
+
+void GsmFtpClient::Abort()
+{
+	// server keeps partial upload
+	if (_isUpload && _state == FtpTransferState::Transferring)
+	{
+		_gsm.FtpPutClose();
+	}
+	_state = FtpTransferState::Idle;
+}
@@ -0,0 +1,139 @@
+#ifndef _GSM_FTP_CLIENT_H
+#define _GSM_FTP_CLIENT_H
+
+#include "../GsmModule.h"
+#include "../SimcomAtCommands.h"
+#include "../GsmLogger.h"
+#include <FixedString.h>
+
+enum class FtpTransferState : uint8_t
+{
+	Idle,
+	// waiting for modem to log in and open data connection
+	Opening,
+	Transferring,
+	// upload sent, waiting for server to confirm
+	Closing,
+	WaitingToResume,
+	Completed,
+	Failed
+};
+
+struct FtpTransferStats
+{
+	FtpTransferStats()
+	{
+		Bytes = 0;
+		Chunks = 0;
+		RefusedChunks = 0;
+		Resumes = 0;
+		MaxChunkLength = 0;
+		ElapsedMs = 0;
+	}
+	// bytes moved over serial, data repeated after resume is counted again
+	uint32_t Bytes;
+	uint32_t Chunks;
+	// AT+FTPPUT=2 answered with 0 because modem buffer was full
+	uint32_t RefusedChunks;
+	uint8_t Resumes;
+	uint16_t MaxChunkLength;
+	// from Begin until completion, includes time spent waiting to resume
+	uint32_t ElapsedMs;
+	uint32_t BytesPerSecond() const
+	{
+		return ElapsedMs == 0 ? 0 : static_cast<uint64_t>(Bytes) * 1000 / ElapsedMs;
+	}
+};
+
+// appends up to length bytes of file starting at offset to buffer
+typedef void(*FtpUploadSource)(void* ctx, uint32_t offset, uint16_t length, FixedStringBase& buffer);
+typedef void(*FtpDownloadSink)(void* ctx, uint32_t offset, FixedStringBase& data);
+
+/*
+File transfer on modem FTP stack (AT+FTPPUT, AT+FTPGET) in binary passive mode.
+Upload submits chunks of the size announced by modem back to back, next AT+FTPPUT=2
+is sent right after previous one was accepted and only waits for +FTPPUT: 1,1 when
+modem reports full buffer. Data is pulled from source callback by offset, so after
+disconnect or server error transfer resumes where server copy ends: upload asks
+AT+FTPSIZE and continues with APPE, download restarts with AT+FTPREST.
+Call Loop until state is Completed or Failed. One transfer at a time, client takes over
+OnFtpSession handler of SimcomAtCommands.
+*/
+class GsmFtpClient
+{
+	GsmModule& _module;
+	SimcomAtCommands& _gsm;
+	GsmLogger& _logger;
+	FtpTransferState _state;
+	bool _isUpload;
+	FixedString64 _path;
+	FixedString64 _name;
+	// upload: file length, download: size reported by server, 0 when unknown
+	uint32_t _length;
+	// bytes passed to modem (upload) or to sink (download)
+	uint32_t _offset;
+	void* _ctx;
+	FtpUploadSource _source;
+	FtpDownloadSink _sink;
+	FixedString<CIPSEND_MAX_LENGTH> _buffer;
+	uint16_t _maxChunkLength;
+	// modem signalled it accepts more upload data or has download data
+	bool _isReady;
+	bool _isFinished;
+	uint8_t _lastError;
+	unsigned long _startedAt;
+	unsigned long _lastActivity;
+	unsigned long _resumeAt;
+	FtpTransferStats _stats;
+
+	bool IsSessionActive();
+	bool IsBusy();
+	bool Begin(bool isUpload, const char* path, const char* name);
+	bool StartSession();
+	bool Configure();
+	void Fail(uint8_t error, const char* reason);
+	void Complete();
+	void Upload();
+	void Download();
+	void OnFtpSessionInternal(bool isUpload, uint8_t status, uint16_t maxLength);
+public:
+	GsmFtpClient(GsmModule& module);
+	const char* Server = "";
+	uint16_t Port = 21;
+	const char* User = "anonymous";
+	const char* Password = "";
+	// transfer is resumed that many times after errors before it fails
+	uint8_t MaxResumes = 5;
+	uint32_t ResumeDelay = 5000;
+	// chunks moved per Loop call, limits time other module work waits
+	uint8_t ChunksPerLoop = 4;
+
+	bool BeginUpload(const char* path, const char* name, uint32_t length, void* ctx, FtpUploadSource source);
+	bool BeginDownload(const char* path, const char* name, void* ctx, FtpDownloadSink sink);
+	FtpTransferState Loop();
+	// stops transfer, it can not be resumed
+	void Abort();
+	FtpTransferState GetState()
+	{
+		return _state;
+	}
+	uint32_t GetOffset()
+	{
+		return _offset;
+	}
+	uint32_t GetLength()
+	{
+		return _length;
+	}
+	// modem error code of last failure, e.g. 61 net error, 64 timeout, 66 not allowed, 77 operate error
+	uint8_t GetLastError()
+	{
+		return _lastError;
+	}
+	const FtpTransferStats& GetStats()
+	{
+		return _stats;
+	}
+};
+
+#endif
@@ -0,0 +1,182 @@
+#include "GsmHttpClient.h"
+
+GsmHttpClient::GsmHttpClient(GsmModule& module):
+	_module(module),
+	_gsm(module.At()),
+	_logger(module.At().Logger()),
+	_state(HttpClientState::Idle),
+	_method(HttpMethod::Get),
+	_isInitialized(false),
+	_statusCode(0),
+	_contentLength(0),
+	_readOffset(0),
+	_requestStart(0),
+	_responseTime(0)
+{
+	_gsm.OnHttpAction(this, [](void* ctx, HttpMethod method, uint16_t statusCode, uint32_t dataLength)
+	{
+		reinterpret_cast<GsmHttpClient*>(ctx)->OnHttpActionInternal(method, statusCode, dataLength);
+	});
+}
+
+bool GsmHttpClient::Get(const char* url)
+{
+	return BeginRequest(HttpMethod::Get, url, nullptr, nullptr, 0);
+}
+
+bool GsmHttpClient::Head(const char* url)
+{
+	return BeginRequest(HttpMethod::Head, url, nullptr, nullptr, 0);
+}
+
+bool GsmHttpClient::Post(const char* url, const char* contentType, const char* body, uint32_t length)
+{
+	return BeginRequest(HttpMethod::Post, url, contentType, body, length);
+}
+
+bool GsmHttpClient::Fail(const char* reason)
+{
+	_logger.Warning(GsmLogCategory::General, F("HTTP request failed: %s"), reason);
+	_state = HttpClientState::Failed;
+	return false;
+}
+
+bool GsmHttpClient::Initialize()
+{
+	if (_isInitialized)
+	{
+		return true;
+	}
+	if (_gsm.HttpInit() != AtResultType::Success)
+	{
+		// session left open e.g. by previous run of program
+		_gsm.HttpTerm();
+		if (_gsm.HttpInit() != AtResultType::Success)
+		{
+			return false;
+		}
+	}
+	_isInitialized = _gsm.HttpSetParameter("CID", "1") == AtResultType::Success;
+	return _isInitialized;
+}
+
+bool GsmHttpClient::BeginRequest(HttpMethod method, const char* url, const char* contentType, const char* body, uint32_t bodyLength)
+{
+	if (_state == HttpClientState::WaitingForResponse)
+	{
+		return false;
+	}
+	_statusCode = 0;
+	_contentLength = 0;
+	_readOffset = 0;
+	_responseTime = 0;
+	if (_module.GetState() != GsmState::ConnectedToGprs)
+	{
+		return Fail("no GPRS connection");
+	}
+	if (_module.OpenBearer() != AtResultType::Success)
+	{
+		return Fail("could not open bearer");
+	}
+	if (!Initialize())
+	{
+		return Fail("HTTPINIT");
+	}
+	if (_gsm.HttpSetParameter("URL", url) != AtResultType::Success)
+	{
+		return Fail("invalid URL");
+	}
+	if (method == HttpMethod::Post)
+	{
+		if (_gsm.HttpSetParameter("CONTENT", contentType) != AtResultType::Success ||
+			_gsm.HttpSetData(body, bodyLength) != AtResultType::Success)
+		{
+			return Fail("HTTPDATA");
+		}
+	}
+	_state = HttpClientState::WaitingForResponse;
+	_method = method;
+	_requestStart = millis();
+	if (_gsm.HttpAction(method) != AtResultType::Success)
+	{
+		return Fail("HTTPACTION");
+	}
+	// result may have arrived together with OK
+	return _state != HttpClientState::Failed;
+}
+
+void GsmHttpClient::OnHttpActionInternal(HttpMethod method, uint16_t statusCode, uint32_t dataLength)
+{
+	if (_state != HttpClientState::WaitingForResponse)
+	{
+		return;
+	}
+	if (method != _method)
+	{
+		_logger.Warning(GsmLogCategory::General, F("Dropped HTTP %d result of method %d"), statusCode, static_cast<int>(method));
+		return;
+	}
+	_responseTime = millis() - _requestStart;
+	_statusCode = statusCode;
+	_contentLength = dataLength;
+	if (statusCode >= 600)
+	{
+		Fail("modem error");
+		return;
+	}
+	_logger.Info(GsmLogCategory::General, F("HTTP %d, %u b in %u ms"), statusCode, dataLength, _responseTime);
+	_state = HttpClientState::ResponseReady;
+}
+
+HttpClientState GsmHttpClient::Loop()
+{
+	if (_state != HttpClientState::WaitingForResponse)
+	{
+		return _state;
+	}
+	// +HTTPACTION arrives as URC, pick it up without waiting for next command
+	if (!_gsm.IsCommandPending())
+	{
+		_gsm.wait(0);
+	}
+	if (_state == HttpClientState::WaitingForResponse && millis() - _requestStart > Timeout)
+	{
+		Fail("timeout");
+	}
+	return _state;
+}
+
+int32_t GsmHttpClient::Read(FixedStringBase& buffer)
+{
+	if (_state != HttpClientState::ResponseReady)
+	{
+		return -1;
+	}
+	if (_readOffset >= _contentLength)
+	{
+		return 0;
+	}
+	auto length = GetRemainingBytes();
+	if (length > buffer.freeBytes())
+	{
+		length = buffer.freeBytes();
+	}
+	uint16_t readBytes;
+	// nothing returned while body is not complete means modem dropped response
+	if (length == 0 || _gsm.HttpRead(_readOffset, length, buffer, readBytes) != AtResultType::Success || readBytes == 0)
+	{
+		return -1;
+	}
+	_readOffset += readBytes;
+	return readBytes;
+}
+
+void GsmHttpClient::End()
+{
+	if (_isInitialized)
+	{
+		_gsm.HttpTerm();
+		_isInitialized = false;
+	}
+	_state = HttpClientState::Idle;
+}
@@ -0,0 +1,84 @@
+#ifndef _GSM_HTTP_CLIENT_H
+#define _GSM_HTTP_CLIENT_H
+
+#include "../GsmModule.h"
+#include "../SimcomAtCommands.h"
+#include "../GsmLogger.h"
+#include <FixedString.h>
+
+enum class HttpClientState : uint8_t
+{
+	Idle,
+	WaitingForResponse,
+	ResponseReady,
+	Failed
+};
+
+/*
+HTTP client running on modem HTTP stack (AT+SAPBR, AT+HTTPINIT, AT+HTTPACTION, AT+HTTPREAD).
+Modem downloads whole response itself, body is then read in chunks straight into caller
+buffer, so large downloads do not go through CIPRXGET and socket buffers.
+Get/Post start request and return at once, call Loop until state is ResponseReady or Failed.
+Requires GPRS connection, bearer is opened with module APN on first request.
+Only one client per modem, it takes over OnHttpAction handler of SimcomAtCommands.
+*/
+class GsmHttpClient
+{
+	GsmModule& _module;
+	SimcomAtCommands& _gsm;
+	GsmLogger& _logger;
+	HttpClientState _state;
+	// method of request in flight, late result of earlier timed out request has other one
+	HttpMethod _method;
+	bool _isInitialized;
+	uint16_t _statusCode;
+	uint32_t _contentLength;
+	uint32_t _readOffset;
+	unsigned long _requestStart;
+	uint32_t _responseTime;
+
+	bool BeginRequest(HttpMethod method, const char* url, const char* contentType, const char* body, uint32_t bodyLength);
+	bool Initialize();
+	bool Fail(const char* reason);
+	void OnHttpActionInternal(HttpMethod method, uint16_t statusCode, uint32_t dataLength);
+public:
+	GsmHttpClient(GsmModule& module);
+	// ms to wait for +HTTPACTION result
+	uint32_t Timeout = HTTP_ACTION_TIMEOUT;
+
+	// false when request could not be started, state is Failed then
+	bool Get(const char* url);
+	bool Head(const char* url);
+	bool Post(const char* url, const char* contentType, const char* body, uint32_t length);
+	// reads modem output while waiting for response, returns current state
+	HttpClientState Loop();
+	HttpClientState GetState()
+	{
+		return _state;
+	}
+	// HTTP status, or 6xx modem error when state is Failed after request was sent
+	uint16_t GetStatusCode()
+	{
+		return _statusCode;
+	}
+	uint32_t GetContentLength()
+	{
+		return _contentLength;
+	}
+	uint32_t GetRemainingBytes()
+	{
+		return _contentLength - _readOffset;
+	}
+	// ms from HTTPACTION until modem reported result
+	uint32_t GetResponseTime()
+	{
+		return _responseTime;
+	}
+	// appends next part of body to buffer, up to its free space.
+	// Returns number of bytes read, 0 when whole body was read, -1 on error
+	int32_t Read(FixedStringBase& buffer);
+	// terminates modem HTTP session, bearer stays open
+	void End();
+};
+
+#endif
@@ -0,0 +1,332 @@
+#include "GsmModuleGroup.h"
+
+GroupSocket::GroupSocket(GsmModuleGroup& group, ProtocolType protocol):
+	_group(group),
+	_protocol(protocol),
+	_port(0),
+	_isConnectRequested(false),
+	_moduleIndex(-1),
+	_socket(nullptr),
+	_failoverCount(0),
+	_onSocketEventCtx(nullptr),
+	_onSocketEvent(nullptr),
+	_onSocketDataReceivedCtx(nullptr),
+	_onSocketDataReceived(nullptr)
+{
+}
+
+void GroupSocket::Attach(int8_t moduleIndex, GsmAsyncSocket* socket)
+{
+	_moduleIndex = moduleIndex;
+	_socket = socket;
+	_socket->OnSocketEvent(this, [](void* ctx, SocketEventType eventType)
+	{
+		reinterpret_cast<GroupSocket*>(ctx)->OnSocketEvent(eventType);
+	});
+	_socket->OnDataRecieved(this, [](void* ctx, FixedStringBase& data)
+	{
+		auto groupSocket = reinterpret_cast<GroupSocket*>(ctx);
+		if (groupSocket->_onSocketDataReceived != nullptr)
+		{
+			groupSocket->_onSocketDataReceived(groupSocket->_onSocketDataReceivedCtx, data);
+		}
+	});
+}
+
+void GroupSocket::Detach()
+{
+	if (_socket != nullptr)
+	{
+		_socket->OnSocketEvent(nullptr, nullptr);
+		_socket->OnDataRecieved(nullptr, nullptr);
+	}
+	_moduleIndex = -1;
+	_socket = nullptr;
+}
+
+void GroupSocket::OnSocketEvent(SocketEventType eventType)
+{
+	if (_onSocketEvent != nullptr)
+	{
+		_onSocketEvent(_onSocketEventCtx, eventType);
+	}
+	if (eventType != SocketEventType::Disconnected && eventType != SocketEventType::ConnectFailed)
+	{
+		return;
+	}
+	if (_group.IsModuleUsable(_moduleIndex))
+	{
+		// closed by remote side or by user, module is fine so there is nothing to fail over
+		_isConnectRequested = false;
+		_group.Release(*this);
+	}
+	// otherwise module went down, GsmModuleGroup::Loop moves socket to another module
+}
+
+void GroupSocket::OnSocketEvent(void* ctx, SocketEventHandler socketEventHandler)
+{
+	_onSocketEvent = socketEventHandler;
+	_onSocketEventCtx = ctx;
+}
+
+void GroupSocket::OnDataRecieved(void* ctx, SocketDataReceivedHandler onSocketDataReceived)
+{
+	_onSocketDataReceived = onSocketDataReceived;
+	_onSocketDataReceivedCtx = ctx;
+}
+
+SocketStateType GroupSocket::GetState()
+{
+	if (_socket == nullptr)
+	{
+		return _isConnectRequested ? SocketStateType::Connecting : SocketStateType::Closed;
+	}
+	return _socket->GetState();
+}
+
+bool GroupSocket::IsConnected()
+{
+	return GetState() == SocketStateType::Connected;
+}
+
+bool GroupSocket::BeginConnect(const char* host, uint16_t port)
+{
+	if (_isConnectRequested || strlen(host) > SOCKET_MAX_HOST_LENGTH)
+	{
+		return false;
+	}
+	_host.clear();
+	_host.append(host);
+	_port = port;
+	_isConnectRequested = true;
+	// when no module is connected yet socket is placed later by Loop()
+	_group.Place(*this);
+	return true;
+}
+
+bool GroupSocket::Close()
+{
+	_isConnectRequested = false;
+	if (_socket == nullptr)
+	{
+		return true;
+	}
+	return _socket->Close();
+}
+
+size_t GroupSocket::space()
+{
+	return _socket == nullptr ? 0 : _socket->space();
+}
+
+int16_t GroupSocket::Send(FixedStringBase& data)
+{
+	return _socket == nullptr ? 0 : _socket->Send(data);
+}
+
+int16_t GroupSocket::Send(const char* data, uint16_t length)
+{
+	return _socket == nullptr ? 0 : _socket->Send(data, length);
+}
+
+int16_t GroupSocket::Send(const char* data)
+{
+	return _socket == nullptr ? 0 : _socket->Send(data);
+}
+
+GsmModuleGroup::GsmModuleGroup(GsmLogger& logger):
+	_logger(logger),
+	_modules{ nullptr },
+	_moduleCount(0),
+	_sockets{ { nullptr } },
+	_owners{ { nullptr } },
+	_groupSockets{ nullptr },
+	_groupSocketCount(0)
+{
+}
+
+bool GsmModuleGroup::AddModule(GsmModule& module)
+{
+	if (_moduleCount >= MaxGroupModules)
+	{
+		_logger.Error(GsmLogCategory::Socket, F("Module group is full"));
+		return false;
+	}
+	_modules[_moduleCount++] = &module;
+	return true;
+}
+
+uint8_t GsmModuleGroup::GetConnectedModuleCount()
+{
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < _moduleCount; i++)
+	{
+		if (IsModuleUsable(i))
+		{
+			count++;
+		}
+	}
+	return count;
+}
+
+GroupSocket* GsmModuleGroup::CreateSocket(ProtocolType protocolType)
+{
+	if (_groupSocketCount >= MaxGroupSockets)
+	{
+		_logger.Error(GsmLogCategory::Socket, F("Too many group sockets"));
+		return nullptr;
+	}
+	auto groupSocket = new GroupSocket(*this, protocolType);
+	_groupSockets[_groupSocketCount++] = groupSocket;
+	return groupSocket;
+}
+
+bool GsmModuleGroup::IsModuleUsable(uint8_t moduleIndex)
+{
+	return moduleIndex < _moduleCount && _modules[moduleIndex]->GetState() == GsmState::ConnectedToGprs;
+}
+
+uint8_t GsmModuleGroup::GetModuleLoad(uint8_t moduleIndex)
+{
+	uint8_t load = 0;
+	for (int mux = 0; mux < SocketCount; mux++)
+	{
+		if (_owners[moduleIndex][mux] != nullptr)
+		{
+			load++;
+		}
+	}
+	return load;
+}
+
+int8_t GsmModuleGroup::FindBestModule()
+{
+	int8_t bestModule = -1;
+	uint8_t bestLoad = 0;
+	int16_t bestSignal = 0;
+	for (uint8_t i = 0; i < _moduleCount; i++)
+	{
+		if (!IsModuleUsable(i))
+		{
+			continue;
+		}
+		const auto load = GetModuleLoad(i);
+		if (load >= SocketCount)
+		{
+			continue;
+		}
+		// 99 means signal quality is not known
+		const auto signal = _modules[i]->signalQuality == 99 ? 0 : _modules[i]->signalQuality;
+		if (bestModule == -1 || load < bestLoad || (load == bestLoad && signal > bestSignal))
+		{
+			bestModule = i;
+			bestLoad = load;
+			bestSignal = signal;
+		}
+	}
+	return bestModule;
+}
+
+int8_t GsmModuleGroup::FindFreeMux(uint8_t moduleIndex, ProtocolType protocol)
+{
+	int8_t emptyMux = -1;
+	for (int8_t mux = 0; mux < SocketCount; mux++)
+	{
+		if (_owners[moduleIndex][mux] != nullptr)
+		{
+			continue;
+		}
+		auto socket = _sockets[moduleIndex][mux];
+		// prefer reusing socket created earlier, protocol is fixed at creation
+		if (socket != nullptr && socket->GetProtocol() == protocol && socket->IsClosed())
+		{
+			return mux;
+		}
+		if (socket == nullptr && emptyMux == -1)
+		{
+			emptyMux = mux;
+		}
+	}
+	return emptyMux;
+}
+
+bool GsmModuleGroup::Place(GroupSocket& groupSocket)
+{
+	const auto moduleIndex = FindBestModule();
+	if (moduleIndex == -1)
+	{
+		return false;
+	}
+	const auto mux = FindFreeMux(moduleIndex, groupSocket._protocol);
+	if (mux == -1)
+	{
+		_logger.Warning(GsmLogCategory::Socket, F("No free mux on module %d"), moduleIndex);
+		return false;
+	}
+	auto socket = _sockets[moduleIndex][mux];
+	if (socket == nullptr)
+	{
+		socket = _modules[moduleIndex]->CreateSocket(mux, groupSocket._protocol);
+		if (socket == nullptr)
+		{
+			return false;
+		}
+		_sockets[moduleIndex][mux] = socket;
+	}
+	_owners[moduleIndex][mux] = &groupSocket;
+	groupSocket.Attach(moduleIndex, socket);
+	_logger.Info(GsmLogCategory::Socket, F("Group socket placed on module %d, mux %d"), moduleIndex, mux);
+
+	if (!socket->BeginConnect(groupSocket._host.c_str(), groupSocket._port))
+	{
+		// ConnectFailed event already released the slot if module is still usable
+		return false;
+	}
+	return true;
+}
+
+void GsmModuleGroup::Release(GroupSocket& groupSocket)
+{
+	if (groupSocket._moduleIndex == -1)
+	{
+		return;
+	}
+	for (int mux = 0; mux < SocketCount; mux++)
+	{
+		if (_owners[groupSocket._moduleIndex][mux] == &groupSocket)
+		{
+			_owners[groupSocket._moduleIndex][mux] = nullptr;
+		}
+	}
+	groupSocket.Detach();
+}
+
+void GsmModuleGroup::CheckPlacements()
+{
+	for (uint8_t i = 0; i < _groupSocketCount; i++)
+	{
+		auto groupSocket = _groupSockets[i];
+		if (groupSocket->_moduleIndex != -1 && !IsModuleUsable(groupSocket->_moduleIndex))
+		{
+			_logger.Warning(GsmLogCategory::Socket, F("Module %d lost GPRS, moving socket"), groupSocket->_moduleIndex);
+			Release(*groupSocket);
+			if (groupSocket->_isConnectRequested)
+			{
+				groupSocket->_failoverCount++;
+			}
+		}
+		if (groupSocket->_isConnectRequested && groupSocket->_socket == nullptr)
+		{
+			Place(*groupSocket);
+		}
+	}
+}
+
+void GsmModuleGroup::Loop()
+{
+	for (uint8_t i = 0; i < _moduleCount; i++)
+	{
+		_modules[i]->Loop();
+	}
+	CheckPlacements();
+}
@@ -0,0 +1,111 @@
+#ifndef _GSM_MODULE_GROUP_H
+#define _GSM_MODULE_GROUP_H
+
+#include "GsmAsyncSocket.h"
+#include "SocketManager.h"
+#include "../GsmModule.h"
+#include "../GsmLogger.h"
+#include <FixedString.h>
+
+const int MaxGroupModules = 4;
+const int MaxGroupSockets = MaxGroupModules * SocketCount;
+
+class GsmModuleGroup;
+
+/*
+Socket that is not bound to a single modem. GsmModuleGroup places it on a mux of
+one of its modules and moves it to another module when that one loses GPRS.
+Data buffered on lost module is dropped, socket raises Disconnected and then
+ConnectBegin/ConnectSuccess again after it is placed on another module.
+*/
+class GroupSocket
+{
+	friend class GsmModuleGroup;
+
+	GsmModuleGroup& _group;
+	ProtocolType _protocol;
+	FixedString<SOCKET_MAX_HOST_LENGTH> _host;
+	uint16_t _port;
+	// user wants socket connected, group keeps placing it until Close() is called
+	bool _isConnectRequested;
+	int8_t _moduleIndex;
+	GsmAsyncSocket* _socket;
+	uint8_t _failoverCount;
+
+	void* _onSocketEventCtx;
+	SocketEventHandler _onSocketEvent;
+	void* _onSocketDataReceivedCtx;
+	SocketDataReceivedHandler _onSocketDataReceived;
+
+	void Attach(int8_t moduleIndex, GsmAsyncSocket* socket);
+	void Detach();
+	void OnSocketEvent(SocketEventType eventType);
+public:
+	GroupSocket(GsmModuleGroup& group, ProtocolType protocol);
+	void OnSocketEvent(void *ctx, SocketEventHandler socketEventHandler);
+	void OnDataRecieved(void *ctx, SocketDataReceivedHandler onSocketDataReceived);
+	SocketStateType GetState();
+	bool IsConnected();
+	bool IsPlaced()
+	{
+		return _socket != nullptr;
+	}
+	// index of module socket is placed on, -1 if not placed
+	int8_t GetModuleIndex()
+	{
+		return _moduleIndex;
+	}
+	uint8_t GetFailoverCount()
+	{
+		return _failoverCount;
+	}
+	bool BeginConnect(const char* host, uint16_t port);
+	bool Close();
+	size_t space();
+	int16_t Send(FixedStringBase& data);
+	int16_t Send(const char* data, uint16_t length);
+	int16_t Send(const char* data);
+};
+
+/*
+Spreads sockets over several modems to aggregate their GPRS bandwidth.
+New sockets go to connected module with the least sockets, signal quality breaks ties.
+*/
+class GsmModuleGroup
+{
+	friend class GroupSocket;
+
+	GsmLogger& _logger;
+	GsmModule* _modules[MaxGroupModules];
+	uint8_t _moduleCount;
+	GsmAsyncSocket* _sockets[MaxGroupModules][SocketCount];
+	GroupSocket* _owners[MaxGroupModules][SocketCount];
+	GroupSocket* _groupSockets[MaxGroupSockets];
+	uint8_t _groupSocketCount;
+
+	bool IsModuleUsable(uint8_t moduleIndex);
+	uint8_t GetModuleLoad(uint8_t moduleIndex);
+	int8_t FindBestModule();
+	int8_t FindFreeMux(uint8_t moduleIndex, ProtocolType protocol);
+	bool Place(GroupSocket& groupSocket);
+	void Release(GroupSocket& groupSocket);
+	void CheckPlacements();
+public:
+	GsmModuleGroup(GsmLogger& logger);
+	bool AddModule(GsmModule& module);
+	uint8_t GetModuleCount()
+	{
+		return _moduleCount;
+	}
+	GsmModule& GetModule(uint8_t moduleIndex)
+	{
+		return *_modules[moduleIndex];
+	}
+	uint8_t GetConnectedModuleCount();
+	GroupSocket* CreateSocket(ProtocolType protocolType);
+	// runs Loop() of every module, moves sockets away from modules that lost GPRS
+	// modules should have SleepEnabled off, sleeping one would stall the others
+	void Loop();
+};
+
+#endif
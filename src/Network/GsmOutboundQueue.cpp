@@ -0,0 +1,119 @@
+#include "GsmOutboundQueue.h"
+#include <Arduino.h>
+
+GsmOutboundQueue::GsmOutboundQueue(OutboundQueueStorage& storage):
+	_storage(storage),
+	_sendOffset(0),
+	_connectionStart(0),
+	_rejectedBytes(0),
+	_replays(0),
+	_lastAckQuery(0)
+{
+}
+
+uint16_t GsmOutboundQueue::Write(const char* data, uint16_t length)
+{
+	// storage is written only by Flush from module loop, so send path never touches flash
+	uint16_t accepted = length;
+	if (accepted > _staging.freeBytes())
+	{
+		accepted = _staging.freeBytes();
+	}
+	_staging.append(data, accepted);
+	_rejectedBytes += length - accepted;
+	return accepted;
+}
+
+bool GsmOutboundQueue::Flush()
+{
+	if (_staging.length() == 0)
+	{
+		return true;
+	}
+	const auto stored = _storage.Append(_staging.c_str(), _staging.length());
+	if (stored == _staging.length())
+	{
+		_staging.clear();
+		return true;
+	}
+	// keep what did not fit, it is retried on next flush
+	FixedString<OutboundQueueStagingSize> rest;
+	rest.append(_staging.c_str() + stored, _staging.length() - stored);
+	_staging.clear();
+	_staging.append(rest.c_str(), rest.length());
+	return false;
+}
+
+void GsmOutboundQueue::Acknowledge(uint32_t length)
+{
+	auto offset = _storage.Head() + length;
+	if (offset > SendOffset())
+	{
+		offset = SendOffset();
+	}
+	_storage.Trim(offset);
+}
+
+void GsmOutboundQueue::BeginConnection()
+{
+	if (_storage.Head() < _sendOffset)
+	{
+		_replays++;
+	}
+	_sendOffset = _storage.Head();
+	_connectionStart = _sendOffset;
+	_lastAckQuery = millis();
+}
+
+uint16_t GsmOutboundQueue::PeekUnsent(FixedStringBase& target)
+{
+	char buffer[128];
+	auto offset = SendOffset();
+	uint16_t total = 0;
+	while (target.freeBytes() > 0 && offset < _storage.Tail())
+	{
+		uint16_t length = target.freeBytes() < sizeof(buffer) ? target.freeBytes() : sizeof(buffer);
+		length = _storage.Read(offset, buffer, length);
+		if (length == 0)
+		{
+			break;
+		}
+		target.append(buffer, length);
+		offset += length;
+		total += length;
+	}
+	return total;
+}
+
+void GsmOutboundQueue::MarkSent(uint16_t length)
+{
+	_sendOffset = SendOffset() + length;
+}
+
+bool GsmOutboundQueue::IsAckQueryDue()
+{
+	if (AckMode != QueueAckMode::Transport || UnacknowledgedBytes() == 0)
+	{
+		return false;
+	}
+	if (millis() - _lastAckQuery < AckInterval)
+	{
+		return false;
+	}
+	_lastAckQuery = millis();
+	return true;
+}
+
+void GsmOutboundQueue::OnTransportAck(uint32_t ackedBytes)
+{
+	if (AckMode != QueueAckMode::Transport)
+	{
+		return;
+	}
+	auto offset = _connectionStart + ackedBytes;
+	if (offset > SendOffset())
+	{
+		offset = SendOffset();
+	}
+	_storage.Trim(offset);
+}
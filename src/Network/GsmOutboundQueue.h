@@ -0,0 +1,90 @@
+#ifndef _GSM_OUTBOUND_QUEUE_H
+#define _GSM_OUTBOUND_QUEUE_H
+
+#include <FixedString.h>
+#include "OutboundQueueStorage.h"
+#include "../GsmLibConstants.h"
+
+const uint16_t OutboundQueueStagingSize = 512;
+
+enum class QueueAckMode : uint8_t
+{
+	// trimmed by bytes remote TCP acknowledged to modem (AT+CIPACK), UDP is trimmed once sent
+	Transport,
+	// trimmed only by Acknowledge, for protocols with their own delivery receipts
+	Application
+};
+
+/*
+Store and forward queue behind GsmAsyncSocket, attach it with SetOutboundQueue.
+Send only copies data into RAM staging buffer, staging is moved to storage from
+GsmModule loop. Data stays in storage until acknowledged, every new connection
+replays everything unacknowledged in batches limited by socket send buffer.
+*/
+class GsmOutboundQueue
+{
+	OutboundQueueStorage& _storage;
+	FixedString<OutboundQueueStagingSize> _staging;
+	// next byte handed to modem in current connection
+	uint64_t _sendOffset;
+	// storage offset of first byte sent in current connection, base for CIPACK counters
+	uint64_t _connectionStart;
+	uint64_t _rejectedBytes;
+	uint32_t _replays;
+	unsigned long _lastAckQuery;
+
+	// storage may recover its head only after queue was constructed
+	uint64_t SendOffset()
+	{
+		return _sendOffset > _storage.Head() ? _sendOffset : _storage.Head();
+	}
+public:
+	GsmOutboundQueue(OutboundQueueStorage& storage);
+	QueueAckMode AckMode = QueueAckMode::Transport;
+	// ms between AT+CIPACK queries while data is waiting for acknowledgement
+	uint32_t AckInterval = OUTBOUND_QUEUE_ACK_INTERVAL;
+	// returns accepted bytes, less than length when staging is full, retry after next GsmModule loop
+	uint16_t Write(const char* data, uint16_t length);
+	// moves staged data to storage, false when storage is full
+	bool Flush();
+	// application mode, releases given number of oldest bytes
+	void Acknowledge(uint32_t length);
+	uint64_t UnsentBytes()
+	{
+		return _storage.Tail() - SendOffset();
+	}
+	uint64_t UnacknowledgedBytes()
+	{
+		return SendOffset() - _storage.Head();
+	}
+	uint16_t StagedBytes()
+	{
+		return _staging.length();
+	}
+	// stored and staged bytes
+	uint64_t Size()
+	{
+		return _storage.Size() + _staging.length();
+	}
+	// bytes Write could not accept because staging was full
+	uint64_t GetRejectedBytes()
+	{
+		return _rejectedBytes;
+	}
+	// connections that started with unacknowledged data
+	uint32_t GetReplays()
+	{
+		return _replays;
+	}
+
+	// used by GsmAsyncSocket
+	void BeginConnection();
+	// appends up to target free space of unsent data, does not consume it
+	uint16_t PeekUnsent(FixedStringBase& target);
+	void MarkSent(uint16_t length);
+	bool IsAckQueryDue();
+	// ackedBytes counts from start of current connection
+	void OnTransportAck(uint32_t ackedBytes);
+};
+
+#endif
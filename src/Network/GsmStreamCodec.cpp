@@ -0,0 +1,179 @@
+#include "GsmStreamCodec.h"
+#include <string.h>
+
+static void AppendLiterals(const uint8_t* literals, uint8_t count, FixedStringBase& output)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	output.append(static_cast<char>(count - 1));
+	output.append(reinterpret_cast<const char*>(literals), count);
+}
+
+LzEncoder::LzEncoder()
+{
+	Reset();
+}
+
+void LzEncoder::Reset()
+{
+	_position = 0;
+	memset(_hashHeads, 0, sizeof(_hashHeads));
+}
+
+uint8_t LzEncoder::Hash(const uint8_t* data)
+{
+	return (data[0] * 33 + data[1] * 7 + data[2]) & (LzHashSize - 1);
+}
+
+void LzEncoder::Remember(uint8_t c)
+{
+	_window[_position % LzWindowSize] = c;
+	_position++;
+}
+
+void LzEncoder::Compress(const char* data, uint16_t length, FixedStringBase& output)
+{
+	const auto input = reinterpret_cast<const uint8_t*>(data);
+	uint8_t literals[LzMaxLiteralRun];
+	uint8_t literalCount = 0;
+	uint16_t i = 0;
+	while (i < length)
+	{
+		uint8_t matchLength = 0;
+		uint16_t distance = 0;
+		if (length - i >= LzMinMatch)
+		{
+			// hash only keeps 16 bits of position, bytes are compared anyway
+			distance = static_cast<uint16_t>(_position) - _hashHeads[Hash(input + i)];
+			if (distance >= 1 && distance <= LzWindowSize && distance <= _position)
+			{
+				uint16_t maxLength = length - i;
+				if (maxLength > LzMaxMatch)
+				{
+					maxLength = LzMaxMatch;
+				}
+				// source must already be in window
+				if (maxLength > distance)
+				{
+					maxLength = distance;
+				}
+				while (matchLength < maxLength &&
+					_window[(_position - distance + matchLength) % LzWindowSize] == input[i + matchLength])
+				{
+					matchLength++;
+				}
+			}
+		}
+		if (matchLength < LzMinMatch)
+		{
+			matchLength = 0;
+		}
+		else
+		{
+			AppendLiterals(literals, literalCount, output);
+			literalCount = 0;
+			const uint16_t encodedDistance = distance - 1;
+			output.append(static_cast<char>(0x80 | (matchLength - LzMinMatch) << 2 | encodedDistance >> 8));
+			output.append(static_cast<char>(encodedDistance & 0xFF));
+		}
+		const uint8_t consumed = matchLength == 0 ? 1 : matchLength;
+		for (uint8_t k = 0; k < consumed; k++, i++)
+		{
+			if (length - i >= LzMinMatch)
+			{
+				_hashHeads[Hash(input + i)] = static_cast<uint16_t>(_position);
+			}
+			if (matchLength == 0)
+			{
+				literals[literalCount++] = input[i];
+				if (literalCount == LzMaxLiteralRun)
+				{
+					AppendLiterals(literals, literalCount, output);
+					literalCount = 0;
+				}
+			}
+			Remember(input[i]);
+		}
+	}
+	AppendLiterals(literals, literalCount, output);
+}
+
+LzDecoder::LzDecoder()
+{
+	Reset();
+}
+
+void LzDecoder::Reset()
+{
+	_position = 0;
+	_state = DecoderState::Token;
+	_remaining = 0;
+	_matchLength = 0;
+	_matchDistanceHigh = 0;
+	_isCorrupted = false;
+}
+
+void LzDecoder::Emit(uint8_t c, FixedStringBase& chunk, void* ctx, LzDecodedDataHandler handler)
+{
+	_window[_position % LzWindowSize] = c;
+	_position++;
+	chunk.append(static_cast<char>(c));
+	if (chunk.freeBytes() == 0)
+	{
+		handler(ctx, chunk);
+		chunk.clear();
+	}
+}
+
+void LzDecoder::Decompress(const char* data, uint16_t length, void* ctx, LzDecodedDataHandler handler)
+{
+	FixedString256 chunk;
+	for (uint16_t i = 0; i < length && !_isCorrupted; i++)
+	{
+		const auto c = static_cast<uint8_t>(data[i]);
+		switch (_state)
+		{
+		case DecoderState::Token:
+			if ((c & 0x80) == 0)
+			{
+				_remaining = c + 1;
+				_state = DecoderState::Literal;
+			}
+			else
+			{
+				_matchLength = ((c >> 2) & 0x1F) + LzMinMatch;
+				_matchDistanceHigh = (c & 0x03) << 8;
+				_state = DecoderState::MatchDistance;
+			}
+			break;
+		case DecoderState::Literal:
+			Emit(c, chunk, ctx, handler);
+			if (--_remaining == 0)
+			{
+				_state = DecoderState::Token;
+			}
+			break;
+		case DecoderState::MatchDistance:
+		{
+			const uint16_t distance = (_matchDistanceHigh | c) + 1;
+			if (distance > _position)
+			{
+				_isCorrupted = true;
+				break;
+			}
+			for (uint8_t k = 0; k < _matchLength; k++)
+			{
+				Emit(_window[(_position - distance) % LzWindowSize], chunk, ctx, handler);
+			}
+			_state = DecoderState::Token;
+			break;
+		}
+		}
+	}
+	if (chunk.length() > 0)
+	{
+		handler(ctx, chunk);
+	}
+}
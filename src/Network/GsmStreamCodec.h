@@ -0,0 +1,75 @@
+#ifndef _GSM_STREAM_CODEC_H
+#define _GSM_STREAM_CODEC_H
+
+#include <inttypes.h>
+#include <FixedString.h>
+
+/*
+Byte aligned LZ77 stream format, every token is complete on its own so stream can be
+flushed after any Send without padding:
+  0LLLLLLL                 literal run, L+1 raw bytes follow (1..128)
+  1LLLLLOO OOOOOOOO        match, copy L+3 bytes (3..34) from distance O+1 (1..1024)
+Window is shared by consecutive Sends, so keys repeated between telemetry messages
+are matched too. Both sides reset state for every new connection.
+*/
+const uint16_t LzWindowSize = 1024;
+const uint8_t LzMinMatch = 3;
+const uint8_t LzMaxMatch = 34;
+const uint8_t LzMaxLiteralRun = 128;
+const uint16_t LzHashSize = 256;
+
+// output length never exceeds this for given input length
+constexpr uint16_t LzMaxCompressedLength(uint16_t length)
+{
+	return length + length / LzMaxLiteralRun + 1;
+}
+
+class LzEncoder
+{
+	uint8_t _window[LzWindowSize];
+	// low 16 bits of stream position where 3 byte prefix with given hash was last seen
+	uint16_t _hashHeads[LzHashSize];
+	uint32_t _position;
+
+	void Remember(uint8_t c);
+	static uint8_t Hash(const uint8_t* data);
+public:
+	LzEncoder();
+	void Reset();
+	// appends compressed data to output, caller makes room for LzMaxCompressedLength(length)
+	void Compress(const char* data, uint16_t length, FixedStringBase& output);
+};
+
+typedef void(*LzDecodedDataHandler)(void* ctx, FixedStringBase& data);
+
+class LzDecoder
+{
+	enum class DecoderState : uint8_t
+	{
+		Token,
+		Literal,
+		MatchDistance
+	};
+
+	uint8_t _window[LzWindowSize];
+	uint32_t _position;
+	DecoderState _state;
+	uint8_t _remaining;
+	uint8_t _matchLength;
+	uint16_t _matchDistanceHigh;
+	bool _isCorrupted;
+
+	void Emit(uint8_t c, FixedStringBase& chunk, void* ctx, LzDecodedDataHandler handler);
+public:
+	LzDecoder();
+	void Reset();
+	// decoded data is passed to handler in chunks, tokens may be split between calls
+	void Decompress(const char* data, uint16_t length, void* ctx, LzDecodedDataHandler handler);
+	// match pointed before start of stream, decoder ignores input until Reset
+	bool IsCorrupted()
+	{
+		return _isCorrupted;
+	}
+};
+
+#endif
@@ -0,0 +1,332 @@
+#include "GsmTransparentSocket.h"
+#include "../GsmLibHelpers.h"
+
+static const char TransparentCloseSequence[] = "\r\nCLOSED\r\n";
+static const uint8_t TransparentCloseSequenceLength = sizeof(TransparentCloseSequence) - 1;
+
+GsmTransparentSocket::GsmTransparentSocket(SimcomAtCommands& gsm, GsmLogger& logger, ProtocolType protocol):
+	_logger(logger),
+	_gsm(gsm),
+	_protocol(protocol),
+	_state(SocketStateType::Closed),
+	_isNetworkAvailable(false),
+	_isInDataMode(false),
+	_isWaitingForConnect(false),
+	_closeMatch(0),
+	_connectStart(0),
+	_lastWrite(0),
+	_receivedBytes(0),
+	_sentBytes(0),
+	_onSocketEventCtx(nullptr),
+	_onSocketEvent(nullptr),
+	_onSocketDataReceivedCtx(nullptr),
+	_onSocketDataReceived(nullptr)
+{
+}
+
+void GsmTransparentSocket::RaiseEvent(SocketEventType eventType)
+{
+	switch (eventType)
+	{
+	case SocketEventType::ConnectBegin: _state = SocketStateType::Connecting; break;
+	case SocketEventType::ConnectSuccess: _state = SocketStateType::Connected; break;
+	case SocketEventType::Disconnecting: _state = SocketStateType::Closing; break;
+	case SocketEventType::ConnectFailed:
+	case SocketEventType::Disconnected:
+		_state = SocketStateType::Closed;
+		_isInDataMode = false;
+		_isWaitingForConnect = false;
+		break;
+	}
+	_logger.Info(GsmLogCategory::Socket, F("Transparent socket event: %s"), SocketEventTypeToStr(eventType));
+	if (_onSocketEvent != nullptr)
+	{
+		_onSocketEvent(_onSocketEventCtx, eventType);
+	}
+}
+
+void GsmTransparentSocket::SetIsNetworkAvailable(bool isNetworkAvailable)
+{
+	_isNetworkAvailable = isNetworkAvailable;
+	if (!_isNetworkAvailable && _state != SocketStateType::Closed)
+	{
+		RaiseEvent(SocketEventType::Disconnected);
+	}
+}
+
+void GsmTransparentSocket::OnSocketEvent(void* ctx, SocketEventHandler socketEventHandler)
+{
+	_onSocketEvent = socketEventHandler;
+	_onSocketEventCtx = ctx;
+}
+
+void GsmTransparentSocket::OnDataRecieved(void* ctx, SocketDataReceivedHandler onSocketDataReceived)
+{
+	_onSocketDataReceived = onSocketDataReceived;
+	_onSocketDataReceivedCtx = ctx;
+}
+
+bool GsmTransparentSocket::BeginConnect(const char* host, uint16_t port)
+{
+	if (!_isNetworkAvailable || _state != SocketStateType::Closed)
+	{
+		return false;
+	}
+	RaiseEvent(SocketEventType::ConnectBegin);
+	if (_gsm.BeginTransparentConnect(_protocol, host, port) != AtResultType::Success)
+	{
+		RaiseEvent(SocketEventType::ConnectFailed);
+		return false;
+	}
+	_receivedBytes = 0;
+	_sentBytes = 0;
+	_line.clear();
+	_connectStart = millis();
+	_isWaitingForConnect = true;
+	return true;
+}
+
+void GsmTransparentSocket::Poll()
+{
+	if (_isWaitingForConnect)
+	{
+		ReadConnectResponse();
+		return;
+	}
+	if (_isInDataMode)
+	{
+		ReadIncomingData();
+	}
+}
+
+void GsmTransparentSocket::ReadConnectResponse()
+{
+	int c;
+	while (_isWaitingForConnect && (c = _gsm.ReadData()) != -1)
+	{
+		if (c == '\n')
+		{
+			ProcessConnectLine();
+			_line.clear();
+		}
+		else if (c != '\r')
+		{
+			_line.append(static_cast<char>(c));
+		}
+	}
+	if (_isWaitingForConnect && millis() - _connectStart > TRANSPARENT_CONNECT_TIMEOUT)
+	{
+		_logger.Warning(GsmLogCategory::Socket, F("Transparent connect timeout"));
+		_isWaitingForConnect = false;
+		_gsm.CloseTransparentConnection();
+		RaiseEvent(SocketEventType::ConnectFailed);
+	}
+}
+
+void GsmTransparentSocket::ProcessConnectLine()
+{
+	if (_line.length() == 0)
+	{
+		return;
+	}
+	_logger.LogAt(F(" <= %s"), _line.c_str());
+	if (_line.equals(F("CONNECT")))
+	{
+		_isWaitingForConnect = false;
+		_isInDataMode = true;
+		_closeMatch = 0;
+		_lastWrite = millis();
+		if (_state == SocketStateType::Connecting)
+		{
+			RaiseEvent(SocketEventType::ConnectSuccess);
+		}
+		return;
+	}
+	if (_line.startsWith(F("CONNECT FAIL")) || _line.equals(F("ERROR")) ||
+		_line.equals(F("CLOSED")) || _line.equals(F("NO CARRIER")))
+	{
+		RaiseEvent(_state == SocketStateType::Connecting ? SocketEventType::ConnectFailed : SocketEventType::Disconnected);
+	}
+	// echo, OK and other lines are ignored
+}
+
+void GsmTransparentSocket::FlushData(FixedStringBase& chunk)
+{
+	if (chunk.length() == 0)
+	{
+		return;
+	}
+	_receivedBytes += chunk.length();
+	if (_onSocketDataReceived != nullptr)
+	{
+		_onSocketDataReceived(_onSocketDataReceivedCtx, chunk);
+	}
+	chunk.clear();
+}
+
+void GsmTransparentSocket::ReadIncomingData()
+{
+	FixedString256 chunk;
+	int c;
+	while (_isInDataMode && (c = _gsm.ReadData()) != -1)
+	{
+		if (c == TransparentCloseSequence[_closeMatch])
+		{
+			_closeMatch++;
+			if (_closeMatch == TransparentCloseSequenceLength)
+			{
+				FlushData(chunk);
+				_closeMatch = 0;
+				_logger.Info(GsmLogCategory::Socket, F("Transparent connection closed by remote"));
+				RaiseEvent(SocketEventType::Disconnected);
+				return;
+			}
+			continue;
+		}
+		if (_closeMatch > 0)
+		{
+			// held back characters turned out to be data
+			if (chunk.freeBytes() < _closeMatch)
+			{
+				FlushData(chunk);
+			}
+			chunk.append(TransparentCloseSequence, _closeMatch);
+			_closeMatch = 0;
+			if (c == TransparentCloseSequence[0])
+			{
+				_closeMatch = 1;
+				continue;
+			}
+		}
+		if (chunk.freeBytes() == 0)
+		{
+			FlushData(chunk);
+		}
+		chunk.append(static_cast<char>(c));
+	}
+	FlushData(chunk);
+}
+
+bool GsmTransparentSocket::WaitForOkLine(uint32_t timeout)
+{
+	_line.clear();
+	const auto start = millis();
+	while (millis() - start < timeout)
+	{
+		const auto c = _gsm.ReadData();
+		if (c == -1)
+		{
+			continue;
+		}
+		if (c != '\n')
+		{
+			if (c != '\r')
+			{
+				_line.append(static_cast<char>(c));
+			}
+			continue;
+		}
+		if (_line.equals(F("OK")))
+		{
+			return true;
+		}
+		if (_line.equals(F("CLOSED")))
+		{
+			RaiseEvent(SocketEventType::Disconnected);
+			return true;
+		}
+		_line.clear();
+	}
+	return false;
+}
+
+bool GsmTransparentSocket::EnterCommandMode()
+{
+	if (!_isInDataMode)
+	{
+		return true;
+	}
+	// +++ is only recognized when surrounded by silence
+	while (millis() - _lastWrite < TRANSPARENT_ESCAPE_GUARD)
+	{
+		ReadIncomingData();
+	}
+	_gsm.WriteData("+++", 3);
+	const auto escapeStart = millis();
+	// data that was already in flight still arrives during guard time
+	while (_isInDataMode && millis() - escapeStart < TRANSPARENT_ESCAPE_GUARD - 100)
+	{
+		ReadIncomingData();
+	}
+	if (!_isInDataMode)
+	{
+		// closed while escaping
+		return true;
+	}
+	_isInDataMode = false;
+	if (!WaitForOkLine(TRANSPARENT_ESCAPE_GUARD))
+	{
+		_logger.Warning(GsmLogCategory::Socket, F("No OK after +++"));
+		_isInDataMode = true;
+		_lastWrite = millis();
+		return false;
+	}
+	_logger.Info(GsmLogCategory::Socket, F("Transparent socket in command mode"));
+	return true;
+}
+
+bool GsmTransparentSocket::ResumeDataMode()
+{
+	if (_isInDataMode || _state != SocketStateType::Connected)
+	{
+		return false;
+	}
+	_line.clear();
+	_connectStart = millis();
+	_isWaitingForConnect = true;
+	_gsm.BeginResumeDataMode();
+	return true;
+}
+
+bool GsmTransparentSocket::Close()
+{
+	if (_state == SocketStateType::Closed)
+	{
+		return true;
+	}
+	if (_isInDataMode && !EnterCommandMode())
+	{
+		return false;
+	}
+	if (_state == SocketStateType::Closed)
+	{
+		return true;
+	}
+	_isWaitingForConnect = false;
+	RaiseEvent(SocketEventType::Disconnecting);
+	const auto result = _gsm.CloseTransparentConnection();
+	RaiseEvent(SocketEventType::Disconnected);
+	return result == AtResultType::Success;
+}
+
+int16_t GsmTransparentSocket::Send(FixedStringBase& data)
+{
+	return Send(data.c_str(), data.length());
+}
+
+int16_t GsmTransparentSocket::Send(const char* data, uint16_t length)
+{
+	if (!_isInDataMode)
+	{
+		return 0;
+	}
+	_gsm.WriteData(data, length);
+	_lastWrite = millis();
+	_sentBytes += length;
+	return length;
+}
+
+int16_t GsmTransparentSocket::Send(const char* data)
+{
+	return Send(data, strlen(data));
+}
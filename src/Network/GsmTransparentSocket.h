@@ -0,0 +1,89 @@
+#ifndef _GSM_TRANSPARENT_SOCKET_H
+#define _GSM_TRANSPARENT_SOCKET_H
+
+#include "GsmAsyncSocket.h"
+#include "../SimcomAtCommands.h"
+#include "../GsmLogger.h"
+#include <FixedString.h>
+
+/*
+Single connection in transparent mode (CIPMODE=1). While in data mode bytes go
+straight over UART without CIPSEND/CIPRXGET round trips, GsmModule sends no AT commands then.
+EnterCommandMode escapes with +++ so status can be queried, ResumeDataMode continues streaming.
+Modem reports remote close by writing CLOSED into data stream, so payload containing
+"\r\nCLOSED\r\n" can not be told apart from real close.
+*/
+class GsmTransparentSocket
+{
+	GsmLogger& _logger;
+	SimcomAtCommands& _gsm;
+	ProtocolType _protocol;
+	SocketStateType _state;
+	bool _isNetworkAvailable;
+	bool _isInDataMode;
+	// CIPSTART or ATO was sent, waiting for CONNECT line
+	bool _isWaitingForConnect;
+	FixedString32 _line;
+	// characters of close sequence held back from data
+	uint8_t _closeMatch;
+	unsigned long _connectStart;
+	unsigned long _lastWrite;
+	uint64_t _receivedBytes;
+	uint64_t _sentBytes;
+
+	void* _onSocketEventCtx;
+	SocketEventHandler _onSocketEvent;
+	void* _onSocketDataReceivedCtx;
+	SocketDataReceivedHandler _onSocketDataReceived;
+
+	void RaiseEvent(SocketEventType eventType);
+	void ProcessConnectLine();
+	void ReadConnectResponse();
+	void ReadIncomingData();
+	void FlushData(FixedStringBase& chunk);
+	bool WaitForOkLine(uint32_t timeout);
+public:
+	GsmTransparentSocket(SimcomAtCommands& gsm, GsmLogger& logger, ProtocolType protocol = ProtocolType::Tcp);
+	void SetIsNetworkAvailable(bool isNetworkAvailable);
+	// UART belongs to this socket, AT commands must not be sent
+	bool IsBusy()
+	{
+		return _isInDataMode || _isWaitingForConnect;
+	}
+	// called by GsmModule::Loop while socket is busy
+	void Poll();
+
+	SocketStateType GetState()
+	{
+		return _state;
+	}
+	bool IsConnected()
+	{
+		return _state == SocketStateType::Connected;
+	}
+	bool IsInDataMode()
+	{
+		return _isInDataMode;
+	}
+	uint64_t GetSentBytes()
+	{
+		return _sentBytes;
+	}
+	uint64_t GetReceivedBytes()
+	{
+		return _receivedBytes;
+	}
+	void OnSocketEvent(void *ctx, SocketEventHandler socketEventHandler);
+	void OnDataRecieved(void *ctx, SocketDataReceivedHandler onSocketDataReceived);
+	bool BeginConnect(const char* host, uint16_t port);
+	bool Close();
+	// blocks for about two escape guard times
+	bool EnterCommandMode();
+	bool ResumeDataMode();
+	// writes directly to UART, returns 0 when not in data mode
+	int16_t Send(FixedStringBase& data);
+	int16_t Send(const char* data, uint16_t length);
+	int16_t Send(const char* data);
+};
+
+#endif
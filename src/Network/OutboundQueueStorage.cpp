@@ -0,0 +1,68 @@
+#include "OutboundQueueStorage.h"
+#include <string.h>
+
+RamQueueStorage::RamQueueStorage(uint8_t* buffer, uint32_t capacity):
+	_buffer(buffer),
+	_capacity(capacity),
+	_head(0),
+	_tail(0)
+{
+}
+
+uint16_t RamQueueStorage::Append(const char* data, uint16_t length)
+{
+	const auto freeBytes = _capacity - static_cast<uint32_t>(_tail - _head);
+	if (length > freeBytes)
+	{
+		length = freeBytes;
+	}
+	for (uint16_t written = 0; written < length;)
+	{
+		const auto position = static_cast<uint32_t>(_tail % _capacity);
+		auto chunk = _capacity - position;
+		if (chunk > static_cast<uint32_t>(length - written))
+		{
+			chunk = length - written;
+		}
+		memcpy(_buffer + position, data + written, chunk);
+		written += chunk;
+		_tail += chunk;
+	}
+	return length;
+}
+
+uint16_t RamQueueStorage::Read(uint64_t offset, char* buffer, uint16_t length)
+{
+	if (offset < _head || offset >= _tail)
+	{
+		return 0;
+	}
+	if (length > _tail - offset)
+	{
+		length = _tail - offset;
+	}
+	for (uint16_t read = 0; read < length;)
+	{
+		const auto position = static_cast<uint32_t>((offset + read) % _capacity);
+		auto chunk = _capacity - position;
+		if (chunk > static_cast<uint32_t>(length - read))
+		{
+			chunk = length - read;
+		}
+		memcpy(buffer + read, _buffer + position, chunk);
+		read += chunk;
+	}
+	return length;
+}
+
+void RamQueueStorage::Trim(uint64_t offset)
+{
+	if (offset > _tail)
+	{
+		offset = _tail;
+	}
+	if (offset > _head)
+	{
+		_head = offset;
+	}
+}
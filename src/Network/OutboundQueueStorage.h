@@ -0,0 +1,51 @@
+#ifndef _OUTBOUND_QUEUE_STORAGE_H
+#define _OUTBOUND_QUEUE_STORAGE_H
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/*
+Append only byte log behind GsmOutboundQueue. Bytes are addressed by stream offset
+that only grows, Head is oldest byte still stored and Tail is offset after newest one.
+*/
+class OutboundQueueStorage
+{
+public:
+	virtual ~OutboundQueueStorage() {}
+	// stores as much as fits, returns number of bytes stored
+	virtual uint16_t Append(const char* data, uint16_t length) = 0;
+	// copies stored bytes starting at offset, returns number of bytes copied
+	virtual uint16_t Read(uint64_t offset, char* buffer, uint16_t length) = 0;
+	// releases everything before offset
+	virtual void Trim(uint64_t offset) = 0;
+	virtual uint64_t Head() = 0;
+	virtual uint64_t Tail() = 0;
+	uint64_t Size()
+	{
+		return Tail() - Head();
+	}
+};
+
+// ring over caller provided buffer, survives reconnects but not reboots
+class RamQueueStorage : public OutboundQueueStorage
+{
+	uint8_t* _buffer;
+	uint32_t _capacity;
+	uint64_t _head;
+	uint64_t _tail;
+public:
+	RamQueueStorage(uint8_t* buffer, uint32_t capacity);
+	uint16_t Append(const char* data, uint16_t length) override;
+	uint16_t Read(uint64_t offset, char* buffer, uint16_t length) override;
+	void Trim(uint64_t offset) override;
+	uint64_t Head() override
+	{
+		return _head;
+	}
+	uint64_t Tail() override
+	{
+		return _tail;
+	}
+};
+
+#endif
@@ -1,11 +1,13 @@
 #include "SocketManager.h"
 
 
-SocketManager::SocketManager(SimcomAtCommands &atCommands, GsmLogger& logger) :
+SocketManager::SocketManager(SimcomAtCommands &atCommands, TimerWheel& timers, GsmLogger& logger) :
 	_logger(logger),
 	_atCommands(atCommands),
+	_timers(timers),
 	_sockets{ nullptr },
-	_isNetworkAvailable(false)
+	_isNetworkAvailable(false),
+	_dnsCache(nullptr)
 {
 	atCommands.OnMuxEvent(this, [](void* ctx, uint8_t mux, FixedStringBase& eventStr)
 	{
@@ -22,7 +24,7 @@ bool SocketManager::OnMuxEvent(uint8_t mux, FixedStringBase& eventStr)
 	auto socket = _sockets[mux];
 	if (socket == nullptr)
 	{
-		_logger.Log(F("Received socket event but socket was null"));
+		_logger.Warning(GsmLogCategory::Socket, F("Received socket event but socket was null"));
 		return false;
 	}
 	return socket->OnMuxEvent(eventStr);
@@ -79,6 +81,63 @@ bool SocketManager::AnyConnectAtTimeouted()
 	return anySocketHasAtConnectTimeout;
 }
 
+bool SocketManager::CheckConnectDeadlines()
+{
+	for (int i = 0; i < SocketCount; i++)
+	{
+		auto socket = _sockets[i];
+		if (socket == nullptr)
+		{
+			continue;
+		}
+
+		if (!socket->CheckConnectDeadline())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void SocketManager::ProcessReconnects()
+{
+	for (int i = 0; i < SocketCount; i++)
+	{
+		auto socket = _sockets[i];
+		if (socket != nullptr)
+		{
+			socket->ProcessReconnect();
+		}
+	}
+}
+
+ConnectStats SocketManager::GetConnectStats()
+{
+	ConnectStats total;
+	for (int i = 0; i < SocketCount; i++)
+	{
+		auto socket = _sockets[i];
+		if (socket != nullptr)
+		{
+			total.Add(socket->GetConnectStats());
+		}
+	}
+	return total;
+}
+
+bool SocketManager::HasPendingWork()
+{
+	for (int i = 0; i < SocketCount; i++)
+	{
+		auto socket = _sockets[i];
+		if (socket != nullptr && socket->HasPendingWork())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 bool SocketManager::ReadDataFromSockets()
 {
 	for (int i = 0; i < SocketCount; i++)
@@ -113,16 +172,31 @@ GsmAsyncSocket* SocketManager::CreateSocket(uint8_t mux, ProtocolType protocolTy
 {
 	if (mux >= SocketCount)
 	{
-		_logger.Log(F("Invalid socket number: %d"), mux);
+		_logger.Error(GsmLogCategory::Socket, F("Invalid socket number: %d"), mux);
 		return nullptr;
 	}
 	if (_sockets[mux] != nullptr)
 	{
-		_logger.Log(F("Socket %d is already created"), mux);
+		_logger.Warning(GsmLogCategory::Socket, F("Socket %d is already created"), mux);
 		return nullptr;
 	}
-	auto socket = new GsmAsyncSocket(_atCommands, mux, protocolType, _logger);
+	auto socket = new GsmAsyncSocket(_atCommands, _timers, mux, protocolType, _logger);
+	socket->_dnsCache = _dnsCache;
+	// socket created after GPRS came up would otherwise never see network as available
+	socket->_isNetworkAvailable = _isNetworkAvailable;
 	_sockets[mux] = socket;
-	_logger.Log(F("Socket %d created"), mux);
+	_logger.Info(GsmLogCategory::Socket, F("Socket %d created"), mux);
 	return socket;
-}
\ No newline at end of file
+}
+void SocketManager::SetDnsCache(GsmDnsCache* dnsCache)
+{
+	_dnsCache = dnsCache;
+	for (int i = 0; i < SocketCount; i++)
+	{
+		auto socket = _sockets[i];
+		if (socket != nullptr)
+		{
+			socket->_dnsCache = dnsCache;
+		}
+	}
+}
@@ -11,19 +11,32 @@ class SocketManager
 {
 	GsmLogger &_logger;
 	SimcomAtCommands& _atCommands;
+	TimerWheel& _timers;
 	GsmAsyncSocket* _sockets[SocketCount];
 	bool _isNetworkAvailable;
+	GsmDnsCache* _dnsCache;
 	
 	bool OnMuxEvent(uint8_t mux, FixedStringBase& eventStr);
 	void OnCipstatusInfo(ConnectionInfo& connectionInfo);
 public:
-	SocketManager(SimcomAtCommands &atCommands, GsmLogger& logger);
+	// connect deadlines and reconnect backoff of sockets run on timers
+	SocketManager(SimcomAtCommands &atCommands, TimerWheel& timers, GsmLogger& logger);
 
 	bool AnyConnectAtTimeouted();
+	// aborts connect attempts past their deadline, false on AT timeout
+	bool CheckConnectDeadlines();
+	// starts reconnect attempts that are due
+	void ProcessReconnects();
+	// connect statistics of all sockets combined
+	ConnectStats GetConnectStats();
+	// true if any socket has data to send or is waiting for connect/close
+	bool HasPendingWork();
 	bool SendDataFromSockets();
 	bool ReadDataFromSockets();
 	void SetIsNetworkAvailable(bool isNetworkAvailable);
 	GsmAsyncSocket* CreateSocket(uint8_t mux, ProtocolType protocolType);
+	// sockets resolve host names through dnsCache when it is enabled
+	void SetDnsCache(GsmDnsCache* dnsCache);
 };
 
 
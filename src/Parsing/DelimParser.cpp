@@ -205,7 +205,17 @@ bool DelimParser::NextNum(int16_t& dst, bool allowNull, int base)
 	}
 	return false;
 }
-bool DelimParser::NextNum(uint16_t &dst, bool allowNull, int base)
+bool DelimParser::NextNum(uint16_t& dst, bool allowNull, int base)
+{
+	uint32_t num;
+	if (NextNum(num, allowNull, base))
+	{
+		dst = num;
+		return true;
+	}
+	return false;
+}
+bool DelimParser::NextNum(uint32_t &dst, bool allowNull, int base)
 {
 	if (!NextToken())
 	{
@@ -222,7 +232,7 @@ bool DelimParser::NextNum(uint16_t &dst, bool allowNull, int base)
 
 	dst = 0;
 
-	int x = 1;
+	uint32_t x = 1;
 	int i = tokenEnd;
 	do
 	{
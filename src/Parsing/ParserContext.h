@@ -11,8 +11,10 @@ struct ParserContext
 		Cipmux = false;
 		IsOperatorNameReturnedInImsiFormat = false;
 		IsRxManual = false;
+		CiprxGetLeftBytesToRead = 0;
 	}
 	int16_t* CsqSignalQuality;
+	// CIFSR local address, CDNSGIP resolved address, SAPBR bearer address
 	GsmIp* IpAddress;
 	FixedStringBase* OperatorName;
 	uint16_t operatorSelectionMode;
@@ -29,6 +31,7 @@ struct ParserContext
 	uint16_t CregCellId;
 	SimState SimStatus;
 	bool IsRxManual;
+	// raw data following +CIPRXGET: 2 or +HTTPREAD: header is appended here
 	FixedStringBase* CipRxGetBuffer;
 	uint16_t CiprxGetLeftBytesToRead;
 	// number of bytes that are left to be read from connection
@@ -41,8 +44,17 @@ struct ParserContext
 	uint16_t CipsendDataIndex;
 	uint16_t CipsendDataLength;
 	uint16_t *CipsendSentBytes;
+	// +CIPACK: bytes accepted by CIPSEND and bytes acknowledged by remote since connect
+	uint32_t* CipackSentBytes;
+	uint32_t* CipackAckedBytes;
 	SequenceDetector CipsendDataEchoDetector;
+	BearerStatus* Bearer;
+	uint16_t* HttpReadBytes;
+	// +FTPPUT: 2 length accepted by modem, +FTPGET: 2 length of data that follows
+	uint16_t* FtpDataLength;
+	uint32_t* FtpSize;
 	float *Temperature;
+	ModemConfiguration* ModemConfig;
 };
 
 #endif
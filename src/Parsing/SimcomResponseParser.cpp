@@ -16,6 +16,15 @@ _onMuxCipstatusInfo(nullptr),
 _onMuxCipstatusInfoCtx(nullptr),
 _onGsmModuleEvent(nullptr),
 _onGsmModuleEventCtx(nullptr),
+_onHttpAction(nullptr),
+_onHttpActionCtx(nullptr),
+_onFtpSession(nullptr),
+_onFtpSessionCtx(nullptr),
+_isRingPending(false),
+_onUssdResponse(nullptr),
+_onUssdResponseCtx(nullptr),
+_transcript(nullptr),
+_cipstatusLineIndex(0),
 commandReady(false),
 IsGarbageDetectionActive(true)
 {
@@ -57,12 +66,16 @@ void SimcomResponseParser::FeedChar(char c)
 				{
 					_parserContext.CipsendState = CipsendStateType::WaitingForDataEcho;
 					_response.clear();
-					_logger.Log(F("Writing %d b of data"), _parserContext.CipsendDataLength);
+					_logger.Debug(GsmLogCategory::Socket, F("Writing %d b of data"), _parserContext.CipsendDataLength);
 
 					auto dataPtr = _parserContext.CipsendBuffer->c_str() + _parserContext.CipsendDataIndex;
 					auto dataLength = _parserContext.CipsendDataLength;
 
 					_serial.write(dataPtr, dataLength);
+					if (_transcript != nullptr)
+					{
+						_transcript->Record(AtTranscriptDirection::ToModem, dataPtr, dataLength);
+					}
 					_parserContext.CipsendDataEchoDetector.SetSequence(dataPtr, dataLength);
 					return;
 				}
@@ -126,23 +139,28 @@ void SimcomResponseParser::FeedChar(char c)
 		// if command not parsed yet
 		else if (parseResult == ParserState::None)
 		{
+			auto lineLogLevel = GsmLogLevel::Debug;
 			if (ParsingHelpers::CheckIfLineContainsGarbage(_response))
 			{
 				if (IsGarbageDetectionActive)
 				{
 					_garbageOnSerialDetected = true;
-					_logger.Log(F(" Garbage detected(%d b): "), _response.length());
+					lineLogLevel = GsmLogLevel::Warning;
+					_logger.Warning(GsmLogCategory::Parser, F(" Garbage detected(%d b): "), _response.length());
 				}
 
 			}
 			else
 			{
-				_logger.Log(F( "Unknown response (%d b): "), _response.length());
+				_logger.Debug(GsmLogCategory::Parser, F( "Unknown response (%d b): "), _response.length());
 			}
 
-			FixedString256 printableLine;
-			BinaryToString(_response, printableLine);
-			_logger.Log(F(" '%s'"), printableLine.c_str());
+			if (_logger.IsEnabled(lineLogLevel, GsmLogCategory::Parser))
+			{
+				FixedString256 printableLine;
+				BinaryToString(_response, printableLine);
+				_logger.Log(lineLogLevel, GsmLogCategory::Parser, F(" '%s'"), printableLine.c_str());
+			}
 			// do nothing, do not change _state to none
 		}
 		else
@@ -190,37 +208,107 @@ bool SimcomResponseParser::ParseUnsolicited(FixedStringBase& line)
 	}
 	if (line.equals(F("Call Ready")))
 	{
-		_logger.Log(F("Call ready"));
+		_logger.Info(GsmLogCategory::General, F("Call ready"));
 		return true;
 	}
 	
 	if (line.equals(F("OVER-VOLTAGE WARNNING")))
 	{
-		_logger.Log(F(" Over voltage warning  !!!"));
+		_logger.Warning(GsmLogCategory::General, F(" Over voltage warning  !!!"));
 		RaiseGsmModuleEvent(GsmModuleEventType::OverVoltageWarning);
 		return true;
 	}
 	if (line.equals(F("OVER-VOLTAGE POWER DOWN")))
 	{
-		_logger.Log(F(" Over voltage power down  !!!"));
+		_logger.Error(GsmLogCategory::General, F(" Over voltage power down  !!!"));
 		RaiseGsmModuleEvent(GsmModuleEventType::OverVoltagePowerDown);
 		return true;
 	}
 	if (line.equals(F("UNDER-VOLTAGE WARNNING")))
 	{
-		_logger.Log(F(" Under voltage warning !!!"));
+		_logger.Warning(GsmLogCategory::General, F(" Under voltage warning !!!"));
 		RaiseGsmModuleEvent(GsmModuleEventType::UnderVoltageWarining);
 		return true;
 	}
 	if (line.equals(F("UNDER-VOLTAGE POWER DOWN")))
 	{
-		_logger.Log(F(" Over voltage power down  !!!"));
+		_logger.Error(GsmLogCategory::General, F(" Over voltage power down  !!!"));
 		RaiseGsmModuleEvent(GsmModuleEventType::UnderVoltagePowerDown);
 		return true;
 	}
 
 	DelimParser parser(line);
 
+	if (line.equals(F("RING")))
+	{
+		_isRingPending = true;
+		return true;
+	}
+	if (parser.StartsWith(F("+CLIP: ")))
+	{
+		// number is empty when caller id is withheld
+		FixedString32 number;
+		if (parser.NextString(number))
+		{
+			_isRingPending = true;
+			_ringCallerNumber = number;
+		}
+		return true;
+	}
+
+	// blocking SendUssdWaitResponse parses reply as part of command
+	const auto isUssdCommandPending = _currentCommand == AtCommand::Cusd && !commandReady;
+	if (!isUssdCommandPending && parser.StartsWith(F("+CUSD: ")))
+	{
+		uint8_t status;
+		FixedString<USSD_MAX_LENGTH> response;
+		if (!parser.NextNum(status))
+		{
+			return true;
+		}
+		// text is missing e.g. for status 2 and 4
+		parser.NextString(response);
+		_logger.Debug(GsmLogCategory::General, F("USSD response, status %d"), status);
+		if (_onUssdResponse != nullptr)
+		{
+			_onUssdResponse(_onUssdResponseCtx, static_cast<UssdStatus>(status), response);
+		}
+		return true;
+	}
+
+	if (parser.StartsWith(F("+HTTPACTION: ")))
+	{
+		uint8_t method;
+		uint16_t statusCode;
+		uint32_t dataLength;
+		if (parser.NextNum(method) && parser.NextNum(statusCode) && parser.NextNum(dataLength))
+		{
+			_logger.Debug(GsmLogCategory::General, F("HTTP action finished, status %d, %u b"), statusCode, dataLength);
+			if (_onHttpAction != nullptr)
+			{
+				_onHttpAction(_onHttpActionCtx, static_cast<HttpMethod>(method), statusCode, dataLength);
+			}
+		}
+		return true;
+	}
+
+	if (parser.StartsWith(F("+FTPPUT: 1,")) || parser.StartsWith(F("+FTPGET: 1,")))
+	{
+		const auto isFtpPut = line.startsWith(F("+FTPPUT"));
+		uint8_t status;
+		uint16_t maxLength = 0;
+		if (parser.NextNum(status))
+		{
+			parser.NextNum(maxLength);
+			_logger.Debug(GsmLogCategory::General, F("FTP %s session status %d"), isFtpPut ? "put" : "get", status);
+			if (_onFtpSession != nullptr)
+			{
+				_onFtpSession(_onFtpSessionCtx, isFtpPut, status, maxLength);
+			}
+		}
+		return true;
+	}
+
 	uint8_t mux;
 	if (parser.NextNum(mux))
 	{
@@ -229,10 +317,10 @@ bool SimcomResponseParser::ParseUnsolicited(FixedStringBase& line)
 		{
 			if (parser.NextString(str))
 			{
-				_logger.Log(F("Mux: %d, event = %s"), mux, str.c_str());
+				_logger.Debug(GsmLogCategory::Socket, F("Mux: %d, event = %s"), mux, str.c_str());
 				if (_onMuxEvent != nullptr)
 				{
-					_response.clear();
+					// line is kept when handler returns false, e.g. N, CLOSE OK answers CIPCLOSE
 					return _onMuxEvent(_onMuxEventCtx, mux, str);
 				}
 				return true;
@@ -295,16 +383,15 @@ ParserState SimcomResponseParser::ParseLine()
 	
 	if(_currentCommand == AtCommand::Cipstatus)
 	{
-		static uint8_t internalState = 0;
 		// Cipstatus returns OK first, then IP STATE: xxxx
 		if (IsOkLine())
 		{
-			internalState = 0;
+			_cipstatusLineIndex = 0;
 			return ParserState::PartialSuccess;
 		}
 		if (_state == ParserState::PartialSuccess)
 		{
-			if (internalState == 0)
+			if (_cipstatusLineIndex == 0)
 			{
 				if (ParsingHelpers::ParseIpStatus(_response.c_str(), *_parserContext.IpState))
 				{
@@ -312,11 +399,11 @@ ParserState SimcomResponseParser::ParseLine()
 					{
 						return ParserState::Success;
 					}
-					internalState = 1;
+					_cipstatusLineIndex = 1;
 					return ParserState::PartialSuccess;
 				}
 			}
-			if (internalState >= 1)
+			if (_cipstatusLineIndex >= 1)
 			{
 				if(parser.StartsWith(F("C: ")))
 				{ 
@@ -328,8 +415,8 @@ ParserState SimcomResponseParser::ParseLine()
 							_onMuxCipstatusInfo(_onMuxCipstatusInfoCtx, info);
 						}
 					}
-					internalState++;
-					if (internalState == 7)
+					_cipstatusLineIndex++;
+					if (_cipstatusLineIndex == 7)
 					{
 						return ParserState::Success;
 					}
@@ -419,6 +506,147 @@ ParserState SimcomResponseParser::ParseLine()
 		}
 	}
 
+	if (_currentCommand == AtCommand::Cdnsgip)
+	{
+		// OK comes first, result is reported when lookup finishes
+		if (IsOkLine())
+		{
+			return ParserState::PartialSuccess;
+		}
+		if (parser.StartsWith(F("+CDNSGIP: ")))
+		{
+			uint8_t isResolved;
+			FixedString<SOCKET_MAX_HOST_LENGTH> host;
+			FixedString16 ipStr;
+			if (!parser.NextNum(isResolved) || isResolved != 1 ||
+				!parser.NextString(host) ||
+				!parser.NextString(ipStr) ||
+				!ParsingHelpers::ParseIpAddress(ipStr, *_parserContext.IpAddress))
+			{
+				return ParserState::Error;
+			}
+			return ParserState::Success;
+		}
+	}
+
+	if (_currentCommand == AtCommand::Sapbr)
+	{
+		// +SAPBR: 1,1,"10.64.0.2", address is 0.0.0.0 unless connected
+		if (parser.StartsWith(F("+SAPBR: ")))
+		{
+			uint8_t cid;
+			uint8_t status;
+			FixedString16 ipStr;
+			if (!parser.NextNum(cid) ||
+				!parser.NextNum(status) ||
+				!parser.NextString(ipStr) ||
+				!ParsingHelpers::ParseIpAddress(ipStr, *_parserContext.IpAddress))
+			{
+				return ParserState::PartialError;
+			}
+			*_parserContext.Bearer = static_cast<BearerStatus>(status);
+			return ParserState::PartialSuccess;
+		}
+	}
+
+	if (_currentCommand == AtCommand::HttpData)
+	{
+		// modem waits for data now, OK follows once all of it arrived
+		if (_response == F("DOWNLOAD"))
+		{
+			return ParserState::Success;
+		}
+	}
+
+	if (_currentCommand == AtCommand::HttpRead)
+	{
+		if (parser.StartsWith(F("+HTTPREAD: ")))
+		{
+			uint16_t dataSize;
+			if (!parser.NextNum(dataSize))
+			{
+				return ParserState::PartialError;
+			}
+			_parserContext.CiprxGetLeftBytesToRead = dataSize;
+			*_parserContext.HttpReadBytes = dataSize;
+			return ParserState::PartialSuccess;
+		}
+		// read past end of data returns only OK
+		if (IsOkLine())
+		{
+			return ParserState::Success;
+		}
+	}
+
+	if (_currentCommand == AtCommand::FtpPut)
+	{
+		// modem waits for that many bytes now, OK follows once they arrived
+		if (parser.StartsWith(F("+FTPPUT: 2,")))
+		{
+			if (!parser.NextNum(*_parserContext.FtpDataLength))
+			{
+				return ParserState::Error;
+			}
+			return ParserState::Success;
+		}
+		// AT+FTPPUT=2,0 closing session
+		if (IsOkLine())
+		{
+			return ParserState::Success;
+		}
+	}
+
+	if (_currentCommand == AtCommand::FtpGet)
+	{
+		if (parser.StartsWith(F("+FTPGET: 2,")))
+		{
+			uint16_t dataSize;
+			if (!parser.NextNum(dataSize))
+			{
+				return ParserState::PartialError;
+			}
+			_parserContext.CiprxGetLeftBytesToRead = dataSize;
+			*_parserContext.FtpDataLength = dataSize;
+			return ParserState::PartialSuccess;
+		}
+	}
+
+	if (_currentCommand == AtCommand::FtpSize)
+	{
+		// OK comes first, size is reported once server answers
+		if (IsOkLine())
+		{
+			return ParserState::PartialSuccess;
+		}
+		if (parser.StartsWith(F("+FTPSIZE: 1,")))
+		{
+			uint8_t error;
+			uint32_t size;
+			if (!parser.NextNum(error) || !parser.NextNum(size) || error != 0)
+			{
+				return ParserState::Error;
+			}
+			*_parserContext.FtpSize = size;
+			return ParserState::Success;
+		}
+	}
+
+	if (_currentCommand == AtCommand::Cipack)
+	{
+		if (parser.StartsWith(F("+CIPACK: ")))
+		{
+			uint32_t sentBytes;
+			uint32_t ackedBytes;
+			if (!parser.NextNum(sentBytes) || !parser.NextNum(ackedBytes))
+			{
+				return ParserState::PartialError;
+			}
+			*_parserContext.CipackSentBytes = sentBytes;
+			*_parserContext.CipackAckedBytes = ackedBytes;
+			return ParserState::PartialSuccess;
+		}
+	}
+
 	if (_currentCommand == AtCommand::Clcc)
 	{
 		if (parser.StartsWith(F("+CLCC: ")))
@@ -571,7 +799,7 @@ ParserState SimcomResponseParser::ParseLine()
 			}
 			if (_response.endsWith(F("SEND FAIL")))
 			{
-				_logger.Log(F("CIPSEND failed, SEND FAIL detected"));
+				_logger.Warning(GsmLogCategory::Socket, F("CIPSEND failed, SEND FAIL detected"));
 				return ParserState::Error;
 			}
 		}
@@ -579,7 +807,7 @@ ParserState SimcomResponseParser::ParseLine()
 		{
 			if(IsErrorLine())
 			{
-				_logger.Log(F("CIPSEND failed, error line detected"));
+				_logger.Warning(GsmLogCategory::Socket, F("CIPSEND failed, error line detected"));
 				return ParserState::Error;
 			}			
 		}
@@ -629,6 +857,58 @@ ParserState SimcomResponseParser::ParseLine()
 		}
 	}
 
+	if (_currentCommand == AtCommand::ModemConfigQuery)
+	{
+		// response to AT+CIPMUX?;+CIPQSEND?;+CIPRXGET?;+CIPMODE?;+CREG?, single OK at the end
+		uint16_t value;
+		if (parser.StartsWith(F("+CIPMUX: ")))
+		{
+			if (!parser.NextNum(value))
+			{
+				return ParserState::PartialError;
+			}
+			_parserContext.ModemConfig->Cipmux = value == 1;
+			_parserContext.Cipmux = value == 1;
+			return ParserState::PartialSuccess;
+		}
+		if (parser.StartsWith(F("+CIPQSEND: ")))
+		{
+			if (!parser.NextNum(value))
+			{
+				return ParserState::PartialError;
+			}
+			_parserContext.ModemConfig->CipQSend = value == 1;
+			return ParserState::PartialSuccess;
+		}
+		if (parser.StartsWith(F("+CIPRXGET:")))
+		{
+			if (!parser.NextNum(value))
+			{
+				return ParserState::PartialError;
+			}
+			_parserContext.ModemConfig->IsRxManual = value == 1;
+			return ParserState::PartialSuccess;
+		}
+		if (parser.StartsWith(F("+CIPMODE: ")))
+		{
+			if (!parser.NextNum(value))
+			{
+				return ParserState::PartialError;
+			}
+			_parserContext.ModemConfig->IsTransparent = value == 1;
+			return ParserState::PartialSuccess;
+		}
+		if (parser.StartsWith(F("+CREG: ")))
+		{
+			if (!parser.NextNum(value))
+			{
+				return ParserState::PartialError;
+			}
+			_parserContext.ModemConfig->CregMode = value;
+			return ParserState::PartialSuccess;
+		}
+	}
+
 	if (IsOkLine())
 	{
 		if (_state == ParserState::PartialSuccess)
@@ -758,3 +1038,39 @@ void SimcomResponseParser::OnGsmModuleEvent(void * ctx, OnGsmModuleEventHandler
 	_onGsmModuleEventCtx = ctx;
 	_onGsmModuleEvent = onGsmModuleEvent;
 }
+
+void SimcomResponseParser::OnHttpAction(void* ctx, HttpActionHandler onHttpAction)
+{
+	_onHttpActionCtx = ctx;
+	_onHttpAction = onHttpAction;
+}
+
+void SimcomResponseParser::OnFtpSession(void* ctx, FtpSessionHandler onFtpSession)
+{
+	_onFtpSessionCtx = ctx;
+	_onFtpSession = onFtpSession;
+}
+
+bool SimcomResponseParser::PopIncomingCall(FixedStringBase& callerNumber)
+{
+	if (!_isRingPending)
+	{
+		return false;
+	}
+	callerNumber.clear();
+	callerNumber.append(_ringCallerNumber.c_str(), _ringCallerNumber.length());
+	_isRingPending = false;
+	_ringCallerNumber.clear();
+	return true;
+}
+
+void SimcomResponseParser::OnUssdResponse(void* ctx, UssdResponseHandler onUssdResponse)
+{
+	_onUssdResponseCtx = ctx;
+	_onUssdResponse = onUssdResponse;
+}
+
+void SimcomResponseParser::SetTranscriptRecorder(AtTranscriptRecorder* transcript)
+{
+	_transcript = transcript;
+}
@@ -7,11 +7,19 @@
 #include "DelimParser.h"
 #include "SequenceDetector.h"
 #include "../GsmLogger.h"
+#include "../Diagnostics/AtTranscriptRecorder.h"
 #include <FixedString.h>
 
 typedef bool(*MuxEventHandler)(void* ctx, uint8_t mux, FixedStringBase& eventStr);
 typedef void(*MuxCipstatusInfoHandler)(void* ctx, ConnectionInfo& info);
 typedef void(*OnGsmModuleEventHandler)(void *ctx, GsmModuleEventType eventType);
+// statusCode is HTTP status or 6xx modem error (601 network error, 603 DNS error, 604 stack busy)
+typedef void(*HttpActionHandler)(void* ctx, HttpMethod method, uint16_t statusCode, uint32_t dataLength);
+// +FTPPUT: 1 / +FTPGET: 1 session URC, status 1 ready for data, 0 transfer finished, 61 and above error.
+// maxLength is largest chunk for next AT+FTPPUT=2, 0 for downloads
+typedef void(*FtpSessionHandler)(void* ctx, bool isUpload, uint8_t status, uint16_t maxLength);
+// +CUSD: URC received outside of blocking AT+CUSD command, response is empty when network sent no text
+typedef void(*UssdResponseHandler)(void* ctx, UssdStatus status, FixedStringBase& response);
 
 enum class LineState 
 {
@@ -41,6 +49,18 @@ class SimcomResponseParser
 	void* _onMuxCipstatusInfoCtx;
 	OnGsmModuleEventHandler _onGsmModuleEvent;
 	void* _onGsmModuleEventCtx;
+	HttpActionHandler _onHttpAction;
+	void* _onHttpActionCtx;
+	FtpSessionHandler _onFtpSession;
+	void* _onFtpSessionCtx;
+	// RING or +CLIP: seen since last PopIncomingCall, handled from module loop, not from inside running command
+	bool _isRingPending;
+	FixedString32 _ringCallerNumber;
+	UssdResponseHandler _onUssdResponse;
+	void* _onUssdResponseCtx;
+	AtTranscriptRecorder* _transcript;
+	// position in multi line AT+CIPSTATUS response, 0 is IP STATE line
+	uint8_t _cipstatusLineIndex;
 
 	ParserState ParseLine();
 	LineState StateTransition(char c);
@@ -57,6 +77,11 @@ public:
 	void OnMuxEvent(void* ctx, MuxEventHandler onMuxEvent);
 	void OnMuxCipstatusInfo(void* ctx, MuxCipstatusInfoHandler onMuxCipstatusInfo);
 	void OnGsmModuleEvent(void* ctx, OnGsmModuleEventHandler handler);
+	void OnHttpAction(void* ctx, HttpActionHandler handler);
+	void OnFtpSession(void* ctx, FtpSessionHandler handler);
+	bool PopIncomingCall(FixedStringBase& callerNumber);
+	void OnUssdResponse(void* ctx, UssdResponseHandler handler);
+	void SetTranscriptRecorder(AtTranscriptRecorder* transcript);
 	volatile bool commandReady;
 	bool IsGarbageDetectionActive;
 };
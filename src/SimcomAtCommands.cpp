@@ -7,9 +7,18 @@ _updateBaudRateCallback(updateBaudRateCallback),
 _cpuSleepCallback(cpuSleepCallback),
 _setDtrCallback(setDtrCallback),
 _currentBaudRate(0),
+_lastBaudRate(0),
+_baudRateDetectionTime(0),
 _parser(_parserContext, _logger, serial, _currentCommand),
 _isInSleepMode(false),
+_isSleepConfigured(false),
 _lastIncomingByteTime(0),
+_transcript(nullptr),
+_isCommandPending(false),
+_pendingCommandStart(0),
+_pendingCommandTimeout(0),
+_hasCompletedPendingCommand(false),
+_completedPendingResult(AtResultType::Timeout),
 IsAsync(false)
 {
 }
@@ -26,17 +35,45 @@ void SimcomAtCommands::ReadCharAndFeedParser()
 		return;
 	}
 	auto c = _serial.read();
+	if (_transcript != nullptr)
+	{
+		_transcript->Record(AtTranscriptDirection::FromModem, c);
+	}
 	_parser.FeedChar(c);
 	_lastIncomingByteTime = millis();	
 }
 void SimcomAtCommands::ReadCharAndIgnore()
+{
+	ReadCharRecorded();
+}
+int SimcomAtCommands::ReadCharRecorded()
 {
 	if (!_serial.available())
 	{
-		return;
+		return -1;
+	}
+	auto c = _serial.read();
+	if (_transcript != nullptr)
+	{
+		_transcript->Record(AtTranscriptDirection::FromModem, c);
 	}
-	_serial.read();
 	_lastIncomingByteTime = millis();
+	return c;
+}
+void SimcomAtCommands::DiscardIncomingData()
+{
+	while (_serial.available())
+	{
+		ReadCharAndIgnore();
+	}
+}
+void SimcomAtCommands::WriteToModem(const char* data, size_t length)
+{
+	_serial.write(data, length);
+	if (_transcript != nullptr)
+	{
+		_transcript->Record(AtTranscriptDirection::ToModem, data, length);
+	}
 }
 AtResultType SimcomAtCommands::PopCommandResult(bool ensureDelay, uint64_t timeout)
 {
@@ -48,20 +85,33 @@ AtResultType SimcomAtCommands::PopCommandResult(bool ensureDelay, uint64_t timeo
 			ReadCharAndFeedParser();
 		}
 		auto waitTime = millis() - before;
-		_logger.Log(F("Waited %u ms"), waitTime);
+		_logger.Debug(GsmLogCategory::At, F("Waited %u ms"), waitTime);
 	}
-	_serial.print(_currentCommand.c_str());
-	_serial.print("\r\n");
-	_serial.flush();
-	_logger.LogAt(F(" => %s"), _currentCommand.c_str());
+	WriteCurrentCommand();
+	return WaitCommandResult(timeout);
+}
 
+AtResultType SimcomAtCommands::WaitCommandResult(uint64_t timeout)
+{
 	const unsigned long start = millis();
 	while (_parser.commandReady == false && (millis() - start) < timeout)
 	{
 		ReadCharAndFeedParser();		
 	}
+	return CompleteCommand(millis() - start);
+}
+
+void SimcomAtCommands::WriteCurrentCommand()
+{
+	WriteToModem(_currentCommand.c_str(), _currentCommand.length());
+	WriteToModem("\r\n", 2);
+	_serial.flush();
+	_logger.LogAt(F(" => %s"), _currentCommand.c_str());
+}
+
+AtResultType SimcomAtCommands::CompleteCommand(unsigned long elapsedMs)
+{
 	const auto commandResult = _parser.GetAtResultType();
-	const auto elapsedMs = millis() - start;
 	
 	if (commandResult == AtResultType::Success)
 	{
@@ -70,14 +120,146 @@ AtResultType SimcomAtCommands::PopCommandResult(bool ensureDelay, uint64_t timeo
     else if (commandResult == AtResultType::Timeout)
 	{
 		TimeoutedCommand = _currentCommand;
-		_logger.Log(F("                      --- TIMEOUT executing '%s', elapsed %d ms ---"), _currentCommand.c_str(), elapsedMs);
+		_logger.Warning(GsmLogCategory::At, F("                      --- TIMEOUT executing '%s', elapsed %d ms ---"), _currentCommand.c_str(), elapsedMs);
 	}
 	else if (commandResult == AtResultType::Error)
 	{
-		_logger.Log(F("                      --- ERROR executing '%s', elapsed %d ms ---"), _currentCommand.c_str(), elapsedMs);
+		_logger.Warning(GsmLogCategory::At, F("                      --- ERROR executing '%s', elapsed %d ms ---"), _currentCommand.c_str(), elapsedMs);
 	}
 	return commandResult;
 }
+
+bool SimcomAtCommands::BeginCommand(uint64_t timeout)
+{
+	_isCommandPending = true;
+	_pendingCommandStart = millis();
+	_pendingCommandTimeout = timeout;
+	WriteCurrentCommand();
+	return true;
+}
+
+/*
+Reads whatever modem has sent so far without waiting for more.
+Returns true and sets result once command started with Begin* method completed or timed out
+*/
+bool SimcomAtCommands::PollCommand(AtResultType& result)
+{
+	if (_hasCompletedPendingCommand)
+	{
+		_hasCompletedPendingCommand = false;
+		result = _completedPendingResult;
+		return true;
+	}
+	if (!_isCommandPending)
+	{
+		return false;
+	}
+	while (_serial.available() && !_parser.commandReady)
+	{
+		ReadCharAndFeedParser();
+	}
+	const auto elapsedMs = millis() - _pendingCommandStart;
+	if (!_parser.commandReady && elapsedMs < _pendingCommandTimeout)
+	{
+		return false;
+	}
+	_isCommandPending = false;
+	result = CompleteCommand(elapsedMs);
+	return true;
+}
+
+void SimcomAtCommands::CancelCommand()
+{
+	_parserContext.CsqSignalQuality = nullptr;
+	_parserContext.BatteryInfo = nullptr;
+	_parserContext.IpState = nullptr;
+	if (_isCommandPending)
+	{
+		// late response is parsed as generic one, output pointers are not touched
+		_parser.SetCommandType(AtCommand::Generic, false);
+		_logger.Info(GsmLogCategory::At, F("Cancelled pending '%s'"), _currentCommand.c_str());
+	}
+	_isCommandPending = false;
+	_hasCompletedPendingCommand = false;
+}
+
+bool SimcomAtCommands::ExpirePendingCommand()
+{
+	if (!_isCommandPending)
+	{
+		return true;
+	}
+	if (millis() - _pendingCommandStart < _pendingCommandTimeout)
+	{
+		return false;
+	}
+	// result waits for PollCommand
+	CompletePendingCommand();
+	return true;
+}
+
+bool SimcomAtCommands::BeginAt()
+{
+	if (IsCommandPending())
+	{
+		return false;
+	}
+	SendAt_P(AtCommand::Generic, false, F("AT"));
+	return BeginCommand(AT_DEFAULT_TIMEOUT);
+}
+
+bool SimcomAtCommands::BeginGetSignalQuality(int16_t& signalQuality)
+{
+	if (IsCommandPending())
+	{
+		return false;
+	}
+	_parserContext.CsqSignalQuality = &signalQuality;
+	SendAt_P(AtCommand::Csq, F("AT+CSQ"));
+	return BeginCommand(AT_DEFAULT_TIMEOUT);
+}
+
+bool SimcomAtCommands::BeginGetBatteryStatus(BatteryStatus& batteryStatus)
+{
+	if (IsCommandPending())
+	{
+		return false;
+	}
+	_parserContext.BatteryInfo = &batteryStatus;
+	SendAt_P(AtCommand::Cbc, F("AT+CBC"));
+	return BeginCommand(AT_DEFAULT_TIMEOUT);
+}
+
+bool SimcomAtCommands::BeginGetIpState(SimcomIpState& ipState)
+{
+	if (IsCommandPending())
+	{
+		return false;
+	}
+	_parserContext.IpState = &ipState;
+	SendAt_P(AtCommand::Cipstatus, F("AT+CIPSTATUS"));
+	return BeginCommand(AT_DEFAULT_TIMEOUT);
+}
+
+/*
+Blocking command is about to reuse parser and parser context, waits for command
+started with Begin* so its response is not taken as response of the new one
+*/
+void SimcomAtCommands::CompletePendingCommand()
+{
+	if (!_isCommandPending)
+	{
+		return;
+	}
+	while (!_parser.commandReady && millis() - _pendingCommandStart < _pendingCommandTimeout)
+	{
+		ReadCharAndFeedParser();
+	}
+	_isCommandPending = false;
+	_completedPendingResult = CompleteCommand(millis() - _pendingCommandStart);
+	_hasCompletedPendingCommand = true;
+}
+
 void SimcomAtCommands::wait(uint64_t ms)
 {
 	const unsigned long start = millis();
@@ -89,6 +271,7 @@ void SimcomAtCommands::wait(uint64_t ms)
 
 AtResultType SimcomAtCommands::GenericAt(uint64_t timeout, const __FlashStringHelper* command, ...)
 {	
+	CompletePendingCommand();
 	_parser.SetCommandType(AtCommand::Generic);
 	va_list argptr;
 	va_start(argptr, command);
@@ -102,6 +285,7 @@ AtResultType SimcomAtCommands::GenericAt(uint64_t timeout, const __FlashStringHe
 }
 void SimcomAtCommands::SendAt_P(AtCommand commandType, const __FlashStringHelper* command, ...)
 {
+	CompletePendingCommand();
 	_parser.SetCommandType(commandType);
 
 	va_list argptr;
@@ -115,6 +299,7 @@ void SimcomAtCommands::SendAt_P(AtCommand commandType, const __FlashStringHelper
 }
 void SimcomAtCommands::SendAt_P(AtCommand commandType, bool expectEcho, const __FlashStringHelper* command, ...)
 {
+	CompletePendingCommand();
 	_parser.SetCommandType(commandType, expectEcho);
 
 	va_list argptr;
@@ -248,6 +433,13 @@ AtResultType SimcomAtCommands::GetIpAddress(GsmIp& ipAddress)
 	return PopCommandResult();
 }
 
+AtResultType SimcomAtCommands::ResolveHost(const char* host, GsmIp& ipAddress)
+{
+	_parserContext.IpAddress = &ipAddress;
+	SendAt_P(AtCommand::Cdnsgip, F("AT+CDNSGIP=\"%s\""), host);
+	return PopCommandResult(false, DNS_RESOLVE_TIMEOUT);
+}
+
 AtResultType SimcomAtCommands::GetRxMode(bool& isRxManual)
 {	
 	SendAt_P(AtCommand::CipRxGet, F("AT+CIPRXGET?"));
@@ -326,12 +518,76 @@ AtResultType SimcomAtCommands::SetEcho(bool echoEnabled)
 	return r;
 }
 
+AtResultType SimcomAtCommands::SaveProfile()
+{
+	SendAt_P(AtCommand::Generic, F("AT&W"));
+	return PopCommandResult();
+}
+
+/*
+Reads TCP/IP and registration settings applied during initialization with a single batched command
+*/
+AtResultType SimcomAtCommands::GetModemConfiguration(ModemConfiguration& configuration)
+{
+	configuration = ModemConfiguration();
+	_parserContext.ModemConfig = &configuration;
+	SendAt_P(AtCommand::ModemConfigQuery, F("AT+CIPMUX?;+CIPQSEND?;+CIPRXGET?;+CIPMODE?;+CREG?"));
+	const auto result = PopCommandResult();
+	configuration.IsValid = result == AtResultType::Success;
+	return result;
+}
+
 AtResultType SimcomAtCommands::SetTransparentMode(bool transparentMode)
 {	
 	SendAt_P(AtCommand::Generic, F("AT+CIPMODE=%d"), transparentMode ? 1:0);
 	return PopCommandResult();
 }
 
+/*
+Starts single connection in transparent mode, OK only means command was accepted.
+Modem reports CONNECT or CONNECT FAIL later, after CONNECT UART carries raw socket data
+*/
+AtResultType SimcomAtCommands::BeginTransparentConnect(ProtocolType protocol, const char* address, int port)
+{
+	_logger.Info(GsmLogCategory::Socket, F("BeginTransparentConnect %s:%u"), address, port);
+	SendAt_P(AtCommand::Generic, F("AT+CIPSTART=\"%s\",\"%s\",\"%d\""), ProtocolToStr(protocol), address, port);
+	return PopCommandResult(false, 30000u);
+}
+
+AtResultType SimcomAtCommands::CloseTransparentConnection()
+{
+	SendAt_P(AtCommand::Cipclose, F("AT+CIPCLOSE"));
+	return PopCommandResult();
+}
+
+// modem answers CONNECT when it switches back to data mode
+void SimcomAtCommands::BeginResumeDataMode()
+{
+	_logger.LogAt(F(" => ATO"));
+	WriteToModem("ATO\r\n", 5);
+}
+
+size_t SimcomAtCommands::WriteData(const char* data, size_t length)
+{
+	WriteToModem(data, length);
+	return length;
+}
+
+int SimcomAtCommands::ReadData()
+{
+	if (!_serial.available())
+	{
+		return -1;
+	}
+	auto c = _serial.read();
+	if (_transcript != nullptr)
+	{
+		_transcript->Record(AtTranscriptDirection::FromModem, c);
+	}
+	_lastIncomingByteTime = millis();
+	return c;
+}
+
 AtResultType SimcomAtCommands::SetApn(const char *apnName, const char *username,const char *password )
 {	
 	SendAt_P(AtCommand::Generic, F("AT+CSTT=\"%s\",\"%s\",\"%s\""), apnName, username, password);
@@ -350,17 +606,21 @@ bool SimcomAtCommands::EnsureModemConnected(uint64_t requestedBaudRate)
 	{
 		return false;
 	}
+	// modem might have been restarted, CSCLK is back to default
+	_isSleepConfigured = false;
 
-	_logger.Log(F("Found baud rate = %d"), _currentBaudRate);
+	_lastBaudRate = _currentBaudRate;
+	_logger.Log(F("Found baud rate = %d in %d ms"), static_cast<uint32_t>(_currentBaudRate), _baudRateDetectionTime);
 	
 	if (_currentBaudRate != requestedBaudRate)
 	{
 		if (SetBaudRate(requestedBaudRate) != AtResultType::Success)
 		{
-			_logger.Log(F("Failed to update baud rate to %d"), requestedBaudRate);
+			_logger.Warning(GsmLogCategory::General, F("Failed to update baud rate to %d"), requestedBaudRate);
 			return false;
 		}
 		_currentBaudRate = requestedBaudRate;
+		_lastBaudRate = requestedBaudRate;
 		_logger.Log(F("Updated baud rate to = %d"), _currentBaudRate);
 	}
 
@@ -368,7 +628,7 @@ bool SimcomAtCommands::EnsureModemConnected(uint64_t requestedBaudRate)
 
 	if (SetEcho(true) != AtResultType::Success)
 	{
-		_logger.Log(F("Failed to set echo"));
+		_logger.Warning(GsmLogCategory::General, F("Failed to set echo"));
 		return false;	
 	}
 	_parser.ResetUartGarbageDetected();
@@ -377,33 +637,57 @@ bool SimcomAtCommands::EnsureModemConnected(uint64_t requestedBaudRate)
 
 uint64_t SimcomAtCommands::FindCurrentBaudRate()
 {
-	if (_updateBaudRateCallback == nullptr)
+	if (!UpdateSerialBaudRate(_lastBaudRate != 0 ? _lastBaudRate : _defaultBaudRates[0]))
 	{
-		_logger.Log(F("Change baud rate callback is null"));
+		_logger.Error(GsmLogCategory::General, F("Serial baud rate can not be changed, no callback"));
 		return 0;
 	}
 
+	const auto start = millis();
 	//garbage detection is disabled as change baud rate might result in 
 	//receiving couple of garbage characters, safe to ignore
 	_parser.IsGarbageDetectionActive = false;
-	int i = 0;
-	uint64_t baudRate = 0;
-	AtResultType commandResult;
-	do
-	{
-		auto baudRateToTry = _defaultBaudRates[i];
-		_logger.Log(F("Trying baud rate: %d"), baudRateToTry);
-		_updateBaudRateCallback(baudRateToTry);
-		commandResult = At();
-		if (commandResult == AtResultType::Success)
+	// quick pass finds modem with fixed baud rate, AT sent during it also lets
+	// modem in autobaud mode lock on, so it answers during slow pass
+	auto baudRate = ProbeBaudRates(BAUD_RATE_PROBE_TIMEOUT);
+	if (baudRate == 0)
+	{
+		baudRate = ProbeBaudRates(BAUD_RATE_PROBE_TIMEOUT_SLOW);
+	}
+	_parser.IsGarbageDetectionActive = true;
+	_baudRateDetectionTime = millis() - start;
+	return baudRate;
+}
+
+uint64_t SimcomAtCommands::ProbeBaudRates(uint32_t timeout)
+{
+	// most of the time modem is still at the rate we left it
+	if (_lastBaudRate != 0 && ProbeBaudRate(_lastBaudRate, timeout))
+	{
+		return _lastBaudRate;
+	}
+	for (int i = 0; _defaultBaudRates[i] != 0; i++)
+	{
+		const auto baudRateToTry = _defaultBaudRates[i];
+		if (baudRateToTry == _lastBaudRate)
 		{
-			baudRate = baudRateToTry;
+			continue;
 		}
+		if (ProbeBaudRate(baudRateToTry, timeout))
+		{
+			return baudRateToTry;
+		}
+	}
+	return 0;
+}
 
-		i++;
-	} while (_defaultBaudRates[i] != 0 && commandResult != AtResultType::Success);
-	_parser.IsGarbageDetectionActive = true;
-	return baudRate;
+bool SimcomAtCommands::ProbeBaudRate(uint64_t baudRate, uint32_t timeout)
+{
+	_logger.Debug(GsmLogCategory::General, F("Trying baud rate: %d, timeout %d ms"), static_cast<uint32_t>(baudRate), timeout);
+	UpdateSerialBaudRate(baudRate);
+	// bytes received at previous baud rate are garbage at this one
+	DiscardIncomingData();
+	return At(timeout) == AtResultType::Success;
 }
 
 AtResultType SimcomAtCommands::GetImei(FixedString32 &imei)
@@ -421,15 +705,18 @@ bool SimcomAtCommands::GarbageOnSerialDetected()
 AtResultType SimcomAtCommands::SendSms(char *number, char *message)
 {	
 	SendAt_P(AtCommand::Generic, F("AT+CMGS=\"%s\""), number);
+	WriteCurrentCommand();
 
 	const uint64_t start = millis();
-	// wait for >
-	while (_serial.read() != '>')
+	// wait for >, read through transcript so replay stays in sync
+	while (ReadCharRecorded() != '>')
 		if (millis() - start > 200)
 			return AtResultType::Error;
-	_serial.print(message);
-	_serial.print('\x1a');
-	return PopCommandResult();
+	// command echo was consumed with the prompt
+	_parser.SetCommandType(AtCommand::Generic, false);
+	WriteToModem(message, strlen(message));
+	WriteToModem("\x1a", 1);
+	return WaitCommandResult(AT_DEFAULT_TIMEOUT);
 }
 AtResultType SimcomAtCommands::SendUssdWaitResponse(char *ussd, FixedString128& response)
 {
@@ -438,6 +725,23 @@ AtResultType SimcomAtCommands::SendUssdWaitResponse(char *ussd, FixedString128&
 	return PopCommandResult(false, 10000u);
 }
 
+AtResultType SimcomAtCommands::SendUssd(const char* ussd)
+{
+	SendAt_P(AtCommand::Generic, F("AT+CUSD=1,\"%s\""), ussd);
+	return PopCommandResult();
+}
+
+AtResultType SimcomAtCommands::CancelUssd()
+{
+	SendAt_P(AtCommand::Generic, F("AT+CUSD=2"));
+	return PopCommandResult();
+}
+
+void SimcomAtCommands::OnUssdResponse(void* ctx, UssdResponseHandler ussdResponseHandler)
+{
+	_parser.OnUssdResponse(ctx, ussdResponseHandler);
+}
+
 AtResultType SimcomAtCommands::Cipshut()
 {	
 	SendAt_P(AtCommand::Cipshut, F("AT+CIPSHUT"));
@@ -446,19 +750,50 @@ AtResultType SimcomAtCommands::Cipshut()
 
 bool SimcomAtCommands::SetDtr(bool value)
 {
-	if (_setDtrCallback == nullptr)
+	if (!WriteDtr(value))
 	{
 		return false;
-	}	
+	}
 	if (value)
 	{
-		_logger.Log(F("Pulling DTR up"));
+		_logger.Debug(GsmLogCategory::General, F("Pulled DTR up"));
 	}
 	else
 	{
-		_logger.Log(F("Pulling DTR down"));
+		_logger.Debug(GsmLogCategory::General, F("Pulled DTR down"));
+	}
+	return true;
+}
+
+bool SimcomAtCommands::UpdateSerialBaudRate(uint64_t baudRate)
+{
+	if (_updateBaudRateCallback == nullptr)
+	{
+		return false;
 	}
-	return _setDtrCallback(value);
+	_updateBaudRateCallback(baudRate);
+	return true;
+}
+
+bool SimcomAtCommands::WriteDtr(bool isHigh)
+{
+	if (_setDtrCallback == nullptr)
+	{
+		return false;
+	}
+	return _setDtrCallback(isHigh);
+}
+
+bool SimcomAtCommands::SleepCpu(uint64_t millis)
+{
+	if (_cpuSleepCallback == nullptr)
+	{
+		return false;
+	}
+	_logger.Debug(GsmLogCategory::General, F("Entering CPU sleep"));
+	_logger.Flush();
+	_cpuSleepCallback(millis);
+	return true;
 }
 
 AtResultType SimcomAtCommands::Call(const char *number)
@@ -483,6 +818,17 @@ AtResultType SimcomAtCommands::GetIncomingCall(IncomingCallInfo & callInfo)
 	return result;
 }
 
+AtResultType SimcomAtCommands::SetCallerIdNotification(bool enable)
+{
+	SendAt_P(AtCommand::Generic, F("AT+CLIP=%d"), enable ? 1 : 0);
+	return PopCommandResult();
+}
+
+bool SimcomAtCommands::PopIncomingCall(FixedStringBase& callerNumber)
+{
+	return _parser.PopIncomingCall(callerNumber);
+}
+
 AtResultType SimcomAtCommands::Shutdown()
 {	
 	SendAt_P(AtCommand::Generic, F("AT+CPOWD=0"));
@@ -502,7 +848,7 @@ AtResultType SimcomAtCommands::GetTemperature(float& temperature)
 }
 AtResultType SimcomAtCommands::BeginConnect(ProtocolType protocol, uint8_t mux, const char *address, int port)
 {	
-	_logger.Log(F("BeginConnect %s:%u"), address, port);
+	_logger.Info(GsmLogCategory::Socket, F("BeginConnect %s:%u"), address, port);
 
 	SendAt_P(AtCommand::Generic, 
 		F("AT+CIPSTART=%d,\"%s\",\"%s\",\"%d\""),
@@ -526,7 +872,7 @@ AtResultType SimcomAtCommands::Send(int mux, FixedStringBase & data, uint16_t in
 	_parserContext.CipsendDataIndex = index;
 	_parserContext.CipsendDataLength = length;
 	_parserContext.CipsendSentBytes = &sentBytes;
-	SendAt_P(AtCommand::CipSend, F("AT+CIPSEND=%d,%d"), mux, data.length());
+	SendAt_P(AtCommand::CipSend, F("AT+CIPSEND=%d,%d"), mux, length);
 	return PopCommandResult(false);
 }
 
@@ -541,12 +887,177 @@ AtResultType SimcomAtCommands::CloseConnection(uint8_t mux)
 	return PopCommandResult();
 }
 
+AtResultType SimcomAtCommands::GetAckedBytes(uint8_t mux, uint32_t& sentBytes, uint32_t& ackedBytes)
+{
+	_parserContext.CipackSentBytes = &sentBytes;
+	_parserContext.CipackAckedBytes = &ackedBytes;
+	SendAt_P(AtCommand::Cipack, F("AT+CIPACK=%d"), mux);
+	return PopCommandResult();
+}
+
 AtResultType SimcomAtCommands::GetConnectionInfo(uint8_t mux, ConnectionInfo &connectionInfo)
 {	
 	_parserContext.CurrentConnectionInfo = &connectionInfo;
 	SendAt_P(AtCommand::CipstatusSingleConnection, F("AT+CIPSTATUS=%d"), mux);
 	return PopCommandResult();
 }
+AtResultType SimcomAtCommands::SetBearerParameter(const char* name, const char* value)
+{
+	SendAt_P(AtCommand::Generic, F("AT+SAPBR=3,1,\"%s\",\"%s\""), name, value);
+	return PopCommandResult();
+}
+
+AtResultType SimcomAtCommands::OpenBearer()
+{
+	SendAt_P(AtCommand::Generic, F("AT+SAPBR=1,1"));
+	return PopCommandResult(false, BEARER_OPEN_TIMEOUT);
+}
+
+AtResultType SimcomAtCommands::CloseBearer()
+{
+	SendAt_P(AtCommand::Generic, F("AT+SAPBR=0,1"));
+	return PopCommandResult(false, 65000u);
+}
+
+AtResultType SimcomAtCommands::GetBearerStatus(BearerStatus& status, GsmIp& ipAddress)
+{
+	_parserContext.Bearer = &status;
+	_parserContext.IpAddress = &ipAddress;
+	SendAt_P(AtCommand::Sapbr, F("AT+SAPBR=2,1"));
+	return PopCommandResult();
+}
+
+AtResultType SimcomAtCommands::HttpInit()
+{
+	SendAt_P(AtCommand::Generic, F("AT+HTTPINIT"));
+	return PopCommandResult();
+}
+
+AtResultType SimcomAtCommands::HttpTerm()
+{
+	SendAt_P(AtCommand::Generic, F("AT+HTTPTERM"));
+	return PopCommandResult();
+}
+
+AtResultType SimcomAtCommands::HttpSetParameter(const char* name, const char* value)
+{
+	SendAt_P(AtCommand::Generic, F("AT+HTTPPARA=\"%s\",\"%s\""), name, value);
+	return PopCommandResult();
+}
+
+AtResultType SimcomAtCommands::HttpSetData(const char* data, uint32_t length, uint32_t timeout)
+{
+	SendAt_P(AtCommand::HttpData, F("AT+HTTPDATA=%u,%u"), length, timeout);
+	const auto result = PopCommandResult();
+	if (result != AtResultType::Success)
+	{
+		return result;
+	}
+	_parser.SetCommandType(AtCommand::Generic, false);
+	WriteToModem(data, length);
+	_serial.flush();
+	return WaitCommandResult(timeout + AT_DEFAULT_TIMEOUT);
+}
+
+AtResultType SimcomAtCommands::HttpAction(HttpMethod method)
+{
+	SendAt_P(AtCommand::Generic, F("AT+HTTPACTION=%d"), static_cast<int>(method));
+	return PopCommandResult();
+}
+
+AtResultType SimcomAtCommands::HttpRead(uint32_t offset, uint16_t length, FixedStringBase& output, uint16_t& readBytes)
+{
+	if (length > output.freeBytes())
+	{
+		length = output.freeBytes();
+	}
+	readBytes = 0;
+	_parserContext.CipRxGetBuffer = &output;
+	_parserContext.HttpReadBytes = &readBytes;
+	SendAt_P(AtCommand::HttpRead, F("AT+HTTPREAD=%u,%u"), offset, length);
+	return PopCommandResult(false, 5000u);
+}
+
+void SimcomAtCommands::OnHttpAction(void* ctx, HttpActionHandler httpActionHandler)
+{
+	_parser.OnHttpAction(ctx, httpActionHandler);
+}
+
+AtResultType SimcomAtCommands::FtpSetParameter(const char* name, const char* value)
+{
+	SendAt_P(AtCommand::Generic, F("AT+FTP%s=\"%s\""), name, value);
+	return PopCommandResult();
+}
+
+AtResultType SimcomAtCommands::FtpSetParameter(const char* name, uint32_t value)
+{
+	SendAt_P(AtCommand::Generic, F("AT+FTP%s=%u"), name, value);
+	return PopCommandResult();
+}
+
+AtResultType SimcomAtCommands::FtpGetSize(uint32_t& size)
+{
+	_parserContext.FtpSize = &size;
+	SendAt_P(AtCommand::FtpSize, F("AT+FTPSIZE"));
+	return PopCommandResult(false, FTP_SIZE_TIMEOUT);
+}
+
+AtResultType SimcomAtCommands::FtpPutOpen()
+{
+	SendAt_P(AtCommand::Generic, F("AT+FTPPUT=1"));
+	return PopCommandResult();
+}
+
+AtResultType SimcomAtCommands::FtpPutWrite(const char* data, uint16_t length, uint16_t& acceptedLength)
+{
+	acceptedLength = 0;
+	_parserContext.FtpDataLength = &acceptedLength;
+	SendAt_P(AtCommand::FtpPut, F("AT+FTPPUT=2,%u"), length);
+	const auto result = PopCommandResult();
+	if (result != AtResultType::Success || acceptedLength == 0)
+	{
+		return result;
+	}
+	if (acceptedLength > length)
+	{
+		acceptedLength = length;
+	}
+	_parser.SetCommandType(AtCommand::Generic, false);
+	WriteToModem(data, acceptedLength);
+	_serial.flush();
+	return WaitCommandResult(AT_DEFAULT_TIMEOUT);
+}
+
+AtResultType SimcomAtCommands::FtpPutClose()
+{
+	SendAt_P(AtCommand::FtpPut, F("AT+FTPPUT=2,0"));
+	return PopCommandResult();
+}
+
+AtResultType SimcomAtCommands::FtpGetOpen()
+{
+	SendAt_P(AtCommand::Generic, F("AT+FTPGET=1"));
+	return PopCommandResult();
+}
+
+AtResultType SimcomAtCommands::FtpGetRead(uint16_t length, FixedStringBase& output, uint16_t& readBytes)
+{
+	if (length > output.freeBytes())
+	{
+		length = output.freeBytes();
+	}
+	readBytes = 0;
+	_parserContext.CipRxGetBuffer = &output;
+	_parserContext.FtpDataLength = &readBytes;
+	SendAt_P(AtCommand::FtpGet, F("AT+FTPGET=2,%u"), length);
+	return PopCommandResult(false, 5000u);
+}
+
+void SimcomAtCommands::OnFtpSession(void* ctx, FtpSessionHandler ftpSessionHandler)
+{
+	_parser.OnFtpSession(ctx, ftpSessionHandler);
+}
+
 void SimcomAtCommands::OnMuxEvent(void* ctx, MuxEventHandler muxEventHandler)
 {
 	_parser.OnMuxEvent(ctx, muxEventHandler);
@@ -561,75 +1072,86 @@ void SimcomAtCommands::OnGsmModuleEvent(void * ctx, OnGsmModuleEventHandler gsmM
 	_parser.OnGsmModuleEvent(ctx, gsmModuleEventHandler);
 }
 
+void SimcomAtCommands::SetTranscriptRecorder(AtTranscriptRecorder* transcript)
+{
+	_transcript = transcript;
+	_parser.SetTranscriptRecorder(transcript);
+}
+
 AtResultType SimcomAtCommands::EnterSleepMode()
 {
-	if (!SetDtr(true))
+	if (!_isSleepConfigured)
 	{
-		return AtResultType::Error;
+		SendAt_P(AtCommand::Generic, F("AT+CSCLK=1"));
+		const auto result = PopCommandResult();
+		if (result != AtResultType::Success)
+		{
+			return result;
+		}
+		_isSleepConfigured = true;
 	}
-
-	SendAt_P(AtCommand::Generic, F("AT+CSCLK=1"));
-	auto result = PopCommandResult();
-	if (result == AtResultType::Success)
+	// with CSCLK=1 modem goes to sleep on its own once DTR is high
+	if (!SetDtr(true))
 	{
-		_isInSleepMode = true;
+		return AtResultType::Error;
 	}
-	return result;
+	_isInSleepMode = true;
+	return AtResultType::Success;
 }
 
 AtResultType SimcomAtCommands::ExitSleepMode()
 {
-	_logger.Log(F("Exiting sleep mode"));
+	_logger.Debug(GsmLogCategory::General, F("Exiting sleep mode"));
 	if (!SetDtr(false))
 	{
 		return AtResultType::Error;
 	}
-	
-	delay(100);
-	
+
+	const auto startUs = micros();
+	const auto start = millis();
 	int n = 0;
-	while (At(150u, false) != AtResultType::Success)
-	{	
-		if (n % 2 == 0 && n >= 2)
-		{
-			SetDtr(true);
-			delay(20);
-			SetDtr(false);
-			delay(100);
-		}
-		if (n == 40)
+	// modem answers AT as soon as it is awake, so keep probing instead of waiting fixed time
+	while (At(SLEEP_WAKE_PROBE_TIMEOUT, false) != AtResultType::Success)
+	{
+		if (millis() - start > SLEEP_WAKE_TIMEOUT)
 		{
+			_wakeStats.FailureCount++;
+			_logger.Warning(GsmLogCategory::General, F("Modem did not wake up in %d ms"), SLEEP_WAKE_TIMEOUT);
 			return AtResultType::Timeout;
 		}
 		n++;
+		// DTR edge might have been missed while modem was entering sleep
+		if (n % 10 == 0)
+		{
+			SetDtr(true);
+			delay(SLEEP_WAKE_DTR_PULSE);
+			SetDtr(false);
+		}
 	}
+	const uint32_t latencyUs = micros() - startUs;
+	_wakeStats.AddWake(latencyUs);
+	_logger.Debug(GsmLogCategory::General, F("Modem woke up in %u us"), latencyUs);
+	_isInSleepMode = false;
+	return AtResultType::Success;
+}
 
-	for (int i = 0; i < 5; i++)
+AtResultType SimcomAtCommands::DisableSleepMode()
+{
+	if (_isInSleepMode)
 	{
-		wait(1);
-		SendAt_P(AtCommand::Generic, F("AT+CSCLK=0"));
-		auto result = PopCommandResult();
-		if (result == AtResultType::Success)
+		const auto wakeResult = ExitSleepMode();
+		if (wakeResult != AtResultType::Success)
 		{
-			_logger.Log(F("Sucessfully executed AT+CSCLK=0, i = %d"), i);
-			for (int j = 0; j < 3; j++)
-			{
-				GsmRegistrationState regState;
-				wait(1);
-				if (GetRegistrationStatus(regState) == AtResultType::Success)
-				{
-					_logger.Log(F("Sucessfully executed AT+CREG j = %d"), j);
-
-					_isInSleepMode = false;
-					return AtResultType::Success;
-				}
-			}
+			return wakeResult;
 		}
-		wait(100);
 	}
-
-	
-	return AtResultType::Timeout;
+	SendAt_P(AtCommand::Generic, F("AT+CSCLK=0"));
+	const auto result = PopCommandResult();
+	if (result == AtResultType::Success)
+	{
+		_isSleepConfigured = false;
+	}
+	return result;
 }
 
 bool SimcomAtCommands::IsInSleepMode()
@@ -639,15 +1161,11 @@ bool SimcomAtCommands::IsInSleepMode()
 
 bool SimcomAtCommands::CpuSleep(uint64_t millis)
 {
-	if (_cpuSleepCallback == nullptr)
+	if (!SleepCpu(millis))
 	{
 		return false;
 	}
-
-	_logger.Log(F("Entering CPU sleep"));
-	_logger.Flush();
-	_cpuSleepCallback(millis);
-	_logger.Log(F("Wake up from CPU sleep"));	
+	_logger.Debug(GsmLogCategory::General, F("Wake up from CPU sleep"));	
 	return true;
 }
 
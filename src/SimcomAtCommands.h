@@ -10,6 +10,7 @@
 #include "Parsing/SimcomResponseParser.h"
 #include "Parsing/ParserContext.h"
 #include "GsmLogger.h"
+#include "Diagnostics/AtTranscriptRecorder.h"
 #include "SimcomGsmTypes.h"
 #include <pgmspace.h>
 class S900Socket;
@@ -25,35 +26,71 @@ private:
 		CpuSleepCallback _cpuSleepCallback;
 		SetDtrCallback _setDtrCallback;
 		uint64_t _currentBaudRate;
+		uint64_t _lastBaudRate;
+		uint32_t _baudRateDetectionTime;
 		SimcomResponseParser _parser;
 		ParserContext _parserContext;
-		FixedString64 _currentCommand;
+		// long enough for AT+HTTPPARA="URL" with full URL
+		FixedString256 _currentCommand;
 
 		void SendAt_P(AtCommand commandType, const __FlashStringHelper *command, ...);
 		void SendAt_P(AtCommand commandType, bool expectEcho, const __FlashStringHelper *command, ...);
 
 		AtResultType PopCommandResult(bool ensureDelay, uint64_t timeout);
 		AtResultType PopCommandResult(bool ensureDelay = false);
+		// waits for result of command that was already written to modem
+		AtResultType WaitCommandResult(uint64_t timeout);
+		void WriteCurrentCommand();
+		AtResultType CompleteCommand(unsigned long elapsedMs);
+		bool BeginCommand(uint64_t timeout);
 		void ReadCharAndFeedParser();
 		void ReadCharAndIgnore();
+		// -1 when nothing is available, byte is recorded to transcript but not parsed
+		int ReadCharRecorded();
+		void DiscardIncomingData();
+		bool ProbeBaudRate(uint64_t baudRate, uint32_t timeout);
+		uint64_t ProbeBaudRates(uint32_t timeout);
 		bool _isInSleepMode;
+		// AT+CSCLK=1 was set, modem sleeps whenever DTR is high
+		bool _isSleepConfigured;
+		SleepWakeStats _wakeStats;
 		uint64_t _lastIncomingByteTime;
+		AtTranscriptRecorder* _transcript;
+		void WriteToModem(const char* data, size_t length);
+		// command started with one of Begin* methods
+		bool _isCommandPending;
+		unsigned long _pendingCommandStart;
+		uint64_t _pendingCommandTimeout;
+		// pending command completed by blocking command, result waits for PollCommand
+		bool _hasCompletedPendingCommand;
+		AtResultType _completedPendingResult;
+		void CompletePendingCommand();
 protected:
 		GsmLogger _logger;
+		// hardware access, subclasses override these instead of passing callbacks to constructor
+		virtual bool UpdateSerialBaudRate(uint64_t baudRate);
+		virtual bool WriteDtr(bool isHigh);
+		virtual bool SleepCpu(uint64_t millis);
 
 public:
 		GsmLogger& Logger() 
 		{
 			return _logger;
 		}		
-		FixedString64 TimeoutedCommand;
+		FixedString256 TimeoutedCommand;
 
 		bool IsAsync;
 		SimcomAtCommands(Stream& serial, UpdateBaudRateCallback updateBaudRateCallback, SetDtrCallback setDtrCallback = nullptr, CpuSleepCallback cpuSleepCallback = nullptr);
+		virtual ~SimcomAtCommands() {}
 
 		// Serial methods
 		bool EnsureModemConnected(uint64_t requestedBaudRate);
 		uint64_t FindCurrentBaudRate();
+		// duration of last FindCurrentBaudRate call in ms
+		uint32_t GetBaudRateDetectionTime()
+		{
+			return _baudRateDetectionTime;
+		}
 		bool GarbageOnSerialDetected();
 
 		// Standard modem functions
@@ -74,18 +111,50 @@ public:
 		AtResultType GetBatteryStatus(BatteryStatus &batteryStatus);
 		AtResultType GetSignalQuality(int16_t &signalQuality);
 		AtResultType SetEcho(bool echoEnabled);
+		AtResultType SaveProfile();
+		AtResultType GetModemConfiguration(ModemConfiguration& configuration);
 		AtResultType SendSms(char *number, char *message);
+
+		// Non blocking commands: Begin* sends command and returns false if another one is pending,
+		// PollCommand returns true with result once it completes. Output must stay valid until then.
+		// Blocking command first waits for pending one, its result is still returned by next PollCommand
+		bool IsCommandPending()
+		{
+			return _isCommandPending || _hasCompletedPendingCommand;
+		}
+		bool PollCommand(AtResultType& result);
+		// owner of pending command is gone, its output is not written and result is dropped
+		void CancelCommand();
+		// times out pending command nobody polled within its timeout, false while it can still complete
+		bool ExpirePendingCommand();
+		bool BeginAt();
+		bool BeginGetSignalQuality(int16_t &signalQuality);
+		bool BeginGetBatteryStatus(BatteryStatus &batteryStatus);
+		bool BeginGetIpState(SimcomIpState &ipState);
 	
 		// Calls
 		AtResultType Call(const char *number);
 		AtResultType HangUp();
 		AtResultType GetIncomingCall(IncomingCallInfo &callInfo);
+		// AT+CLIP, adds +CLIP: URC with caller number after every RING
+		AtResultType SetCallerIdNotification(bool enable);
+		// true when RING or +CLIP: arrived since last call, callerNumber is empty until +CLIP: reports it
+		bool PopIncomingCall(FixedStringBase& callerNumber);
 		
 		// USSD
+		// blocks until network replies, up to 10 s
 		AtResultType SendUssdWaitResponse(char *ussd, FixedString128& response);
+		// returns once modem accepted request, reply is reported later by OnUssdResponse handler
+		AtResultType SendUssd(const char* ussd);
+		// AT+CUSD=2, ends USSD session waiting for further action
+		AtResultType CancelUssd();
+		// handler runs from parser inside whatever command is executing, it must not send AT commands
+		void OnUssdResponse(void* ctx, UssdResponseHandler ussdResponseHandler);
 		// TCP/UDP
 		AtResultType GetIpState(SimcomIpState &ipState);
 		AtResultType GetIpAddress(GsmIp &ipAddress);
+		// blocks until modem finishes DNS lookup, requires GPRS connection
+		AtResultType ResolveHost(const char* host, GsmIp& ipAddress);
 		AtResultType GetRxMode(bool & isRxManual);
 		AtResultType SetRxMode(bool isRxManual);
 		AtResultType GetCipmux(bool &cipmux);
@@ -93,17 +162,61 @@ public:
 		AtResultType GetCipQuickSend(bool &cipqsend);
 		AtResultType SetSipQuickSend(bool cipqsend);
 		AtResultType SetTransparentMode(bool transparentMode);
+		// Transparent mode (CIPMODE=1, CIPMUX=0), raw data bypasses parser while modem is in data mode
+		AtResultType BeginTransparentConnect(ProtocolType protocol, const char *address, int port);
+		AtResultType CloseTransparentConnection();
+		void BeginResumeDataMode();
+		size_t WriteData(const char* data, size_t length);
+		// -1 when nothing is available
+		int ReadData();
 		AtResultType BeginConnect(ProtocolType protocol, uint8_t mux, const char *address, int port);
 		AtResultType Read(int mux, FixedStringBase& outputBuffer, uint16_t& availableBytes);
 		AtResultType Send(int mux, FixedStringBase& data, uint16_t index, uint16_t length, uint16_t &sentBytes);
 		AtResultType Send(int mux, FixedStringBase& data, uint16_t &sentBytes);
 		AtResultType CloseConnection(uint8_t mux);
+		// TCP only, counters start at zero with every connection
+		AtResultType GetAckedBytes(uint8_t mux, uint32_t& sentBytes, uint32_t& ackedBytes);
 		AtResultType GetConnectionInfo(uint8_t mux, ConnectionInfo &connectionInfo);
 
+		// Bearer profile 1 (AT+SAPBR) used by modem HTTP stack, independent of CIPSTART connections
+		AtResultType SetBearerParameter(const char* name, const char* value);
+		AtResultType OpenBearer();
+		AtResultType CloseBearer();
+		AtResultType GetBearerStatus(BearerStatus& status, GsmIp& ipAddress);
+		// HTTP, result of HttpAction is reported by OnHttpAction handler when request completes
+		AtResultType HttpInit();
+		AtResultType HttpTerm();
+		AtResultType HttpSetParameter(const char* name, const char* value);
+		// request body for POST, modem waits at most timeout ms for all data
+		AtResultType HttpSetData(const char* data, uint32_t length, uint32_t timeout = 10000);
+		AtResultType HttpAction(HttpMethod method);
+		// appends up to length bytes of response body starting at offset directly to output
+		AtResultType HttpRead(uint32_t offset, uint16_t length, FixedStringBase& output, uint16_t& readBytes);
+		void OnHttpAction(void* ctx, HttpActionHandler httpActionHandler);
+
+		// FTP on bearer profile 1, session progress and errors are reported by OnFtpSession handler
+		// AT+FTP<name>="<value>", e.g. SERV, UN, PW, PUTNAME, PUTPATH, GETNAME, GETPATH, PUTOPT, TYPE
+		AtResultType FtpSetParameter(const char* name, const char* value);
+		// AT+FTP<name>=<value>, e.g. CID, PORT, MODE, REST
+		AtResultType FtpSetParameter(const char* name, uint32_t value);
+		// size of GETPATH/GETNAME file on server
+		AtResultType FtpGetSize(uint32_t& size);
+		AtResultType FtpPutOpen();
+		// writes at most acceptedLength bytes, modem accepts less than length when its buffer is full
+		AtResultType FtpPutWrite(const char* data, uint16_t length, uint16_t& acceptedLength);
+		AtResultType FtpPutClose();
+		AtResultType FtpGetOpen();
+		// appends up to length bytes of downloaded data directly to output
+		AtResultType FtpGetRead(uint16_t length, FixedStringBase& output, uint16_t& readBytes);
+		void OnFtpSession(void* ctx, FtpSessionHandler ftpSessionHandler);
+
 		void OnMuxEvent(void* ctx, MuxEventHandler muxEventHandler);
 		void OnCipstatusInfo(void * ctx, MuxCipstatusInfoHandler muxCipstatusHandler);
 		void OnGsmModuleEvent(void* ctx, OnGsmModuleEventHandler gsmModuleEventHandler);
 
+		// Captures all serial traffic into transcript, pass nullptr to stop capturing
+		void SetTranscriptRecorder(AtTranscriptRecorder* transcript);
+
 		// Misc
 		AtResultType GetTemperature(float& temperature);
 		AtResultType EnableNetlight(bool enable);
@@ -112,6 +225,11 @@ public:
 		bool IsInSleepMode();
 		AtResultType EnterSleepMode();
 		AtResultType ExitSleepMode();
+		AtResultType DisableSleepMode();
+		const SleepWakeStats& GetWakeStats()
+		{
+			return _wakeStats;
+		}
 		bool CpuSleep(uint64_t millis);
 		// GPRS
 		AtResultType SetApn(const char *apnName, const char *username, const char *password);
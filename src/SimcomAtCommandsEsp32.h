@@ -4,28 +4,32 @@
 #ifdef  ESP32
 
 #include <HardwareSerial.h>
+#include <driver/uart.h>
 #include "SimcomAtCommands.h"
 
 class SimcomAtCommandsEsp32 : public SimcomAtCommands
 {
-	static int _txPin;
-	static int _rxPin;
-	static int _dtrPin;
-	static HardwareSerial* _serial;
-	static bool _isSerialInitialized;
-	static void UpdateBaudRate(uint64_t baudRate)
+	int _txPin;
+	int _rxPin;
+	int _dtrPin;
+	HardwareSerial& _hardwareSerial;
+	bool _isSerialInitialized;
+	int _wakeUartNum;
+protected:
+	bool UpdateSerialBaudRate(uint64_t baudRate) override
 	{
 		if (_isSerialInitialized)
 		{
-			_serial->updateBaudRate(baudRate);
-			return;
+			_hardwareSerial.updateBaudRate(baudRate);
+			return true;
 		}
 		
-		_serial->begin(baudRate, SERIAL_8N1, _txPin, _rxPin, false);
-		_isSerialInitialized = true;		
+		_hardwareSerial.begin(baudRate, SERIAL_8N1, _txPin, _rxPin, false);
+		_isSerialInitialized = true;
+		return true;
 	}
 
-	static bool SetDtr(bool isHigh)
+	bool WriteDtr(bool isHigh) override
 	{
 		if (_dtrPin == -1)
 		{
@@ -34,28 +38,43 @@ class SimcomAtCommandsEsp32 : public SimcomAtCommands
 		digitalWrite(_dtrPin, isHigh);
 		return true;
 	}
-	static void LightSleep(uint64_t millis)
+	bool SleepCpu(uint64_t millis) override
 	{
+		_logger.Debug(GsmLogCategory::General, F("Entering CPU sleep"));
+		_logger.Flush();
 		esp_sleep_enable_timer_wakeup(1000 * millis);
+		if (_wakeUartNum != -1)
+		{
+			// characters that trigger wake up are lost, URC lines are preceded by \r\n which parser can afford to lose
+			uart_set_wakeup_threshold(static_cast<uart_port_t>(_wakeUartNum), 3);
+			esp_sleep_enable_uart_wakeup(_wakeUartNum);
+		}
 		esp_light_sleep_start();
+		return true;
 	}
 public:
 	SimcomAtCommandsEsp32(HardwareSerial& serial, int txPin, int rxPin, int dtrPin = -1)
-		:SimcomAtCommands(serial, UpdateBaudRate, SetDtr, LightSleep)
+		:SimcomAtCommands(serial, nullptr),
+		_txPin(txPin),
+		_rxPin(rxPin),
+		_dtrPin(dtrPin),
+		_hardwareSerial(serial),
+		_isSerialInitialized(false),
+		_wakeUartNum(-1)
 	{
 		Serial.println("SimcomAtCommandsEsp32::SimcomAtCommandsEsp32");		
-		_serial = &serial;
-		_dtrPin = dtrPin;
 		if (_dtrPin != -1)
 		{
 			pinMode(_dtrPin, OUTPUT);
 		}
-		_txPin = txPin;
-		_rxPin = rxPin;
+	}
+	// wake CPU from light sleep as soon as modem sends something on given UART
+	void EnableUartWakeup(int uartNum)
+	{
+		_wakeUartNum = uartNum;
 	}
 };
 
 #endif //  ESP32
 
 #endif
-
@@ -69,6 +69,37 @@ public:
 	ConnectionState State;
 };
 
+// AT+SAPBR bearer used by modem HTTP/FTP stack
+enum class BearerStatus : uint8_t
+{
+	Connecting = 0,
+	Connected = 1,
+	Closing = 2,
+	Closed = 3
+};
+
+// AT+HTTPACTION method
+enum class HttpMethod : uint8_t
+{
+	Get = 0,
+	Post = 1,
+	Head = 2
+};
+
+// +CUSD: status
+enum class UssdStatus : uint8_t
+{
+	NoFurtherAction = 0,
+	// network waits for reply, send it with another USSD request
+	FurtherActionRequired = 1,
+	TerminatedByNetwork = 2,
+	OtherClientResponded = 3,
+	NotSupported = 4,
+	NetworkTimeout = 5,
+	// no +CUSD: within GsmModule::UssdTimeout
+	NoResponse = 255
+};
+
 enum class RegistrationMode: uint8_t
 {
 	Automatic = 0,
@@ -100,7 +131,16 @@ enum class AtCommand : uint8_t
 	CipRxGetRead,
 	CipQsendQuery,
 	CipSend,
-	Cmte
+	Cmte,
+	ModemConfigQuery,
+	Cdnsgip,
+	Cipack,
+	Sapbr,
+	HttpData,
+	HttpRead,
+	FtpPut,
+	FtpGet,
+	FtpSize
 };
 
 enum class SimcomIpState : uint8_t
@@ -161,6 +201,208 @@ enum class GsmModuleEventType : uint8_t
 	OverVoltagePowerDown
 };
 
+class ModemConfiguration
+{
+public:
+	ModemConfiguration()
+	{
+		IsValid = false;
+		Cipmux = false;
+		CipQSend = false;
+		IsRxManual = false;
+		IsTransparent = false;
+		CregMode = 0;
+	}
+	bool IsValid;
+	bool Cipmux;
+	bool CipQSend;
+	bool IsRxManual;
+	bool IsTransparent;
+	uint8_t CregMode;
+	bool Matches(const ModemConfiguration& other) const
+	{
+		return IsValid && other.IsValid &&
+			Cipmux == other.Cipmux &&
+			CipQSend == other.CipQSend &&
+			IsRxManual == other.IsRxManual &&
+			IsTransparent == other.IsTransparent &&
+			CregMode == other.CregMode;
+	}
+};
+
+struct SleepWakeStats
+{
+	SleepWakeStats()
+	{
+		WakeCount = 0;
+		FailureCount = 0;
+		LastLatencyUs = 0;
+		MaxLatencyUs = 0;
+		TotalLatencyUs = 0;
+	}
+	uint32_t WakeCount;
+	uint32_t FailureCount;
+	uint32_t LastLatencyUs;
+	uint32_t MaxLatencyUs;
+	uint64_t TotalLatencyUs;
+	uint32_t AverageLatencyUs() const
+	{
+		return WakeCount == 0 ? 0 : TotalLatencyUs / WakeCount;
+	}
+	void AddWake(uint32_t latencyUs)
+	{
+		WakeCount++;
+		LastLatencyUs = latencyUs;
+		TotalLatencyUs += latencyUs;
+		if (latencyUs > MaxLatencyUs)
+		{
+			MaxLatencyUs = latencyUs;
+		}
+	}
+};
+
+struct ConnectStats
+{
+	ConnectStats()
+	{
+		Attempts = 0;
+		Successes = 0;
+		Failures = 0;
+		Timeouts = 0;
+		Reconnects = 0;
+		BreakerTrips = 0;
+		LastLatencyMs = 0;
+		MinLatencyMs = 0;
+		MaxLatencyMs = 0;
+		TotalLatencyMs = 0;
+	}
+	uint32_t Attempts;
+	uint32_t Successes;
+	// every failed attempt, Timeouts is subset of Failures
+	uint32_t Failures;
+	uint32_t Timeouts;
+	// attempts started by auto reconnect, subset of Attempts
+	uint32_t Reconnects;
+	uint32_t BreakerTrips;
+	uint32_t LastLatencyMs;
+	uint32_t MinLatencyMs;
+	uint32_t MaxLatencyMs;
+	uint64_t TotalLatencyMs;
+	uint32_t AverageLatencyMs() const
+	{
+		return Successes == 0 ? 0 : TotalLatencyMs / Successes;
+	}
+	void AddSuccess(uint32_t latencyMs)
+	{
+		if (Successes == 0 || latencyMs < MinLatencyMs)
+		{
+			MinLatencyMs = latencyMs;
+		}
+		Successes++;
+		LastLatencyMs = latencyMs;
+		TotalLatencyMs += latencyMs;
+		if (latencyMs > MaxLatencyMs)
+		{
+			MaxLatencyMs = latencyMs;
+		}
+	}
+	void Add(const ConnectStats& other)
+	{
+		if (other.Successes > 0 && (Successes == 0 || other.MinLatencyMs < MinLatencyMs))
+		{
+			MinLatencyMs = other.MinLatencyMs;
+		}
+		if (other.MaxLatencyMs > MaxLatencyMs)
+		{
+			MaxLatencyMs = other.MaxLatencyMs;
+		}
+		if (other.Successes > 0)
+		{
+			LastLatencyMs = other.LastLatencyMs;
+		}
+		Attempts += other.Attempts;
+		Successes += other.Successes;
+		Failures += other.Failures;
+		Timeouts += other.Timeouts;
+		Reconnects += other.Reconnects;
+		BreakerTrips += other.BreakerTrips;
+		TotalLatencyMs += other.TotalLatencyMs;
+	}
+};
+
+// datagrams sent with GsmAsyncSocket::SendDatagram, latency is from SendDatagram until modem accepted it
+struct DatagramStats
+{
+	DatagramStats()
+	{
+		Sent = 0;
+		Failed = 0;
+		Bytes = 0;
+		LastLatencyMs = 0;
+		MinLatencyMs = 0;
+		MaxLatencyMs = 0;
+		TotalLatencyMs = 0;
+	}
+	uint32_t Sent;
+	// dropped because of send error, disconnect or modem accepting only part of it
+	uint32_t Failed;
+	uint64_t Bytes;
+	uint32_t LastLatencyMs;
+	uint32_t MinLatencyMs;
+	uint32_t MaxLatencyMs;
+	uint64_t TotalLatencyMs;
+	uint32_t AverageLatencyMs() const
+	{
+		return Sent == 0 ? 0 : TotalLatencyMs / Sent;
+	}
+	void AddSent(uint16_t length, uint32_t latencyMs)
+	{
+		if (Sent == 0 || latencyMs < MinLatencyMs)
+		{
+			MinLatencyMs = latencyMs;
+		}
+		if (latencyMs > MaxLatencyMs)
+		{
+			MaxLatencyMs = latencyMs;
+		}
+		Sent++;
+		Bytes += length;
+		LastLatencyMs = latencyMs;
+		TotalLatencyMs += latencyMs;
+	}
+};
+
+/*
+Auto reconnect of GsmAsyncSocket. Delay after n-th consecutive failure is
+MinDelay * 2^(n-1) capped at MaxDelay, randomized by +-JitterPercent so sockets
+do not retry in lockstep. After BreakerThreshold consecutive failures circuit
+breaker opens and no CIPSTART is sent for BreakerOpenTime, then single probe
+attempt either closes it or opens it again. Nothing is attempted while network
+is unavailable, network coming back resets backoff.
+*/
+struct ReconnectPolicy
+{
+	ReconnectPolicy()
+	{
+		Enabled = false;
+		MinDelay = 1000;
+		MaxDelay = 60000;
+		JitterPercent = 20;
+		MaxAttempts = 0;
+		BreakerThreshold = 8;
+		BreakerOpenTime = 300000;
+	}
+	bool Enabled;
+	uint32_t MinDelay;
+	uint32_t MaxDelay;
+	uint8_t JitterPercent;
+	// consecutive failures after which socket gives up until next BeginConnect, 0 retries forever
+	uint16_t MaxAttempts;
+	// 0 disables circuit breaker
+	uint16_t BreakerThreshold;
+	uint32_t BreakerOpenTime;
+};
+
 class IncomingCallInfo
 {
 public:
@@ -0,0 +1,74 @@
+#ifndef _SPSC_QUEUE_H
+#define _SPSC_QUEUE_H
+
+#include <stddef.h>
+#include <atomic>
+
+/*
+Lock free single producer, single consumer ring buffer.
+One thread may only call Push, the other only Front/Pop.
+Capacity must be a power of two, one slot is kept empty to tell full from empty.
+*/
+template<typename T, size_t Capacity>
+class SpscQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	T _items[Capacity];
+	std::atomic<size_t> _head;
+	std::atomic<size_t> _tail;
+
+	static size_t Next(size_t index)
+	{
+		return (index + 1) & (Capacity - 1);
+	}
+public:
+	SpscQueue():
+		_head(0),
+		_tail(0)
+	{
+	}
+
+	// producer side
+	bool Push(const T& item)
+	{
+		const auto tail = _tail.load(std::memory_order_relaxed);
+		const auto next = Next(tail);
+		if (next == _head.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		_items[tail] = item;
+		_tail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	// consumer side, returns nullptr when empty. Item stays valid until Pop
+	T* Front()
+	{
+		const auto head = _head.load(std::memory_order_relaxed);
+		if (head == _tail.load(std::memory_order_acquire))
+		{
+			return nullptr;
+		}
+		return &_items[head];
+	}
+
+	// consumer side
+	void Pop()
+	{
+		const auto head = _head.load(std::memory_order_relaxed);
+		_head.store(Next(head), std::memory_order_release);
+	}
+
+	bool IsEmpty()
+	{
+		return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+	}
+	bool IsFull()
+	{
+		return Next(_tail.load(std::memory_order_acquire)) == _head.load(std::memory_order_acquire);
+	}
+};
+
+#endif
@@ -0,0 +1,253 @@
+#include "TimerWheel.h"
+
+GsmTimer::GsmTimer():
+	_next(nullptr),
+	_prev(nullptr),
+	_head(nullptr),
+	_expires(0),
+	_period(0),
+	_isScheduled(false),
+	_isElapsed(false),
+	_ctx(nullptr),
+	_handler(nullptr)
+{
+}
+
+void GsmTimer::OnElapsed(void* ctx, GsmTimerHandler handler)
+{
+	_handler = handler;
+	_ctx = ctx;
+}
+
+TimerWheel::TimerWheel():
+	_slots{ { nullptr } },
+	_now(0),
+	_isStarted(false)
+{
+}
+
+void TimerWheel::Insert(GsmTimer& timer)
+{
+	// due timers go to slot of current tick, ProcessTick expires it right after cascading
+	const auto remaining = static_cast<int32_t>(timer._expires - _now);
+	const uint32_t delta = remaining < 0 ? 0 : remaining;
+	const auto expires = _now + delta;
+
+	uint8_t level = 0;
+	uint32_t span = TimerWheelSlots;
+	while (level < TimerWheelLevels - 1 && delta >= span)
+	{
+		level++;
+		span <<= GSM_TIMER_WHEEL_BITS;
+	}
+	// beyond wheel range, parked in farthest slot and reinserted when it cascades
+	const auto slotTick = delta >= span ? _now + span - 1 : expires;
+	auto& head = _slots[level][SlotIndex(slotTick, level)];
+
+	timer._prev = nullptr;
+	timer._next = head;
+	if (head != nullptr)
+	{
+		head->_prev = &timer;
+	}
+	head = &timer;
+	timer._head = &head;
+	timer._isScheduled = true;
+}
+
+void TimerWheel::Unlink(GsmTimer& timer)
+{
+	if (timer._prev != nullptr)
+	{
+		timer._prev->_next = timer._next;
+	}
+	else
+	{
+		*timer._head = timer._next;
+	}
+	if (timer._next != nullptr)
+	{
+		timer._next->_prev = timer._prev;
+	}
+	timer._next = nullptr;
+	timer._prev = nullptr;
+	timer._head = nullptr;
+	timer._isScheduled = false;
+}
+
+void TimerWheel::Start(GsmTimer& timer, uint32_t delay, uint32_t period)
+{
+	if (!_isStarted)
+	{
+		_now = millis();
+		_isStarted = true;
+	}
+	if (timer._isScheduled)
+	{
+		Unlink(timer);
+	}
+	// smallest delay is one tick, timer started with 0 expires on next Advance with later time
+	timer._expires = _now + (delay == 0 ? 1 : delay);
+	timer._period = period;
+	timer._isElapsed = false;
+	Insert(timer);
+}
+
+void TimerWheel::Stop(GsmTimer& timer)
+{
+	if (timer._isScheduled)
+	{
+		Unlink(timer);
+	}
+	timer._isElapsed = false;
+}
+
+void TimerWheel::Cascade(uint8_t level, uint16_t slot)
+{
+	GsmTimer* timer;
+	while ((timer = _slots[level][slot]) != nullptr)
+	{
+		Unlink(*timer);
+		Insert(*timer);
+	}
+}
+
+void TimerWheel::Expire(GsmTimer& timer)
+{
+	timer._isElapsed = true;
+	if (timer._period != 0)
+	{
+		timer._expires = _now + timer._period;
+		Insert(timer);
+	}
+	if (timer._handler != nullptr)
+	{
+		timer._handler(timer._ctx);
+	}
+}
+
+void TimerWheel::ProcessTick(uint32_t tick)
+{
+	_now = tick;
+	for (uint8_t level = 1; level < TimerWheelLevels; level++)
+	{
+		if (SlotIndex(tick, level - 1) != 0)
+		{
+			break;
+		}
+		// lower level wrapped around, move next group of timers down
+		Cascade(level, SlotIndex(tick, level));
+	}
+
+	// one at a time, handlers may stop or restart other timers from this slot
+	auto& head = _slots[0][SlotIndex(tick, 0)];
+	GsmTimer* timer;
+	while ((timer = head) != nullptr)
+	{
+		Unlink(*timer);
+		Expire(*timer);
+	}
+}
+
+/*
+After long gap (CPU sleep) walking every tick would be slow, reinsert all timers relative to new time instead
+*/
+void TimerWheel::Rebuild(uint32_t now)
+{
+	GsmTimer* all = nullptr;
+	for (uint8_t level = 0; level < TimerWheelLevels; level++)
+	{
+		for (uint16_t slot = 0; slot < TimerWheelSlots; slot++)
+		{
+			GsmTimer* timer;
+			while ((timer = _slots[level][slot]) != nullptr)
+			{
+				Unlink(*timer);
+				timer->_next = all;
+				all = timer;
+			}
+		}
+	}
+	_now = now;
+	while (all != nullptr)
+	{
+		auto timer = all;
+		all = all->_next;
+		timer->_next = nullptr;
+		Insert(*timer);
+	}
+	ProcessTick(now);
+}
+
+void TimerWheel::Advance(uint32_t now)
+{
+	if (!_isStarted)
+	{
+		_now = now;
+		_isStarted = true;
+		return;
+	}
+	if (now - _now >= static_cast<uint32_t>(TimerWheelSlots) * TimerWheelSlots)
+	{
+		Rebuild(now);
+		return;
+	}
+	while (_now != now)
+	{
+		ProcessTick(_now + 1);
+	}
+}
+
+uint32_t TimerWheel::TimeUntil(GsmTimer& timer)
+{
+	if (timer._isElapsed)
+	{
+		return 0;
+	}
+	if (!timer._isScheduled)
+	{
+		return TimerWheelNoDeadline;
+	}
+	const auto now = millis();
+	if (static_cast<int32_t>(timer._expires - now) <= 0)
+	{
+		return 0;
+	}
+	return timer._expires - now;
+}
+
+uint32_t TimerWheel::TimeToNextDeadline()
+{
+	uint32_t earliest = TimerWheelNoDeadline;
+	for (uint8_t level = 0; level < TimerWheelLevels; level++)
+	{
+		const auto current = SlotIndex(_now, level);
+		// slot of current tick was already processed, it holds timers one full turn ahead
+		for (uint16_t i = 1; i <= TimerWheelSlots; i++)
+		{
+			auto timer = _slots[level][(current + i) & (TimerWheelSlots - 1)];
+			if (timer == nullptr)
+			{
+				continue;
+			}
+			// first non empty slot of a level holds its earliest timers
+			for (; timer != nullptr; timer = timer->_next)
+			{
+				const auto remaining = static_cast<int32_t>(timer->_expires - _now);
+				const uint32_t delta = remaining <= 0 ? 0 : remaining;
+				if (delta < earliest)
+				{
+					earliest = delta;
+				}
+			}
+			break;
+		}
+	}
+	if (earliest == TimerWheelNoDeadline)
+	{
+		return earliest;
+	}
+	// wheel time lags behind millis() until next Advance
+	const uint32_t lag = millis() - _now;
+	return earliest > lag ? earliest - lag : 0;
+}
@@ -0,0 +1,98 @@
+#ifndef _TIMER_WHEEL_H
+#define _TIMER_WHEEL_H
+
+#include <Arduino.h>
+#include <stdint.h>
+
+// each level has 2^GSM_TIMER_WHEEL_BITS slots, level n slot spans 2^(n*bits) ms
+#ifndef GSM_TIMER_WHEEL_BITS
+#define GSM_TIMER_WHEEL_BITS 5
+#endif
+
+const uint8_t TimerWheelLevels = 4;
+const uint16_t TimerWheelSlots = 1 << GSM_TIMER_WHEEL_BITS;
+const uint32_t TimerWheelNoDeadline = UINT32_MAX;
+
+typedef void(*GsmTimerHandler)(void* ctx);
+
+class TimerWheel;
+
+/*
+Timer owned by caller and linked into TimerWheel, nothing is allocated.
+Either poll IsElapsed or set handler to be called from TimerWheel::Advance
+*/
+class GsmTimer
+{
+	friend class TimerWheel;
+
+	GsmTimer* _next;
+	GsmTimer* _prev;
+	// wheel slot timer is linked into
+	GsmTimer** _head;
+	uint32_t _expires;
+	uint32_t _period;
+	bool _isScheduled;
+	bool _isElapsed;
+	void* _ctx;
+	GsmTimerHandler _handler;
+public:
+	GsmTimer();
+	GsmTimer(const GsmTimer&) = delete;
+	void OnElapsed(void* ctx, GsmTimerHandler handler);
+	bool IsScheduled()
+	{
+		return _isScheduled;
+	}
+	// returns true once after each expiration
+	bool IsElapsed()
+	{
+		const auto isElapsed = _isElapsed;
+		_isElapsed = false;
+		return isElapsed;
+	}
+	// takes effect when periodic timer is rescheduled after next expiration
+	void SetPeriod(uint32_t period)
+	{
+		_period = period;
+	}
+};
+
+/*
+Hierarchical timing wheel with 1 ms resolution.
+Start and Stop are O(1), Advance cascades timers to lower levels as time passes.
+*/
+class TimerWheel
+{
+	GsmTimer* _slots[TimerWheelLevels][TimerWheelSlots];
+	// last processed tick
+	uint32_t _now;
+	bool _isStarted;
+
+	void Insert(GsmTimer& timer);
+	void Unlink(GsmTimer& timer);
+	void Cascade(uint8_t level, uint16_t slot);
+	void Expire(GsmTimer& timer);
+	void ProcessTick(uint32_t tick);
+	void Rebuild(uint32_t now);
+	static uint16_t SlotIndex(uint32_t tick, uint8_t level)
+	{
+		return (tick >> (level * GSM_TIMER_WHEEL_BITS)) & (TimerWheelSlots - 1);
+	}
+public:
+	TimerWheel();
+	// period 0 makes one shot timer, restarting scheduled timer moves its deadline
+	void Start(GsmTimer& timer, uint32_t delay, uint32_t period = 0);
+	void Stop(GsmTimer& timer);
+	// expires due timers, handlers are called from here
+	void Advance(uint32_t now);
+	void Advance()
+	{
+		Advance(millis());
+	}
+	// ms until timer expires, 0 if already elapsed, TimerWheelNoDeadline if not scheduled
+	uint32_t TimeUntil(GsmTimer& timer);
+	// ms until earliest scheduled timer expires, TimerWheelNoDeadline if there is none
+	uint32_t TimeToNextDeadline();
+};
+
+#endif